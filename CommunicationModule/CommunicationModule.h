@@ -4,6 +4,7 @@
 #include "EmbeddedUtilities/Callback.h"
 #include "PeripheralInterface/Exception.h"
 #include "CommunicationModule/Mac802154.h"
+#include "CommunicationModule/Mac802154Command.h"
 #include "PeripheralInterface/PeripheralInterface.h"
 #include "PeripheralInterface/PeripheralSPIImpl.h"
 #include "CommunicationModule/Mac802154MRFImpl.h"
@@ -3,10 +3,38 @@
 
 #define MAXIMUM_HEADER_SIZE 21
 
+/**
+ * Header profiles fix the addressing modes of transmitted frames
+ * at compile time. With a profile other than the generic one, all
+ * fields of the header have constant offsets, so the header is
+ * never rearranged when an address is set. All profiles include
+ * the sequence number and the pan id (pan id compression is used
+ * where the standard allows it).
+ *
+ *  - GENERIC: addressing modes are chosen at runtime (default)
+ *  - SHORT_ADDRESSES: short destination and short source address
+ *  - SHORT_DESTINATION_EXTENDED_SOURCE: short destination and
+ *    extended source address
+ *  - EXTENDED_ADDRESSES: extended destination and extended source address
+ *
+ * Setting an address with a mode that does not match the profile,
+ * as well as suppressing the sequence number, has no effect.
+ * Define FRAME_HEADER802154_PROFILE for all translation units,
+ * with bazel use e.g. --define frame_header_profile=short_addresses
+ */
+#define FRAME_HEADER802154_PROFILE_GENERIC 0
+#define FRAME_HEADER802154_PROFILE_SHORT_ADDRESSES 1
+#define FRAME_HEADER802154_PROFILE_SHORT_DESTINATION_EXTENDED_SOURCE 2
+#define FRAME_HEADER802154_PROFILE_EXTENDED_ADDRESSES 3
+
+#ifndef FRAME_HEADER802154_PROFILE
+#define FRAME_HEADER802154_PROFILE FRAME_HEADER802154_PROFILE_GENERIC
+#endif
+
 typedef struct FrameHeader802154 FrameHeader802154;
 
 struct FrameHeader802154 {
     uint8_t data[MAXIMUM_HEADER_SIZE];
 };
 
-#endif
\ No newline at end of file
+#endif
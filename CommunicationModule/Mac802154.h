@@ -25,14 +25,195 @@
  *  in reversed byte order.
  */
 
+/**
+ * Size of the largest packet that can be returned by
+ * Mac802154_dequeuePacket(). This is the frame length field,
+ * the longest possible 802.15.4 frame and the link quality
+ * and rssi values appended by the hardware.
+ */
+#define MAC802154_MAXIMUM_PACKET_SIZE (1 + 127 + 2)
+
+/**
+ * Channels of the 2.4GHz band, see Mac802154_scanEnergy().
+ */
+#define MAC802154_FIRST_CHANNEL 11
+#define MAC802154_NUMBER_OF_CHANNELS 16
+
 typedef struct Mac802154 Mac802154;
 typedef struct Mac802154Config Mac802154Config;
+typedef struct Mac802154Callback Mac802154Callback;
+typedef struct Mac802154BusCounters Mac802154BusCounters;
+typedef struct Mac802154BusStatistics Mac802154BusStatistics;
+typedef struct Mac802154FrameView Mac802154FrameView;
+typedef struct Mac802154TransmissionStatus Mac802154TransmissionStatus;
+typedef struct Mac802154Frame Mac802154Frame;
+typedef struct Mac802154PayloadSegment Mac802154PayloadSegment;
+typedef struct Mac802154LinkQuality Mac802154LinkQuality;
+typedef struct Mac802154ChannelAccessStatistics Mac802154ChannelAccessStatistics;
+typedef struct Mac802154ReceiveFilter Mac802154ReceiveFilter;
+
+/**
+ * Clear channel assessment modes as numbered by the standard.
+ */
+enum {
+  MAC802154_CCA_MODE_DEFAULT = 0,
+  MAC802154_CCA_MODE_ENERGY_DETECTION = 1,
+  MAC802154_CCA_MODE_CARRIER_SENSE = 2,
+  MAC802154_CCA_MODE_CARRIER_SENSE_AND_ENERGY_DETECTION = 3,
+};
 
+/**
+ * The fields after the channel control the channel access
+ * (unslotted csma-ca). Zero selects the default given in brackets,
+ * so configs that do not set them keep working as before:
+ *  - clear_channel_assessment_mode: one of MAC802154_CCA_MODE_*
+ *    (energy detection)
+ *  - energy_detection_threshold: the channel is considered busy if the
+ *    energy is above, the scale is the one of Mac802154_scanEnergy()
+ *    (hardware specific, 0x60 i.e. about -69dBm for the MRF24J40)
+ *  - minimum_backoff_exponent: macMinBE, up to 3 (3)
+ *  - maximum_csma_backoffs: macMaxCSMABackoffs, up to 5 (4)
+ *  - custom_backoffs: as zero is a valid value for the two fields
+ *    above, they are only used if this is set, otherwise both
+ *    keep their defaults
+ * Larger values are limited to the maximum. macMaxBE is fixed
+ * to 5 by the MRF24J40.
+ */
 struct Mac802154Config {
   uint8_t short_source_address[2];
   uint8_t extended_source_address[8];
   uint8_t pan_id[2];
   uint8_t channel;
+  uint8_t clear_channel_assessment_mode;
+  uint8_t energy_detection_threshold;
+  uint8_t minimum_backoff_exponent;
+  uint8_t maximum_csma_backoffs;
+  bool custom_backoffs;
+};
+
+struct Mac802154Callback {
+  void (*function) (void *argument);
+  void *argument;
+};
+
+/**
+ * Outcome of the last transmission, see Mac802154_getTransmissionStatus().
+ *  - success: the frame was sent and, if requested, acknowledged
+ *  - channel_busy: the transmission failed, because the channel
+ *    access (csma-ca) failed
+ *  - retries: number of retransmissions by the hardware
+ *    due to missing acknowledgements
+ */
+struct Mac802154TransmissionStatus {
+  bool success;
+  bool channel_busy;
+  uint8_t retries;
+};
+
+/**
+ * Describes a frame for Mac802154_enqueueFrame().
+ * The destination address (2 or 8 bytes, see destination_address_size)
+ * is copied into the queue, the payload is not, i.e. it
+ * has to stay alive until the frame was transmitted.
+ */
+struct Mac802154Frame {
+  uint8_t destination_address[8];
+  uint8_t destination_address_size;
+  const uint8_t *payload;
+  uint8_t payload_length;
+};
+
+/**
+ * One of several buffers the payload is composed of,
+ * see Mac802154_setPayloadVector().
+ */
+struct Mac802154PayloadSegment {
+  const uint8_t *data;
+  uint8_t length;
+};
+
+/**
+ * Averaged reception quality of the frames from one
+ * neighbor, see Mac802154_getNeighborLinkQuality().
+ *  - link_quality, rssi: moving averages of the values appended
+ *    to the received frames, higher is better
+ *  - number_of_frames: frames the averages are based on,
+ *    saturates at 255
+ */
+struct Mac802154LinkQuality {
+  uint8_t link_quality;
+  uint8_t rssi;
+  uint8_t number_of_frames;
+};
+
+/**
+ * Categories of transfers between the mcu and the
+ * transceiver, see Mac802154_getBusStatistics().
+ */
+enum {
+  MAC802154_BUS_OPERATION_HEADER_WRITE,
+  MAC802154_BUS_OPERATION_PAYLOAD_WRITE,
+  MAC802154_BUS_OPERATION_STATUS_POLL,
+  MAC802154_BUS_OPERATION_RX_FETCH,
+  MAC802154_BUS_OPERATION_REGISTER_CONFIG,
+  MAC802154_NUMBER_OF_BUS_OPERATIONS,
+};
+
+struct Mac802154BusCounters {
+  uint32_t transactions;
+  uint32_t command_bytes;
+  uint32_t bytes_written;
+  uint32_t bytes_read;
+};
+
+struct Mac802154BusStatistics {
+  Mac802154BusCounters operation[MAC802154_NUMBER_OF_BUS_OPERATIONS];
+};
+
+/**
+ * Outcome of all transmissions since the
+ * radio was created, see Mac802154_getChannelAccessStatistics().
+ *  - frames: finished transmissions, successful or not
+ *  - channel_access_failures: frames dropped because csma-ca
+ *    found the channel busy maximum_csma_backoffs + 1 times
+ *  - acknowledgement_failures: frames without acknowledgement
+ *    after all retransmissions
+ *  - retransmissions: sum of the retries of all frames
+ */
+struct Mac802154ChannelAccessStatistics {
+  uint16_t frames;
+  uint16_t channel_access_failures;
+  uint16_t acknowledgement_failures;
+  uint16_t retransmissions;
+};
+
+/**
+ * Frame types for Mac802154ReceiveFilter, bit n
+ * stands for frame type n (see FRAME_TYPE_BEACON).
+ */
+enum {
+  MAC802154_RECEIVE_BEACON_FRAMES = 1 << 0,
+  MAC802154_RECEIVE_DATA_FRAMES = 1 << 1,
+  MAC802154_RECEIVE_ACKNOWLEDGEMENT_FRAMES = 1 << 2,
+  MAC802154_RECEIVE_MAC_COMMAND_FRAMES = 1 << 3,
+};
+
+/**
+ * Decides which received frames reach the receive queue,
+ * see Mac802154_setReceiveFilter().
+ *  - frame_types: combination of MAC802154_RECEIVE_*_FRAMES,
+ *    0 accepts all frame types
+ *  - own_pan_id_only: drop frames whose destination pan id is
+ *    neither the configured one nor the broadcast pan id.
+ *    Frames without pan id pass. Usually the hardware does this
+ *    already, but not in promiscuous mode.
+ *  - accept_corrupted_frames: also receive frames with a wrong
+ *    crc, e.g. to analyse interference with a sniffer
+ */
+struct Mac802154ReceiveFilter {
+  uint8_t frame_types;
+  bool own_pan_id_only;
+  bool accept_corrupted_frames;
 };
 
 /**
@@ -44,6 +225,70 @@ void Mac802154_configure(Mac802154 *self, const Mac802154Config *config);
 
 void Mac802154_sendBlocking(Mac802154 *self);
 
+/**
+ * Writes the frame to the hardware, starts the transmission and returns
+ * without waiting for the transmission to finish. Once the hardware
+ * reports the transmission as completed the callback set via
+ * Mac802154_setTransmissionCompleteCallback() is executed.
+ * Do not change the frame or start another transmission before that.
+ * Depending on the implementation you might have to forward the interrupts
+ * of the hardware to the driver (see e.g. Mac802154MRF_handleInterrupt()).
+ * @return false if the frame could not be handed to the hardware,
+ * e.g. as the driver's queue of pending bus transfers is too short for
+ * a payload made of many segments (see MRF_IO_TRANSFER_QUEUE_SIZE).
+ * Nothing is sent and the callback is not executed in that case.
+ */
+bool Mac802154_sendNonBlocking(Mac802154 *self);
+
+/**
+ * The callback is executed from within the interrupt handling
+ * of the driver, so keep it short.
+ */
+void Mac802154_setTransmissionCompleteCallback(Mac802154 *self, Mac802154Callback callback);
+
+/**
+ * Appends the frame to the transmission queue and returns immediately.
+ * Queued frames are sent back to back, the next one is written
+ * to the hardware and started as soon as the previous one completed,
+ * i.e. from within the interrupt handling of the driver
+ * (see e.g. Mac802154MRF_handleInterrupt()). The transmission complete
+ * callback is executed for every frame.
+ * The queue uses the same frame state as Mac802154_setPayload() etc.,
+ * so do not use those or Mac802154_sendBlocking()/Mac802154_sendNonBlocking()
+ * until Mac802154_getNumberOfFramesToSend() returns zero.
+ * @return false if the queue is full or the queue was empty and the
+ * frame could not be handed to the hardware, the frame is not sent in that case
+ */
+bool Mac802154_enqueueFrame(Mac802154 *self, const Mac802154Frame *frame);
+
+/**
+ * @return the number of queued frames, including the one currently transmitted
+ */
+uint8_t Mac802154_getNumberOfFramesToSend(Mac802154 *self);
+
+/**
+ * Sets the acknowledgement request flag of the frame and
+ * makes the hardware wait for the acknowledgement after
+ * each transmission. Missing acknowledgements are handled
+ * by retransmitting the frame from the hardware's fifo,
+ * i.e. without transferring it again, the outcome is reported
+ * by Mac802154_getTransmissionStatus().
+ * Do not request acknowledgements for broadcast frames, they
+ * are never acknowledged.
+ * The setting is kept until disabled or Mac802154_configure()
+ * is called.
+ */
+void Mac802154_enableAcknowledgement(Mac802154 *self);
+
+void Mac802154_disableAcknowledgement(Mac802154 *self);
+
+/**
+ * Reports the status of the last completed transmission.
+ * Call it after Mac802154_sendBlocking() returned or
+ * from the transmission complete callback.
+ */
+void Mac802154_getTransmissionStatus(Mac802154 *self, Mac802154TransmissionStatus *status);
+
 /**
  * A copy of the address is kept internally so you are free to delete
  * it after function return. Be aware that all addresses have to be
@@ -67,6 +312,43 @@ void Mac802154_useExtendedSourceAddress(Mac802154 *self);
  */
 void Mac802154_useShortSourceAddress(Mac802154 *self);
 
+/**
+ * Measures the energy on each channel from MAC802154_FIRST_CHANNEL
+ * on and stores the highest of samples_per_channel measurements
+ * in energy[channel - MAC802154_FIRST_CHANNEL]. Higher values mean
+ * more energy, i.e. a busier channel, the scale depends on the hardware
+ * (for the MRF24J40 see the RSSI register in the datasheet).
+ * Reception is disabled during the scan and the configured channel
+ * is restored afterwards. The function blocks until all channels were
+ * measured, do not start a transmission in the meantime.
+ * @param energy array of MAC802154_NUMBER_OF_CHANNELS values
+ */
+void Mac802154_scanEnergy(Mac802154 *self, uint8_t samples_per_channel, uint8_t *energy);
+
+/**
+ * @param energy result of Mac802154_scanEnergy()
+ * @return the number of the channel with the lowest energy, the
+ *         lowest channel number if several channels are equally quiet
+ */
+uint8_t Mac802154_getQuietestChannel(const uint8_t *energy);
+
+/**
+ * Puts the radio into sleep mode, where it neither
+ * receives nor transmits frames. The configuration,
+ * the addresses and the frame prepared for sending are
+ * retained, so after Mac802154_wakeUp() the radio continues
+ * where it stopped without calling Mac802154_configure() again.
+ * IMPORTANT: Wait for running transmissions and the
+ * transmission queue to complete before calling this.
+ */
+void Mac802154_sleep(Mac802154 *self);
+
+/**
+ * Wakes the radio up from sleep mode. The function
+ * returns once the radio is ready to receive and transmit.
+ */
+void Mac802154_wakeUp(Mac802154 *self);
+
 /**
  * In promiscuous mode all 802.15.4 frames with a
  * correct crc will be received, no matter how their
@@ -79,16 +361,49 @@ void Mac802154_enablePromiscuousMode(Mac802154 *self);
 
 void Mac802154_disablePromiscuousMode(Mac802154 *self);
 
+/**
+ * Drops unwanted frames before they are added to the receive
+ * queue. Filters the hardware supports are applied by the
+ * transceiver, so these frames do not even cause an interrupt,
+ * the others are checked in software. For the MRF24J40 selecting
+ * exactly one of beacon, data or mac command frames is done in
+ * hardware. Mac802154_configure() resets the filter to accept
+ * everything, just like it disables promiscuous mode.
+ */
+void Mac802154_setReceiveFilter(Mac802154 *self, const Mac802154ReceiveFilter *filter);
+
+/**
+ * Selects the frame type (see FRAME_TYPE_DATA) of all following
+ * frames, including frames from the transmission queue.
+ * Data frames are sent by default and after Mac802154_configure().
+ * The payloads of beacons and mac commands can be built with
+ * the functions from Mac802154Command.h.
+ * The addressing fields are not changed, so e.g. for a beacon
+ * request set the broadcast address as destination.
+ */
+void Mac802154_setFrameType(Mac802154 *self, uint8_t frame_type);
+
 /**
  * sets address in big endian representation suitable for network transmission
 */
 void Mac802154_setExtendedDestinationAddress(Mac802154 *self, const uint8_t *address);
 
 /**
- * the payload needs to be alive in memory while transmission is running
+ * the payload needs to be alive in memory while transmission is running.
+ * Only data set since the last transmission is written to the transceiver,
+ * so call this again after changing the content of the payload buffer.
 */
 void Mac802154_setPayload(Mac802154 *self, const uint8_t *payload, size_t payload_length);
 
+/**
+ * Like Mac802154_setPayload(), but the payload is the concatenation
+ * of the segments, e.g. a protocol header and the application data,
+ * so they do not have to be copied into a single buffer first.
+ * Neither the segments nor the array describing them are copied,
+ * so both need to be alive in memory while transmission is running.
+ */
+void Mac802154_setPayloadVector(Mac802154 *self, const Mac802154PayloadSegment *segments, uint8_t number_of_segments);
+
 /**
  *
  * @return size of all data available, this might also include additional information like rssi
@@ -108,6 +423,53 @@ bool Mac802154_newPacketAvailable(Mac802154 *self);
  */
 void Mac802154_fetchPacketBlocking(Mac802154 *self, uint8_t *buffer, uint8_t size);
 
+/**
+ * Combines Mac802154_getReceivedPacketSize() and Mac802154_fetchPacketBlocking(),
+ * but needs only a single transfer to do so. The link quality and rssi values
+ * are appended to the frame like for Mac802154_dequeuePacket().
+ * @return the number of bytes placed in the buffer. To make sure the packet
+ *         is copied completely use a buffer of MAC802154_MAXIMUM_PACKET_SIZE bytes.
+ */
+uint8_t Mac802154_fetchCompletePacketBlocking(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+
+/**
+ * Implementations supporting interrupt driven reception
+ * place received packets into a queue (see e.g. Mac802154MRF_handleInterrupt()).
+ * The functions below are used to retrieve the packets from there.
+ * A dequeued packet has the same format as a packet
+ * returned by Mac802154_fetchPacketBlocking(), so you can use the
+ * inspection functions below on it. Additionally the link quality and
+ * the rssi value are appended to the frame.
+ *
+ * @return the number of bytes copied to the buffer, 0 if no packet was queued.
+ *         To make sure the packet is copied completely use a buffer of
+ *         MAC802154_MAXIMUM_PACKET_SIZE bytes.
+ */
+uint8_t Mac802154_dequeuePacket(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+
+uint8_t Mac802154_getNumberOfQueuedPackets(Mac802154 *self);
+
+/**
+ * Copies the number of transactions (chip select cycles), command bytes,
+ * bytes written and bytes read on the bus to the transceiver, per
+ * category of operation, e.g. the counters for polling the status are
+ * found in statistics->operation[MAC802154_BUS_OPERATION_STATUS_POLL].
+ * The counters are only maintained if the library was compiled with
+ * instrumentation (for the MRF implementation see MRF_IO_STATISTICS),
+ * otherwise all counters are zero.
+ */
+void Mac802154_getBusStatistics(Mac802154 *self, Mac802154BusStatistics *statistics);
+
+/**
+ * Copies the counters of the channel access. Per frame the outcome
+ * is available from Mac802154_getTransmissionStatus(), these are
+ * the sums to compare the configurations of the channel access.
+ * The counters are only maintained if the library was compiled with
+ * instrumentation (for the MRF implementation see
+ * MRF_CHANNEL_ACCESS_STATISTICS), otherwise all counters are zero.
+ */
+void Mac802154_getChannelAccessStatistics(Mac802154 *self, Mac802154ChannelAccessStatistics *statistics);
+
 /**
  * @return A pointer to the start of the payload field
  */
@@ -123,6 +485,85 @@ uint8_t Mac802154_getPacketSourceAddressSize(Mac802154 *self, const uint8_t *pac
 const uint8_t * Mac802154_getPacketExtendedSourceAddress(const Mac802154 *self, const uint8_t *packet);
 const uint8_t * Mac802154_getPacketShortSourceAddress(const Mac802154 *self, const uint8_t *packet);
 
+/**
+ * Return the link quality and rssi values the hardware appended
+ * to the frame. Only use these on packets that contain them, e.g.
+ * from Mac802154_dequeuePacket() or Mac802154_fetchCompletePacketBlocking().
+ */
+uint8_t Mac802154_getPacketLinkQuality(const Mac802154 *self, const uint8_t *packet);
+uint8_t Mac802154_getPacketRssi(const Mac802154 *self, const uint8_t *packet);
+
+/**
+ * Implementations supporting interrupt driven reception keep track of
+ * the link quality of the neighbors they received frames from
+ * (for the MRF implementation see MRF_NEIGHBOR_TABLE_SIZE).
+ * @param address short (2 bytes) or extended (8 bytes) source address
+ *        of the neighbor as found in its frames
+ * @return false if no frame from the neighbor is known
+ */
+bool Mac802154_getNeighborLinkQuality(Mac802154 *self, const uint8_t *address, uint8_t address_size,
+                                      Mac802154LinkQuality *quality);
+
+/**
+ * Positions of the fields of a packet as returned by e.g.
+ * Mac802154_dequeuePacket(). All offsets are relative to the
+ * start of the packet, i.e. the frame length field. A size of
+ * zero means the field is not present in the frame. The same
+ * holds for an offset of zero for the link quality and rssi,
+ * these are only present if the implementation appended them
+ * and they were copied to the buffer.
+ * Fill it with Mac802154_parsePacket() and use the
+ * Mac802154FrameView_* functions below to access the fields.
+ */
+struct Mac802154FrameView {
+  const uint8_t *packet;
+  uint8_t sequence_number_offset;
+  uint8_t sequence_number_size;
+  uint8_t pan_id_offset;
+  uint8_t pan_id_size;
+  uint8_t destination_address_offset;
+  uint8_t destination_address_size;
+  uint8_t source_address_offset;
+  uint8_t source_address_size;
+  uint8_t payload_offset;
+  uint8_t payload_size;
+  uint8_t frame_check_sequence_offset;
+  uint8_t link_quality_offset;
+  uint8_t rssi_offset;
+  uint8_t frame_type;
+};
+
+/**
+ * Decodes the frame control field once and stores the positions
+ * of all fields in the view. The packet is not copied, so it has to
+ * stay alive and unchanged as long as the view is used.
+ * Prefer this over the Mac802154_getPacket* functions above
+ * if you need more than one field of a packet, as each of those
+ * decodes the frame control field again.
+ * @param packet_size the number of bytes in the buffer, e.g. as
+ *        returned by Mac802154_dequeuePacket()
+ * @return false if the frame length field or the header do not fit
+ *         into packet_size, the view must not be used in that case
+ */
+bool Mac802154_parsePacket(Mac802154 *self, const uint8_t *packet, uint8_t packet_size, Mac802154FrameView *view);
+
+/**
+ * The pointer returning functions below return NULL
+ * if the field is not present in the frame.
+ */
+const uint8_t *Mac802154FrameView_getSequenceNumber(const Mac802154FrameView *view);
+uint8_t Mac802154FrameView_getFrameType(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getPanId(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getDestinationAddress(const Mac802154FrameView *view);
+uint8_t Mac802154FrameView_getDestinationAddressSize(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getSourceAddress(const Mac802154FrameView *view);
+uint8_t Mac802154FrameView_getSourceAddressSize(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getPayload(const Mac802154FrameView *view);
+uint8_t Mac802154FrameView_getPayloadSize(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getFrameCheckSequence(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getLinkQuality(const Mac802154FrameView *view);
+const uint8_t *Mac802154FrameView_getRssi(const Mac802154FrameView *view);
+
 enum {
   FRAME_TYPE_BEACON = 0,
   FRAME_TYPE_DATA = 1,
@@ -145,16 +586,28 @@ struct Mac802154 {
   void (*setShortDestinationAddress)(Mac802154 *self, const uint8_t *address);
   void (*setExtendedDestinationAddress)(Mac802154 *self, const uint8_t *address);
   void (*setPayload)(Mac802154 *self, const uint8_t *buffer, size_t size);
+  void (*setPayloadVector)(Mac802154 *self, const Mac802154PayloadSegment *segments, uint8_t number_of_segments);
   void (*useExtendedSourceAddress) (Mac802154 *self);
   void (*useShortSourceAddress) (Mac802154 *self);
 
   void (*sendBlocking) (Mac802154 *self);
-  void (*sendNonBlocking) (Mac802154 *self);
+  bool (*sendNonBlocking) (Mac802154 *self);
+  void (*setTransmissionCompleteCallback) (Mac802154 *self, Mac802154Callback callback);
+  bool (*enqueueFrame) (Mac802154 *self, const Mac802154Frame *frame);
+  uint8_t (*getNumberOfFramesToSend) (Mac802154 *self);
+  void (*enableAcknowledgement) (Mac802154 *self);
+  void (*disableAcknowledgement) (Mac802154 *self);
+  void (*getTransmissionStatus) (Mac802154 *self, Mac802154TransmissionStatus *status);
   void (*reconfigure) (Mac802154 *self, const Mac802154Config *config);
 
   uint8_t (*getReceivedPacketSize) (Mac802154 *self);
   bool (*newPacketAvailable) (Mac802154 *self);
   void (*fetchPacketBlocking) (Mac802154 *self, uint8_t *buffer, uint8_t size);
+  uint8_t (*fetchCompletePacketBlocking) (Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+  uint8_t (*dequeuePacket) (Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+  uint8_t (*getNumberOfQueuedPackets) (Mac802154 *self);
+  void (*getBusStatistics) (Mac802154 *self, Mac802154BusStatistics *statistics);
+  void (*getChannelAccessStatistics) (Mac802154 *self, Mac802154ChannelAccessStatistics *statistics);
   const uint8_t *(*getPacketPayload) (const uint8_t *packet);
   uint8_t (*getPacketPayloadSize) (const uint8_t *packet);
   bool (*packetAddressIsShort) (const uint8_t *packet);
@@ -162,9 +615,19 @@ struct Mac802154 {
   uint8_t (*getPacketSourceAddressSize) (const uint8_t *packet);
   const uint8_t *(*getPacketExtendedSourceAddress) (const uint8_t *packet);
   const uint8_t *(*getPacketShortSourceAddress) (const uint8_t *packet);
+  uint8_t (*getPacketLinkQuality) (const uint8_t *packet);
+  uint8_t (*getPacketRssi) (const uint8_t *packet);
+  bool (*getNeighborLinkQuality) (Mac802154 *self, const uint8_t *address, uint8_t address_size,
+                                  Mac802154LinkQuality *quality);
+  bool (*parsePacket) (const uint8_t *packet, uint8_t packet_size, Mac802154FrameView *view);
 
   void (*enablePromiscuousMode) (Mac802154 *self);
   void (*disablePromiscuousMode) (Mac802154 *self);
+  void (*setReceiveFilter) (Mac802154 *self, const Mac802154ReceiveFilter *filter);
+  void (*setFrameType) (Mac802154 *self, uint8_t frame_type);
+  void (*scanEnergy) (Mac802154 *self, uint8_t samples_per_channel, uint8_t *energy);
+  void (*sleep) (Mac802154 *self);
+  void (*wakeUp) (Mac802154 *self);
 
 };
 
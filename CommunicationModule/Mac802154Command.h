@@ -0,0 +1,139 @@
+#ifndef COMMUNICATIONMODULE_MAC802154COMMAND_H
+#define COMMUNICATIONMODULE_MAC802154COMMAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Payloads of beacon and mac command frames as defined
+ * by 802.15.4-2015 (7.3.1 and 7.5). The functions below only
+ * write and parse the payload, it is sent like any other payload
+ * after selecting the frame type, e.g.
+ *
+ *     uint8_t payload[MAC802154_MAXIMUM_COMMAND_SIZE];
+ *     uint8_t size = Mac802154Command_writeAssociationRequest(payload, capabilities);
+ *     Mac802154_setShortDestinationAddress(mac, coordinator);
+ *     Mac802154_setFrameType(mac, FRAME_TYPE_MAC_COMMAND);
+ *     Mac802154_setPayload(mac, payload, size);
+ *     Mac802154_sendBlocking(mac);
+ *
+ * For received frames pass the payload to the parsers after checking
+ * the frame type with Mac802154FrameView_getFrameType().
+ * Addresses are kept in the byte order they have in the frame,
+ * i.e. the same order as used by Mac802154Config.
+ */
+
+typedef struct Mac802154AssociationResponse Mac802154AssociationResponse;
+typedef struct Mac802154Beacon Mac802154Beacon;
+typedef struct Mac802154GuaranteedTimeSlot Mac802154GuaranteedTimeSlot;
+
+enum {
+  MAC802154_COMMAND_ASSOCIATION_REQUEST = 0x01,
+  MAC802154_COMMAND_ASSOCIATION_RESPONSE = 0x02,
+  MAC802154_COMMAND_DATA_REQUEST = 0x04,
+  MAC802154_COMMAND_BEACON_REQUEST = 0x07,
+  MAC802154_MAXIMUM_COMMAND_SIZE = 4,
+};
+
+enum {
+  MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS = 7,
+  /**
+   * Size of a beacon with all guaranteed time slots
+   * and without pending addresses and payload.
+   */
+  MAC802154_MAXIMUM_BEACON_SIZE_WITHOUT_PAYLOAD = 26,
+};
+
+/**
+ * Bits of the capability information
+ * field of an association request.
+ */
+enum {
+  MAC802154_CAPABILITY_FULL_FUNCTION_DEVICE = 1 << 1,
+  MAC802154_CAPABILITY_MAINS_POWERED = 1 << 2,
+  MAC802154_CAPABILITY_RECEIVER_ON_WHEN_IDLE = 1 << 3,
+  MAC802154_CAPABILITY_ALLOCATE_ADDRESS = 1 << 7,
+};
+
+enum {
+  MAC802154_ASSOCIATION_SUCCESSFUL = 0x00,
+  MAC802154_ASSOCIATION_PAN_AT_CAPACITY = 0x01,
+  MAC802154_ASSOCIATION_PAN_ACCESS_DENIED = 0x02,
+};
+
+struct Mac802154AssociationResponse {
+  uint8_t short_address[2];
+  uint8_t status;
+};
+
+/**
+ * A guaranteed time slot of a device, i.e. length consecutive
+ * superframe slots following the contention access period.
+ * Slots with receive set are used by the coordinator to
+ * send to the device, otherwise the device sends.
+ */
+struct Mac802154GuaranteedTimeSlot {
+  uint8_t short_address[2];
+  uint8_t starting_slot;
+  uint8_t length;
+  bool receive;
+};
+
+/**
+ * The superframe specification, the guaranteed time slots
+ * and the payload of a beacon. Orders of 15 mean a
+ * nonbeacon-enabled pan.
+ * The payload is not copied by Mac802154Beacon_parse(), it points
+ * into the received frame.
+ */
+struct Mac802154Beacon {
+  uint8_t beacon_order;
+  uint8_t superframe_order;
+  uint8_t final_cap_slot;
+  bool pan_coordinator;
+  bool association_permit;
+  bool guaranteed_time_slot_permit;
+  uint8_t number_of_guaranteed_time_slots;
+  Mac802154GuaranteedTimeSlot guaranteed_time_slots[MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS];
+  const uint8_t *payload;
+  uint8_t payload_size;
+};
+
+/**
+ * The write functions expect a buffer of at least
+ * MAC802154_MAXIMUM_COMMAND_SIZE bytes.
+ * @return the number of bytes written
+ */
+uint8_t Mac802154Command_writeAssociationRequest(uint8_t *buffer, uint8_t capability_information);
+uint8_t Mac802154Command_writeAssociationResponse(uint8_t *buffer, const Mac802154AssociationResponse *response);
+uint8_t Mac802154Command_writeDataRequest(uint8_t *buffer);
+uint8_t Mac802154Command_writeBeaconRequest(uint8_t *buffer);
+
+/**
+ * @return the command frame identifier, 0 if the payload is empty
+ */
+uint8_t Mac802154Command_getIdentifier(const uint8_t *payload, uint8_t payload_size);
+
+/**
+ * The parse functions return false if the payload is not
+ * the expected command or is too short.
+ */
+bool Mac802154Command_parseAssociationRequest(const uint8_t *payload, uint8_t payload_size,
+                                              uint8_t *capability_information);
+bool Mac802154Command_parseAssociationResponse(const uint8_t *payload, uint8_t payload_size,
+                                               Mac802154AssociationResponse *response);
+
+/**
+ * Writes a beacon without pending addresses. The buffer needs
+ * MAC802154_MAXIMUM_BEACON_SIZE_WITHOUT_PAYLOAD bytes plus
+ * the payload size.
+ * @return the number of bytes written
+ */
+uint8_t Mac802154Beacon_write(uint8_t *buffer, const Mac802154Beacon *beacon);
+
+/**
+ * Pending addresses announced by the coordinator are skipped.
+ */
+bool Mac802154Beacon_parse(const uint8_t *payload, uint8_t payload_size, Mac802154Beacon *beacon);
+
+#endif //COMMUNICATIONMODULE_MAC802154COMMAND_H
@@ -3,6 +3,7 @@
 
 #include "CommunicationModule/Mac802154.h"
 #include "CommunicationModule/FrameHeader802154Struct.h"
+#include "CommunicationModule/Mac802154Command.h"
 
 /*!
  * \file Mac802154MRFImpl.h
@@ -28,6 +29,23 @@ typedef struct GPIOPin {
     uint8_t pin_number;
 } GPIOPin;
 
+/**
+ * Transmitter power levels for MRFConfig.transmitter_power and
+ * Mac802154MRF_setTransmitterPower(). A level is the attenuation
+ * below the maximum output power in 32 steps, the upper two bits
+ * select -0/-10/-20/-30dB, the lower three bits additionally
+ * -0/-0.5/-1.2/-1.9/-2.8/-3.7/-4.9/-6.3dB.
+ * So every level is lower than the previous one, e.g. level 9 is
+ * -10.5dB and MRF_TRANSMITTER_POWER_LOWEST is -36.3dB.
+ */
+enum {
+    MRF_TRANSMITTER_POWER_0DB = 0,
+    MRF_TRANSMITTER_POWER_MINUS_10DB = 8,
+    MRF_TRANSMITTER_POWER_MINUS_20DB = 16,
+    MRF_TRANSMITTER_POWER_MINUS_30DB = 24,
+    MRF_TRANSMITTER_POWER_LOWEST = 31,
+};
+
 struct MRFConfig
 {
     uint8_t transmitter_power;
@@ -44,6 +62,152 @@ void
 Mac802154MRF_create(Mac802154 *memory,
                     MRFConfig *config);
 
+/**
+ * Reads the interrupt status of the MRF and handles
+ * pending events, e.g. executes the transmission complete
+ * callback after a non blocking transmission finished
+ * and starts the next frame from the transmission queue
+ * (see Mac802154_enqueueFrame()) or moves a received packet from the MRF into the receive
+ * queue (see Mac802154_dequeuePacket() and MRF_RX_QUEUE_SIZE). If the queue is full
+ * the packet stays in the MRF and Mac802154_newPacketAvailable() keeps
+ * reporting it, it is moved by the next call after a packet was dequeued.
+ * A packet carrying the same sequence number as the previous packet from
+ * the same sender, i.e. a retransmission, is discarded
+ * (see MRF_DUPLICATE_FILTER_SIZE).
+ * The link quality of every packet is added to the neighbor
+ * table (see Mac802154_getNeighborLinkQuality()).
+ * Call this function from the interrupt service routine
+ * connected to the INT pin of the MRF.
+ * While non blocking transfers (e.g. of Mac802154_sendNonBlocking(),
+ * Mac802154_enqueueFrame() or of another instance sharing the
+ * PeripheralInterface) are running, the function returns false
+ * without talking to the MRF, as it would have to wait for them.
+ * The events stay pending on the MRF (the INT pin stays active),
+ * so call the function again later, e.g. from your main loop,
+ * until it returns true.
+ * IMPORTANT: As the function talks to the MRF via the
+ * PeripheralInterface, it must not interrupt any other
+ * blocking function operating on the same Mac802154 instance.
+ * If you cannot guarantee this, set a flag in your
+ * interrupt service routine instead and call this function
+ * from your main loop.
+ * @return false if the interrupt could not be handled yet
+ */
+bool
+Mac802154MRF_handleInterrupt(Mac802154 *self);
+
+/**
+ * Several instances can be created, e.g. for boards carrying
+ * more than one MRF. Every instance keeps its own queues and
+ * is driven by its own interrupt, i.e. the interrupt service
+ * routine of each INT pin calls Mac802154MRF_handleInterrupt()
+ * for the corresponding instance.
+ * If the MRFs are connected to the same PeripheralInterface
+ * (with different Peripherals), call this function once for
+ * every additional instance after creating it, e.g.
+ *
+ *     Mac802154MRF_create(first, &first_config);
+ *     Mac802154MRF_create(second, &second_config);
+ *     Mac802154MRF_shareInterface(second, first);
+ *
+ * Afterwards transfers of the instances are executed one
+ * after another instead of interfering with each other.
+ * The restriction mentioned for Mac802154MRF_handleInterrupt()
+ * then holds for all instances sharing the interface.
+ */
+void
+Mac802154MRF_shareInterface(Mac802154 *self, Mac802154 *other);
+
+/**
+ * Changes the transmitter power to one of the levels
+ * described at MRF_TRANSMITTER_POWER_0DB, larger values are
+ * limited to MRF_TRANSMITTER_POWER_LOWEST. The level is kept
+ * when reconfiguring and is the highest power
+ * Mac802154MRF_adaptTransmitterPower() returns to.
+ * Initially this is MRFConfig.transmitter_power.
+ */
+void
+Mac802154MRF_setTransmitterPower(Mac802154 *self, uint8_t level);
+
+/**
+ * @return the currently used level, see Mac802154MRF_setTransmitterPower()
+ */
+uint8_t
+Mac802154MRF_getTransmitterPower(Mac802154 *self);
+
+/**
+ * One iteration of a simple transmitter power control.
+ * Pass the link quality the peer reported for your last frame,
+ * e.g. as part of its answer, or 0 if there was no answer.
+ * If it is above MRF_ADAPTIVE_POWER_REDUCE_THRESHOLD the power is
+ * lowered by one level, if it is below
+ * MRF_ADAPTIVE_POWER_RAISE_THRESHOLD it is raised by
+ * MRF_ADAPTIVE_POWER_RAISE_STEPS levels, but never above the level
+ * set with Mac802154MRF_setTransmitterPower().
+ * The link quality is the one appended by the MRF to received
+ * frames, so for a symmetric link the value from
+ * Mac802154_getNeighborLinkQuality() is a reasonable estimate.
+ * Use a separate radio instance or call
+ * Mac802154MRF_setTransmitterPower() before talking to a different peer,
+ * as the level is not tracked per destination.
+ */
+void
+Mac802154MRF_adaptTransmitterPower(Mac802154 *self, uint8_t link_quality);
+
+/**
+ * Turns the device into the coordinator of a beacon-enabled pan.
+ * The MRF sends the beacon every 15.36ms * 2^beacon_order on its
+ * own, followed by the active part of the superframe of
+ * 15.36ms * 2^superframe_order. The first final_cap_slot + 1 of its
+ * 16 slots are the contention access period, the guaranteed time
+ * slots of the beacon follow. Frames sent with
+ * Mac802154_sendBlocking() use slotted csma-ca within the contention
+ * access period then.
+ * The beacon is sent with the short source address and pan id
+ * of the configuration and its own sequence number. Including the
+ * 7 byte header and the payload it has to fit into a 127 byte frame
+ * together with the frame check sequence. Call the function again to change the
+ * beacon, e.g. after allocating a guaranteed time slot.
+ * As the MRF repeats the beacon unchanged, receivers see the same
+ * sequence number until then and their duplicate filter only
+ * passes the first one (see MRF_DUPLICATE_FILTER_SIZE).
+ * The receiver stays on in the inactive part of the superframe.
+ * @return false if the orders do not describe a beacon-enabled
+ * pan, i.e. the beacon order is 15 or smaller than the superframe order,
+ * or if the beacon is too large. Nothing is changed in that case.
+ */
+bool
+Mac802154MRF_startBeaconEnabledPan(Mac802154 *self, const Mac802154Beacon *beacon);
+
+/**
+ * Synchronizes an end device to the superframe described by a
+ * beacon received from its coordinator, see Mac802154Beacon_parse().
+ * If the beacon contains a guaranteed time slot for sending
+ * that belongs to the short source address of the configuration,
+ * frames can be sent in it with Mac802154MRF_sendInGuaranteedTimeSlot().
+ * Call the function again for a beacon with a changed allocation.
+ * @return false if the beacon belongs to a nonbeacon-enabled pan
+ */
+bool
+Mac802154MRF_joinBeaconEnabledPan(Mac802154 *self, const Mac802154Beacon *beacon);
+
+/**
+ * Returns to unslotted csma-ca and stops sending beacons.
+ * Reconfiguring has the same effect.
+ */
+void
+Mac802154MRF_leaveBeaconEnabledPan(Mac802154 *self);
+
+/**
+ * Sends the frame set up like for Mac802154_sendBlocking() in the
+ * guaranteed time slot of the device in the next superframe.
+ * The function does not wait for the transmission, call it
+ * at most once per superframe.
+ * @return false if the device has no guaranteed time slot for sending
+ */
+bool
+Mac802154MRF_sendInGuaranteedTimeSlot(Mac802154 *self);
+
 
 /**
  * ATTENTION:
@@ -57,6 +221,21 @@ typedef struct MrfState MrfState;
 typedef struct MrfHeader MrfHeader;
 typedef struct MrfIoCallback MrfIoCallback;
 typedef struct MrfIo_NonBlockingWriteContext MrfIo_NonBlockingWriteContext;
+typedef struct MrfIo_NonBlockingReadContext MrfIo_NonBlockingReadContext;
+typedef struct MrfIoTransfer MrfIoTransfer;
+
+/**
+ * Maximum number of non blocking transfers that can be
+ * queued at the same time plus one. Has to be a power of two.
+ * A non blocking transmission takes up to three transfers
+ * (header or frame length and sequence number, and the trigger)
+ * plus one per payload segment, i.e. with the default size
+ * Mac802154_sendNonBlocking() fails for more than four segments.
+ * Every transfer costs 10 bytes of ram per instance on the avr.
+ */
+#ifndef MRF_IO_TRANSFER_QUEUE_SIZE
+#define MRF_IO_TRANSFER_QUEUE_SIZE 8
+#endif
 
 struct MrfIoCallback {
     void (*function) (void *arg);
@@ -71,15 +250,176 @@ struct MrfIo_NonBlockingWriteContext
     uint16_t address;
 };
 
+struct MrfIo_NonBlockingReadContext
+{
+    MrfIoCallback callback;
+    uint8_t *input_buffer;
+    uint8_t length;
+    uint16_t address;
+};
+
+struct MrfIoTransfer {
+    MrfIoCallback callback;
+    uint8_t *buffer;
+    uint8_t length;
+    uint16_t address;
+    uint8_t type;
+};
+
+/**
+ * Set to 1 to count the transfers between mcu and mrf,
+ * see Mac802154_getBusStatistics(). Has to be the
+ * same for all translation units, with bazel use
+ * --define bus_statistics=true
+ */
+#ifndef MRF_IO_STATISTICS
+#define MRF_IO_STATISTICS 0
+#endif
+
+/**
+ * Set to 1 to keep a copy of the configuration registers
+ * (RXMCR, PACON2, TXSTBL, BBREG2, CCAEDTH, RFCON0-8 and
+ * SLPCON0/1) in MrfIo. Writing the value a register already
+ * holds is skipped then and reading these registers does
+ * not access the bus. Costs 18 bytes of ram per instance.
+ * Has to be the same for all translation units, with bazel use
+ * --define register_cache=true
+ */
+#ifndef MRF_IO_REGISTER_CACHE
+#define MRF_IO_REGISTER_CACHE 0
+#endif
+
+typedef struct MrfIoRegisterCache MrfIoRegisterCache;
+
+enum {
+    MRF_IO_REGISTER_CACHE_SIZE = 16,
+};
+
+struct MrfIoRegisterCache {
+    uint8_t values[MRF_IO_REGISTER_CACHE_SIZE];
+    uint16_t valid;
+};
 
 struct MrfIo {
     Peripheral *device;
     PeripheralInterface *interface;
     uint8_t command[2];
     uint8_t command_size;
-    uint8_t length;
-    const uint8_t *output_buffer;
-    MrfIoCallback callback;
+    MrfIoTransfer queue[MRF_IO_TRANSFER_QUEUE_SIZE];
+    volatile uint8_t queue_head;
+    volatile uint8_t queue_tail;
+    volatile bool busy;
+    uint8_t transfer_step;
+    MrfIo *next_on_interface;
+#if MRF_IO_STATISTICS
+    Mac802154BusStatistics statistics;
+    uint8_t tx_payload_start;
+#endif
+#if MRF_IO_REGISTER_CACHE
+    MrfIoRegisterCache register_cache;
+#endif
+};
+
+/**
+ * Number of received packets that can be kept
+ * by the driver. Has to be a power of two or 0.
+ * Every packet costs MAC802154_MAXIMUM_PACKET_SIZE
+ * (130) bytes of ram per instance, so the queue is
+ * disabled by default and packets are fetched via
+ * Mac802154_newPacketAvailable() and
+ * Mac802154_fetchCompletePacketBlocking().
+ * Mac802154MRF_handleInterrupt() leaves received packets
+ * in the mrf then, so neither the duplicate filter nor
+ * the neighbor table are fed and both can be set to 0 as well.
+ * With bazel use --define rx_queue=true for a queue of
+ * two packets.
+ */
+#ifndef MRF_RX_QUEUE_SIZE
+#define MRF_RX_QUEUE_SIZE 0
+#endif
+
+typedef struct MrfRxQueue MrfRxQueue;
+
+struct MrfRxQueue {
+#if MRF_RX_QUEUE_SIZE > 0
+    uint8_t packets[MRF_RX_QUEUE_SIZE][MAC802154_MAXIMUM_PACKET_SIZE];
+#endif
+    volatile uint8_t head;
+    volatile uint8_t tail;
+};
+
+/**
+ * Number of frames that can be queued for
+ * transmission, see Mac802154_enqueueFrame().
+ * Has to be a power of two or 0, every frame costs
+ * 12 bytes of ram per instance on the avr. With 0
+ * Mac802154_enqueueFrame() always fails.
+ */
+#ifndef MRF_TX_QUEUE_SIZE
+#define MRF_TX_QUEUE_SIZE 4
+#endif
+
+typedef struct MrfTxQueue MrfTxQueue;
+
+struct MrfTxQueue {
+#if MRF_TX_QUEUE_SIZE > 0
+    Mac802154Frame frames[MRF_TX_QUEUE_SIZE];
+#endif
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile bool sending_head;
+};
+
+/**
+ * Number of senders for which the sequence number of
+ * the last received frame is kept to detect duplicates.
+ * Every sender costs 10 bytes of ram per instance.
+ * Set to 0 to disable duplicate detection.
+ */
+#ifndef MRF_DUPLICATE_FILTER_SIZE
+#define MRF_DUPLICATE_FILTER_SIZE 4
+#endif
+
+typedef struct MrfDuplicateFilter MrfDuplicateFilter;
+typedef struct MrfDuplicateFilterEntry MrfDuplicateFilterEntry;
+
+struct MrfDuplicateFilterEntry {
+    uint8_t source_address[8];
+    uint8_t source_address_size;
+    uint8_t sequence_number;
+};
+
+struct MrfDuplicateFilter {
+#if MRF_DUPLICATE_FILTER_SIZE > 0
+    MrfDuplicateFilterEntry entries[MRF_DUPLICATE_FILTER_SIZE];
+#endif
+    uint8_t next_entry;
+};
+
+/**
+ * Number of neighbors whose link quality is tracked,
+ * see Mac802154_getNeighborLinkQuality().
+ * Every neighbor costs 12 bytes of ram per instance.
+ * Set to 0 to disable the neighbor table.
+ */
+#ifndef MRF_NEIGHBOR_TABLE_SIZE
+#define MRF_NEIGHBOR_TABLE_SIZE 4
+#endif
+
+typedef struct MrfNeighborTable MrfNeighborTable;
+typedef struct MrfNeighbor MrfNeighbor;
+
+struct MrfNeighbor {
+    uint8_t address[8];
+    uint8_t address_size;
+    Mac802154LinkQuality quality;
+};
+
+struct MrfNeighborTable {
+#if MRF_NEIGHBOR_TABLE_SIZE > 0
+    MrfNeighbor neighbors[MRF_NEIGHBOR_TABLE_SIZE];
+#endif
+    uint8_t next_entry;
 };
 
 struct MrfHeader {
@@ -90,16 +430,66 @@ struct MrfHeader {
 
 struct MrfState {
     uint8_t state;
+    uint8_t current_field;
     MrfHeader header;
     const uint8_t *payload;
+    const Mac802154PayloadSegment *payload_segments;
+    uint8_t number_of_payload_segments;
 };
 
+#ifndef MRF_ADAPTIVE_POWER_REDUCE_THRESHOLD
+#define MRF_ADAPTIVE_POWER_REDUCE_THRESHOLD 0xE0
+#endif
+
+#ifndef MRF_ADAPTIVE_POWER_RAISE_THRESHOLD
+#define MRF_ADAPTIVE_POWER_RAISE_THRESHOLD 0xB0
+#endif
+
+/**
+ * Raising faster than lowering the power keeps the time
+ * spent on a failing link short.
+ */
+#ifndef MRF_ADAPTIVE_POWER_RAISE_STEPS
+#define MRF_ADAPTIVE_POWER_RAISE_STEPS 4
+#endif
+
+/**
+ * Set to 1 to read the transmission status after every
+ * frame and sum it up, see Mac802154_getChannelAccessStatistics().
+ * Costs one additional transaction per frame. Has to be the
+ * same for all translation units, with bazel use
+ * --define channel_access_statistics=true
+ */
+#ifndef MRF_CHANNEL_ACCESS_STATISTICS
+#define MRF_CHANNEL_ACCESS_STATISTICS 0
+#endif
+
 struct Mrf {
     Mac802154 mac;
     MrfIo io;
     void (*delay_microseconds)(uint16_t);
     MrfState state;
     Mac802154Config config;
+    Mac802154Callback transmission_complete_callback;
+    volatile bool transmission_in_progress;
+    uint8_t tx_normal_fifo_control;
+    volatile uint8_t interrupt_status;
+    uint8_t sequence_number;
+    uint8_t beacon_sequence_number;
+    uint8_t transmitter_power;
+    uint8_t highest_transmitter_power;
+    bool promiscuous_mode;
+    Mac802154ReceiveFilter receive_filter;
+    bool pan_coordinator;
+    bool slotted_mode;
+    uint8_t guaranteed_time_slot;
+    MrfRxQueue rx_queue;
+    MrfTxQueue tx_queue;
+    MrfDuplicateFilter duplicate_filter;
+    MrfNeighborTable neighbor_table;
+#if MRF_CHANNEL_ACCESS_STATISTICS
+    Mac802154ChannelAccessStatistics channel_access_statistics;
+#endif
 };
 
 
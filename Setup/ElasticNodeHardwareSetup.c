@@ -2,6 +2,7 @@
 #include "PeripheralInterface/PeripheralSPIImpl.h"
 #include "PeripheralInterface/PeripheralInterface.h"
 #include "Setup/HardwareSetup.h"
+#include "Setup/MrfSetup.h"
 #include "PeripheralInterface/Usart.h"
 #include "EmbeddedUtilities/Debug.h"
 #include "Setup/DebugSetup.h"
@@ -60,19 +61,13 @@ setUpMac(void)
   setUpPeripheral();
   if (mac802154 == NULL)
   {
-    MRFConfig mrf_hardware_config = {
-            .delay_microseconds = delay_microseconds,
-            .device = &mrf_spi_client,
-            .interface = peripheral_interface,
-            .reset_line = {
-                    .data_direction_register = &DDRB,
-                    .data_register = &PORTB,
-                    .pin_number = 5,
-            },
-            .transmitter_power = 0,
+    GPIOPin reset_line = {
+            .data_direction_register = &DDRB,
+            .data_register = &PORTB,
+            .pin_number = 5,
     };
     mac802154 = malloc(Mac802154MRF_getADTSize());
-    Mac802154MRF_create(mac802154, &mrf_hardware_config);
+    createMrf(mac802154, &mrf_spi_client, reset_line);
   }
 }
 
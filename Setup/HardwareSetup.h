@@ -15,6 +15,19 @@ setUpMac(void);
 void
 setUpPeripheral(void);
 
+/**
+ * Creates a further MRF instance for boards carrying more
+ * than one module. It uses the same PeripheralInterface as
+ * mac802154, so setUpMac() has to be called first. The
+ * memory has to provide Mac802154MRF_getADTSize() bytes,
+ * e.g. a statically allocated Mrf.
+ * Remember to call Mac802154_configure() for the new instance
+ * and to call Mac802154MRF_handleInterrupt() with it from
+ * the interrupt service routine of its INT pin.
+ */
+void
+setUpAdditionalMac(Mac802154 *memory, SPISlave *device, GPIOPin reset_line);
+
 void
 delay_microseconds(uint16_t microseconds);
 
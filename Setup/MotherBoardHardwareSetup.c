@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include "Setup/HardwareSetup.h"
+#include "Setup/MrfSetup.h"
 
 #include <avr/io.h>
 #include <util/delay.h>
@@ -45,16 +46,10 @@ setUpMac(void)
   setUpPeripheral();
   if (mac802154 == NULL)
   {
-    MRFConfig mrf_hardware_config = {
-            .delay_microseconds = delay_microseconds,
-            .device = &mrf_spi_client,
-            .interface = peripheral_interface,
-            .reset_line = {
-                    .data_direction_register = NULL,
-            },
-            .transmitter_power = 0,
+    GPIOPin reset_line = {
+            .data_direction_register = NULL,
     };
     mac802154 = (Mac802154*)&mac;
-    Mac802154MRF_create(mac802154, &mrf_hardware_config);
+    createMrf(mac802154, &mrf_spi_client, reset_line);
   }
 }
@@ -0,0 +1,25 @@
+#include <stdint.h>
+#include "Setup/HardwareSetup.h"
+#include "Setup/MrfSetup.h"
+
+void
+createMrf(Mac802154 *memory, SPISlave *device, GPIOPin reset_line)
+{
+  MRFConfig mrf_hardware_config = {
+          .delay_microseconds = delay_microseconds,
+          .device = device,
+          .interface = peripheral_interface,
+          .reset_line = reset_line,
+          .transmitter_power = MRF_SETUP_TRANSMITTER_POWER,
+  };
+  Mac802154MRF_create(memory, &mrf_hardware_config);
+}
+
+void
+setUpAdditionalMac(Mac802154 *memory, SPISlave *device, GPIOPin reset_line)
+{
+  PeripheralInterface_selectPeripheral(peripheral_interface, device);
+  PeripheralInterface_deselectPeripheral(peripheral_interface, device);
+  createMrf(memory, device, reset_line);
+  Mac802154MRF_shareInterface(memory, mac802154);
+}
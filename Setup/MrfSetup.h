@@ -0,0 +1,22 @@
+#ifndef COMMUNICATIONMODULE_MRFSETUP_H
+#define COMMUNICATIONMODULE_MRFSETUP_H
+
+#include "CommunicationModule/CommunicationModule.h"
+
+/**
+ * Transmitter power every MRF created by the hardware setups
+ * starts with, see MRFConfig.transmitter_power.
+ */
+#ifndef MRF_SETUP_TRANSMITTER_POWER
+#define MRF_SETUP_TRANSMITTER_POWER MRF_TRANSMITTER_POWER_0DB
+#endif
+
+/**
+ * Creates an MRF instance using peripheral_interface. The
+ * board specific setUpMac() calls this for mac802154 after
+ * setting up the peripheral interface.
+ */
+void
+createMrf(Mac802154 *memory, SPISlave *device, GPIOPin reset_line);
+
+#endif //COMMUNICATIONMODULE_MRFSETUP_H
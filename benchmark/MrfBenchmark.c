@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CommunicationModule/CommunicationModule.h"
+#include "test/Simulation/MrfSimulator.h"
+
+/*
+ * Measures the cost of the hot paths of the MRF driver
+ * against the simulated chip from test/Simulation.
+ * All numbers are per operation:
+ *  - operations per second of simulated time (spi at 8MHz plus air time)
+ *  - spi bytes
+ *  - spi transactions, i.e. chip select cycles
+ * The output is csv, so results before and after a change
+ * can be compared with diff or any spreadsheet tool.
+ *
+ *     bazel run //benchmark:MrfBenchmark
+ */
+
+void debug(const uint8_t *message) {}
+
+enum {
+  NUMBER_OF_REPETITIONS = 100,
+};
+
+typedef struct Node {
+  MrfSimulator chip;
+  Mac802154 *mac;
+  Mac802154Config config;
+} Node;
+
+typedef struct Measurement {
+  uint32_t start_time;
+  uint32_t start_spi_bytes;
+  uint32_t start_spi_transactions;
+} Measurement;
+
+typedef struct Result {
+  uint32_t duration;
+  uint32_t spi_bytes;
+  uint32_t spi_transactions;
+} Result;
+
+static MrfSimulatorMedium medium;
+static Node sender;
+static Node receiver;
+
+static const uint8_t payload_sizes[] = {0, 16, 32, 64, 100};
+
+static void
+advanceSimulatedTime(uint16_t microseconds)
+{
+  MrfSimulatorMedium_advanceTime(&medium, microseconds);
+}
+
+static void
+createNode(Node *node, uint8_t address)
+{
+  MrfSimulator_create(&node->chip, &medium);
+  MRFConfig hardware_config = {
+    .transmitter_power = 0,
+    .reset_line = {
+      .data_direction_register = NULL,
+      .data_register = NULL,
+      .pin_number = 0,
+    },
+    .delay_microseconds = advanceSimulatedTime,
+    .interface = MrfSimulator_getInterface(&node->chip),
+    .device = NULL,
+  };
+  node->config.channel = 12;
+  node->config.pan_id[0] = 0x34;
+  node->config.pan_id[1] = 0x12;
+  node->config.short_source_address[0] = address;
+  node->config.short_source_address[1] = 0;
+  memset(node->config.extended_source_address, address, 8);
+  node->mac = malloc(Mac802154MRF_getADTSize());
+  Mac802154MRF_create(node->mac, &hardware_config);
+  Mac802154_configure(node->mac, &node->config);
+}
+
+static void
+setUpNetwork(void)
+{
+  MrfSimulatorMedium_init(&medium);
+  createNode(&sender, 1);
+  createNode(&receiver, 2);
+}
+
+static void
+tearDownNetwork(void)
+{
+  free(sender.mac);
+  free(receiver.mac);
+}
+
+/*
+ * Executes the spi interrupts of the pending non blocking transfers.
+ */
+static void
+completeTransfers(Node *node)
+{
+  while (MrfSimulator_step(&node->chip)) {}
+}
+
+static void
+startMeasurement(Measurement *measurement, const Node *node)
+{
+  const MrfSimulatorStatistics *statistics = MrfSimulator_getStatistics(&node->chip);
+  measurement->start_time = MrfSimulatorMedium_getTimeInMicroseconds(&medium);
+  measurement->start_spi_bytes = statistics->spi_bytes;
+  measurement->start_spi_transactions = statistics->spi_transactions;
+}
+
+static void
+stopMeasurement(const Measurement *measurement, const Node *node, Result *result)
+{
+  const MrfSimulatorStatistics *statistics = MrfSimulator_getStatistics(&node->chip);
+  result->duration += MrfSimulatorMedium_getTimeInMicroseconds(&medium) - measurement->start_time;
+  result->spi_bytes += statistics->spi_bytes - measurement->start_spi_bytes;
+  result->spi_transactions += statistics->spi_transactions - measurement->start_spi_transactions;
+}
+
+static void
+printResult(const Result *result,
+            const char *operation,
+            const char *destination,
+            const char *source,
+            uint8_t payload_size)
+{
+  double operations_per_second = result->duration == 0 ? 0 : NUMBER_OF_REPETITIONS * 1e6 / result->duration;
+  printf("%s,%s,%s,%u,%.1f,%.1f,%.1f\n",
+         operation,
+         destination,
+         source,
+         payload_size,
+         operations_per_second,
+         (double) result->spi_bytes / NUMBER_OF_REPETITIONS,
+         (double) result->spi_transactions / NUMBER_OF_REPETITIONS);
+}
+
+static void
+setAddressingMode(bool extended_destination, bool extended_source)
+{
+  if (extended_destination) {
+    Mac802154_setExtendedDestinationAddress(sender.mac, receiver.config.extended_source_address);
+  }
+  else {
+    Mac802154_setShortDestinationAddress(sender.mac, receiver.config.short_source_address);
+  }
+  if (extended_source) {
+    Mac802154_useExtendedSourceAddress(sender.mac);
+  }
+  else {
+    Mac802154_useShortSourceAddress(sender.mac);
+  }
+}
+
+/*
+ * The payload changes between the frames, like
+ * it would for e.g. sensor readings.
+ */
+static void
+benchmarkSendBlocking(bool extended_destination, bool extended_source, uint8_t payload_size)
+{
+  uint8_t payloads[2][100];
+  memset(payloads[0], 0xAA, sizeof(payloads[0]));
+  memset(payloads[1], 0x55, sizeof(payloads[1]));
+  setUpNetwork();
+  setAddressingMode(extended_destination, extended_source);
+  Measurement measurement;
+  Result result = {0};
+  startMeasurement(&measurement, &sender);
+  for (uint16_t i = 0; i < NUMBER_OF_REPETITIONS; i++) {
+    Mac802154_setPayload(sender.mac, payloads[i % 2], payload_size);
+    Mac802154_sendBlocking(sender.mac);
+  }
+  stopMeasurement(&measurement, &sender, &result);
+  printResult(&result, "sendBlocking",
+              extended_destination ? "extended" : "short",
+              extended_source ? "extended" : "short",
+              payload_size);
+  tearDownNetwork();
+}
+
+/*
+ * Like benchmarkSendBlocking(), but the frames are passed
+ * to the tx queue and the interrupts of the sender are
+ * handled whenever the queue is full.
+ */
+static void
+benchmarkEnqueueFrame(bool extended_destination, uint8_t payload_size)
+{
+  uint8_t payloads[2][100];
+  memset(payloads[0], 0xAA, sizeof(payloads[0]));
+  memset(payloads[1], 0x55, sizeof(payloads[1]));
+  setUpNetwork();
+  setAddressingMode(extended_destination, false);
+  Mac802154Frame frame;
+  if (extended_destination) {
+    memcpy(frame.destination_address, receiver.config.extended_source_address, 8);
+    frame.destination_address_size = 8;
+  }
+  else {
+    memcpy(frame.destination_address, receiver.config.short_source_address, 2);
+    frame.destination_address_size = 2;
+  }
+  frame.payload_length = payload_size;
+  Measurement measurement;
+  Result result = {0};
+  startMeasurement(&measurement, &sender);
+  for (uint16_t i = 0; i < NUMBER_OF_REPETITIONS; i++) {
+    frame.payload = payloads[i % 2];
+    while (!Mac802154_enqueueFrame(sender.mac, &frame)) {
+      completeTransfers(&sender);
+      Mac802154MRF_handleInterrupt(sender.mac);
+    }
+  }
+  while (Mac802154_getNumberOfFramesToSend(sender.mac) > 0) {
+    completeTransfers(&sender);
+    Mac802154MRF_handleInterrupt(sender.mac);
+  }
+  stopMeasurement(&measurement, &sender, &result);
+  printResult(&result, "enqueueFrame",
+              extended_destination ? "extended" : "short",
+              "short",
+              payload_size);
+  tearDownNetwork();
+}
+
+/*
+ * Only the receiving side is measured.
+ */
+static void
+benchmarkFetchPacketBlocking(bool extended_destination, bool extended_source, uint8_t payload_size)
+{
+  uint8_t payload[100] = {0};
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  setUpNetwork();
+  setAddressingMode(extended_destination, extended_source);
+  Mac802154_setPayload(sender.mac, payload, payload_size);
+  Measurement measurement;
+  Result result = {0};
+  for (uint16_t i = 0; i < NUMBER_OF_REPETITIONS; i++) {
+    Mac802154_sendBlocking(sender.mac);
+    startMeasurement(&measurement, &receiver);
+    if (Mac802154_newPacketAvailable(receiver.mac)) {
+      uint8_t size = Mac802154_getReceivedPacketSize(receiver.mac);
+      Mac802154_fetchPacketBlocking(receiver.mac, packet, size);
+    }
+    stopMeasurement(&measurement, &receiver, &result);
+  }
+  printResult(&result, "fetchPacketBlocking",
+              extended_destination ? "extended" : "short",
+              extended_source ? "extended" : "short",
+              payload_size);
+  tearDownNetwork();
+}
+
+static void
+benchmarkReconfigure(void)
+{
+  setUpNetwork();
+  Measurement measurement;
+  Result result = {0};
+  startMeasurement(&measurement, &sender);
+  for (uint16_t i = 0; i < NUMBER_OF_REPETITIONS; i++) {
+    Mac802154_configure(sender.mac, &sender.config);
+  }
+  stopMeasurement(&measurement, &sender, &result);
+  printResult(&result, "reconfigure", "-", "-", 0);
+  tearDownNetwork();
+}
+
+int
+main(void)
+{
+  printf("operation,destination,source,payload,operations_per_second,spi_bytes_per_operation,"
+         "spi_transactions_per_operation\n");
+  for (uint8_t addressing_mode = 0; addressing_mode < 4; addressing_mode++) {
+    bool extended_destination = addressing_mode & 1;
+    bool extended_source = addressing_mode & 2;
+    for (uint8_t i = 0; i < sizeof(payload_sizes); i++) {
+      benchmarkSendBlocking(extended_destination, extended_source, payload_sizes[i]);
+    }
+    if (!extended_source) {
+      for (uint8_t i = 0; i < sizeof(payload_sizes); i++) {
+        benchmarkEnqueueFrame(extended_destination, payload_sizes[i]);
+      }
+    }
+    for (uint8_t i = 0; i < sizeof(payload_sizes); i++) {
+      benchmarkFetchPacketBlocking(extended_destination, extended_source, payload_sizes[i]);
+    }
+  }
+  benchmarkReconfigure();
+  return 0;
+}
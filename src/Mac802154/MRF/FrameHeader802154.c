@@ -2,45 +2,30 @@
 #include "CommunicationModule/Mac802154.h"
 #include "CommunicationModule/FrameHeader802154Struct.h"
 #include "src/Mac802154/MRF/FrameHeader802154.h"
+#include "src/Mac802154/MRF/FrameHeader802154Constants.h"
 
 
-/**
- * The memory layout of a mac header control field for 802.15.4 looks like this
- *
- * typedef struct FrameControlField802154 {
- * unsigned frame_type : 3;
- * unsigned security_enabled : 1;
- * unsigned frame_pending : 1;
-  unsigned acknowledgment_request : 1;
-  unsigned information_element_present : 1;
-  unsigned pan_id_compression : 1;
-  unsigned reserved : 1;
-  unsigned sequence_number_suppression : 1;
-  unsigned destination_addressing_mode : 2;
-  unsigned frame_version : 2;
-  unsigned source_addressing_mode : 2;
-} FrameControlField802154;
-
- * Due to different alignment of these fields on different platforms and
- * because this header needs to be transferred bytewise to the network module,
- * we actually use a byte array to store the data.
- * Below the offsets and bitmasks for each field are listed. Note that the control field
- * of the header consists of two bytes.
+/*
+ * Offsets and bitmasks of the frame control field. The ones only
+ * written by the generic setters are left out for the fixed header
+ * profiles (see FrameHeader802154Struct.h), whose setters live in
+ * FrameHeader802154Profile.c. Reading the header is always done by
+ * the functions below, as they are used for received frames too.
  */
-
-
 // first byte
-static const uint8_t frame_type_bitmask = 0b111;
-static const uint8_t acknowledgement_request_offset = 5;
 static const uint8_t pan_id_compression_offset = 6;
 
 // second byte
 static const uint8_t sequence_number_suppression_offset = 8;
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 static const uint8_t information_element_present_offset = 9;
+#endif
 static const uint8_t destination_addressing_mode_bitmask = 0b11;
 static const uint8_t destination_addressing_mode_offset = 10;
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 static const uint8_t frame_version_offset = 12;
 static const uint8_t frame_version_bitmask = 0b11;
+#endif
 static const uint8_t source_addressing_mode_bitmask = 0b11;
 static const uint8_t source_addressing_mode_offset = 14;
 
@@ -52,23 +37,27 @@ static bool sequenceNumberIsPresent(const FrameHeader802154 *self);
 static bool panIdIsPresent(const FrameHeader802154 *self);
 static bool panIdCompressionIsEnabled(const FrameHeader802154 *self);
 
-static void setFrameType(FrameHeader802154 *self, uint8_t frame_type);
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 static void setFrameVersion(FrameHeader802154 *self, uint8_t version);
 static void enablePanIdCompression(FrameHeader802154 *self);
 static void disablePanIdCompression(FrameHeader802154 *self);
 
 static void setSourceAddressingMode(FrameHeader802154 *self, uint8_t mode);
 static void setDestinationAddressingMode(FrameHeader802154 *self, uint8_t mode);
+#endif
 
 static uint8_t getSourceAddressingMode(const FrameHeader802154 *self);
 static uint8_t getDestinationAddressingMode(const FrameHeader802154 *self);
 static uint8_t getAddressSize(uint8_t addressing_mode);
 static uint8_t getPanIdOffset(const FrameHeader802154 *self);
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 static void moveSourceAddress(FrameHeader802154 *self, int8_t distance);
 static void movePanId(FrameHeader802154 *self, int8_t distance);
 static void moveDestinationAddress(FrameHeader802154 *Self, int8_t distance);
+#endif
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void FrameHeader802154_init(FrameHeader802154 *self) {
   for (uint8_t i = 0; i < MAXIMUM_HEADER_SIZE; i++) {
     self->data[i] = 0;
@@ -76,24 +65,33 @@ void FrameHeader802154_init(FrameHeader802154 *self) {
   enablePanIdCompression(self);
   setDestinationAddressingMode(self, ADDRESSING_MODE_SHORT_ADDRESS);
   setSourceAddressingMode(self, ADDRESSING_MODE_SHORT_ADDRESS);
-  setFrameType(self, FRAME_TYPE_DATA);
+  FrameHeader802154_setFrameType(self, FRAME_TYPE_DATA);
   setFrameVersion(self, FRAME_VERSION_2015);
 
 }
+#endif
 
 const uint8_t *FrameHeader802154_getHeaderPtr(const FrameHeader802154 *self) {
   return self->data;
 }
 
+uint8_t FrameHeader802154_getFrameType(const FrameHeader802154 *self) {
+  return self->data[0] & frame_type_bitmask;
+}
+
 const uint8_t *FrameHeader802154_getSequenceNumberPtr(const FrameHeader802154 *self) {
   return self->data + control_field_size;
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void FrameHeader802154_setSequenceNumber(FrameHeader802154 *self, uint8_t number) {
-  movePanId(self, sizeof(number));
-  FrameHeader802154_disableSequenceNumberSuppression(self);
+  if (!sequenceNumberIsPresent(self)) {
+    movePanId(self, sizeof(number));
+    FrameHeader802154_disableSequenceNumberSuppression(self);
+  }
   self->data[2] = number;
 }
+#endif
 
 uint8_t FrameHeader802154_getSequenceNumberSize(const FrameHeader802154 *self) {
   if (sequenceNumberIsPresent(self))
@@ -109,10 +107,12 @@ const uint8_t *FrameHeader802154_getPanIdPtr(const FrameHeader802154 *self) {
   return self->data + getPanIdOffset(self);
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void FrameHeader802154_setPanId(FrameHeader802154 *self, const uint8_t *pan_id) {
   self->data[getPanIdOffset(self)] = pan_id[0];
   self->data[getPanIdOffset(self) + 1] = pan_id[1];
 }
+#endif
 
 uint8_t FrameHeader802154_getHeaderSize(FrameHeader802154 *self) {
   uint8_t base_size = 2;
@@ -125,6 +125,7 @@ uint8_t FrameHeader802154_getHeaderSize(FrameHeader802154 *self) {
   return base_size;
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void FrameHeader802154_setExtendedSourceAddress(FrameHeader802154 *self, const uint8_t *address) {
   uint8_t *source_address = self->data + FrameHeader802154_getSourceAddressOffset(self);
   BitManipulation_copyBytes(address, source_address, 8);
@@ -168,6 +169,7 @@ void FrameHeader802154_setShortDestinationAddress(FrameHeader802154 *self, const
   BitManipulation_copyBytes(address, destination_address_ptr, 2);
   setDestinationAddressingMode(self, ADDRESSING_MODE_SHORT_ADDRESS);
 }
+#endif
 
 uint8_t FrameHeader802154_getSourceAddressSize(const FrameHeader802154 *self){
   return getAddressSize(getSourceAddressingMode(self));
@@ -198,9 +200,19 @@ uint8_t getAddressSize(uint8_t addressing_mode) {
   }
 }
 
+/*
+ * Frames with a source but without destination address,
+ * e.g. beacons, carry the source pan id unless compressed.
+ */
 static bool panIdIsPresent(const FrameHeader802154 *self) {
-  return (getSourceAddressingMode(self) == ADDRESSING_MODE_EXTENDED_ADDRESS
-          && getDestinationAddressingMode(self) == ADDRESSING_MODE_EXTENDED_ADDRESS )
+  uint8_t source_addressing_mode = getSourceAddressingMode(self);
+  uint8_t destination_addressing_mode = getDestinationAddressingMode(self);
+  if (destination_addressing_mode == ADDRESSING_MODE_NEITHER_PAN_NOR_ADDRESS_PRESENT
+      && source_addressing_mode != ADDRESSING_MODE_NEITHER_PAN_NOR_ADDRESS_PRESENT) {
+    return !panIdCompressionIsEnabled(self);
+  }
+  return (source_addressing_mode == ADDRESSING_MODE_EXTENDED_ADDRESS
+          && destination_addressing_mode == ADDRESSING_MODE_EXTENDED_ADDRESS )
           || panIdCompressionIsEnabled(self);
 }
 
@@ -209,6 +221,7 @@ uint8_t getSourceAddressingMode(const FrameHeader802154 *self) {
   return BitManipulation_getByteOnArray(self->data, source_addressing_mode_bitmask, source_addressing_mode_offset);
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void enablePanIdCompression(FrameHeader802154 *self) {
   BitManipulation_setBitOnArray(self->data, pan_id_compression_offset);
 }
@@ -216,11 +229,13 @@ void enablePanIdCompression(FrameHeader802154 *self) {
 void disablePanIdCompression(FrameHeader802154 *self) {
   BitManipulation_clearBitOnArray(self->data, pan_id_compression_offset);
 }
+#endif
 
 bool panIdCompressionIsEnabled(const FrameHeader802154 *self) {
   return BitManipulation_bitIsSetOnArray(self->data, pan_id_compression_offset);
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void FrameHeader802154_enableSequenceNumberSuppression(FrameHeader802154 *self) {
   BitManipulation_setBitOnArray(self->data, sequence_number_suppression_offset);
 }
@@ -228,12 +243,14 @@ void FrameHeader802154_enableSequenceNumberSuppression(FrameHeader802154 *self)
 void FrameHeader802154_disableSequenceNumberSuppression(FrameHeader802154 *self) {
   BitManipulation_clearBitOnArray(self->data, sequence_number_suppression_offset);
 }
+#endif
 
 bool sequenceNumberIsPresent(const FrameHeader802154 *self) {
   return !BitManipulation_bitIsSetOnArray(self->data, sequence_number_suppression_offset);
 }
 
-void setFrameType(FrameHeader802154 *self, uint8_t frame_type) {
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
+void FrameHeader802154_setFrameType(FrameHeader802154 *self, uint8_t frame_type) {
   BitManipulation_setByteOnArray(self->data, frame_type_bitmask, 0, frame_type);
 }
 
@@ -241,12 +258,14 @@ void setDestinationAddressingMode(FrameHeader802154 *self, uint8_t mode) {
   BitManipulation_setByteOnArray(self->data, destination_addressing_mode_bitmask, destination_addressing_mode_offset,
                                  mode);
 }
+#endif
 
 uint8_t getDestinationAddressingMode(const FrameHeader802154 *self) {
   return BitManipulation_getByteOnArray(self->data, destination_addressing_mode_bitmask,
                                         destination_addressing_mode_offset);
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void setFrameVersion(FrameHeader802154 *self, uint8_t version) {
   BitManipulation_setByteOnArray(self->data, frame_version_bitmask, frame_version_offset, version);
 }
@@ -260,9 +279,14 @@ void FrameHeader802154_enableAcknowledgementRequest(FrameHeader802154 *self){
   BitManipulation_setBitOnArray(self->data, acknowledgement_request_offset);
 }
 
+void FrameHeader802154_disableAcknowledgementRequest(FrameHeader802154 *self){
+  BitManipulation_clearBitOnArray(self->data, acknowledgement_request_offset);
+}
+
 void enableInformationElementPresent(FrameHeader802154 *self) {
   BitManipulation_setBitOnArray(self->data, information_element_present_offset);
 }
+#endif
 
 uint8_t FrameHeader802154_getDestinationAddressOffset(const FrameHeader802154 *self) {
   uint8_t offset = getPanIdOffset(self);
@@ -282,6 +306,7 @@ uint8_t getPanIdOffset(const FrameHeader802154 *self) {
   return offset;
 }
 
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_GENERIC
 void moveLeft(uint8_t *source, uint8_t number_of_elements, int8_t distance) {
   for (int8_t index = 0; index < number_of_elements; index++)
   {
@@ -322,6 +347,7 @@ void moveDestinationAddress(FrameHeader802154 *self, int8_t distance) {
   moveSourceAddress(self, distance);
   moveRight(address_ptr, 8, distance);
 }
+#endif
 
 const uint8_t *FrameHeader802154_getSourceAddressPtr(const FrameHeader802154 *self) {
     return self->data + FrameHeader802154_getSourceAddressOffset(self);
@@ -26,11 +26,13 @@ void FrameHeader802154_setExtendedSourceAddress(FrameHeader802154 *self, const u
  * */
 void FrameHeader802154_setPanId(FrameHeader802154 *self, const uint8_t *pan_id);
 void FrameHeader802154_setSequenceNumber(FrameHeader802154 *self, uint8_t number);
+void FrameHeader802154_setFrameType(FrameHeader802154 *self, uint8_t frame_type);
 
 
 // calculates the header size based on what address formats are used and if sequence numbers are enabled
 // all sizes measured in bytes
 uint8_t FrameHeader802154_getHeaderSize(FrameHeader802154 *self);
+uint8_t FrameHeader802154_getFrameType(const FrameHeader802154 *self);
 uint8_t FrameHeader802154_getSourceAddressSize(const FrameHeader802154 *self);
 uint8_t FrameHeader802154_getDestinationAddressSize(const FrameHeader802154 *self);
 uint8_t FrameHeader802154_getPanIdSize(const FrameHeader802154 *self);
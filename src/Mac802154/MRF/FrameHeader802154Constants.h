@@ -0,0 +1,35 @@
+#ifndef COMMUNICATIONMODULE_FRAMEHEADER802154CONSTANTS_H
+#define COMMUNICATIONMODULE_FRAMEHEADER802154CONSTANTS_H
+
+#include <stdint.h>
+
+/**
+ * The memory layout of a mac header control field for 802.15.4 looks like this
+ *
+ * typedef struct FrameControlField802154 {
+ * unsigned frame_type : 3;
+ * unsigned security_enabled : 1;
+ * unsigned frame_pending : 1;
+  unsigned acknowledgment_request : 1;
+  unsigned information_element_present : 1;
+  unsigned pan_id_compression : 1;
+  unsigned reserved : 1;
+  unsigned sequence_number_suppression : 1;
+  unsigned destination_addressing_mode : 2;
+  unsigned frame_version : 2;
+  unsigned source_addressing_mode : 2;
+} FrameControlField802154;
+
+ * Due to different alignment of these fields on different platforms and
+ * because this header needs to be transferred bytewise to the network module,
+ * we actually use a byte array to store the data.
+ * Below the offsets and bitmasks of the fields that are used by the generic
+ * functions in FrameHeader802154.c as well as by the fixed header profiles in
+ * FrameHeader802154Profile.c are listed. Note that the control field of the
+ * header consists of two bytes.
+ */
+
+static const uint8_t frame_type_bitmask = 0b111;
+static const uint8_t acknowledgement_request_offset = 5;
+
+#endif //COMMUNICATIONMODULE_FRAMEHEADER802154CONSTANTS_H
@@ -0,0 +1,121 @@
+#include "EmbeddedUtilities/BitManipulation.h"
+#include "CommunicationModule/Mac802154.h"
+#include "CommunicationModule/FrameHeader802154Struct.h"
+#include "src/Mac802154/MRF/FrameHeader802154.h"
+
+/**
+ * Functions changing the FrameHeader802154 for the fixed header
+ * profiles (see FrameHeader802154Struct.h). The layout of the header
+ * is known at compile time
+ *
+ * | Frame Control | Sequence Number | PAN ID | Destination Address | Source Address |
+ * |---------------|-----------------|--------|---------------------|----------------|
+ * | 2             | 1               | 2      | 2/8                 | 2/8            |
+ *
+ * so instead of decoding the frame control field and moving fields,
+ * every setter copies to a constant offset. The frame control field
+ * is written once in FrameHeader802154_init().
+ * Reading the header is still done by the generic functions in
+ * FrameHeader802154.c, as those are used for received frames too.
+ */
+#if FRAME_HEADER802154_PROFILE != FRAME_HEADER802154_PROFILE_GENERIC
+
+#include "src/Mac802154/MRF/FrameHeader802154Constants.h"
+
+#if FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_SHORT_ADDRESSES
+#define DESTINATION_ADDRESSING_MODE ADDRESSING_MODE_SHORT_ADDRESS
+#define SOURCE_ADDRESSING_MODE ADDRESSING_MODE_SHORT_ADDRESS
+#define DESTINATION_ADDRESS_SIZE 2
+#define SOURCE_ADDRESS_SIZE 2
+#define PAN_ID_COMPRESSION 1
+#elif FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_SHORT_DESTINATION_EXTENDED_SOURCE
+#define DESTINATION_ADDRESSING_MODE ADDRESSING_MODE_SHORT_ADDRESS
+#define SOURCE_ADDRESSING_MODE ADDRESSING_MODE_EXTENDED_ADDRESS
+#define DESTINATION_ADDRESS_SIZE 2
+#define SOURCE_ADDRESS_SIZE 8
+#define PAN_ID_COMPRESSION 1
+#elif FRAME_HEADER802154_PROFILE == FRAME_HEADER802154_PROFILE_EXTENDED_ADDRESSES
+/*
+ * With both addresses extended the 2015 standard includes the
+ * destination pan id only if pan id compression is disabled.
+ */
+#define DESTINATION_ADDRESSING_MODE ADDRESSING_MODE_EXTENDED_ADDRESS
+#define SOURCE_ADDRESSING_MODE ADDRESSING_MODE_EXTENDED_ADDRESS
+#define DESTINATION_ADDRESS_SIZE 8
+#define SOURCE_ADDRESS_SIZE 8
+#define PAN_ID_COMPRESSION 0
+#else
+#error "unknown FRAME_HEADER802154_PROFILE"
+#endif
+
+enum {
+  SEQUENCE_NUMBER_OFFSET = 2,
+  SEQUENCE_NUMBER_SIZE = 1,
+  PAN_ID_OFFSET = SEQUENCE_NUMBER_OFFSET + SEQUENCE_NUMBER_SIZE,
+  PAN_ID_SIZE = 2,
+  DESTINATION_ADDRESS_OFFSET = PAN_ID_OFFSET + PAN_ID_SIZE,
+  SOURCE_ADDRESS_OFFSET = DESTINATION_ADDRESS_OFFSET + DESTINATION_ADDRESS_SIZE,
+  FIRST_FRAME_CONTROL_BYTE = FRAME_TYPE_DATA | (PAN_ID_COMPRESSION << 6),
+  SECOND_FRAME_CONTROL_BYTE = (DESTINATION_ADDRESSING_MODE << 2)
+                              | (FRAME_VERSION_2015 << 4)
+                              | (SOURCE_ADDRESSING_MODE << 6),
+};
+
+void FrameHeader802154_init(FrameHeader802154 *self) {
+  for (uint8_t i = 0; i < MAXIMUM_HEADER_SIZE; i++) {
+    self->data[i] = 0;
+  }
+  self->data[0] = FIRST_FRAME_CONTROL_BYTE;
+  self->data[1] = SECOND_FRAME_CONTROL_BYTE;
+}
+
+void FrameHeader802154_setFrameType(FrameHeader802154 *self, uint8_t frame_type) {
+  self->data[0] = (uint8_t) ((self->data[0] & ~frame_type_bitmask) | (frame_type & frame_type_bitmask));
+}
+
+void FrameHeader802154_enableSequenceNumberSuppression(FrameHeader802154 *self) {}
+
+void FrameHeader802154_disableSequenceNumberSuppression(FrameHeader802154 *self) {}
+
+void FrameHeader802154_enableAcknowledgementRequest(FrameHeader802154 *self) {
+  BitManipulation_setBitOnArray(self->data, acknowledgement_request_offset);
+}
+
+void FrameHeader802154_disableAcknowledgementRequest(FrameHeader802154 *self) {
+  BitManipulation_clearBitOnArray(self->data, acknowledgement_request_offset);
+}
+
+void FrameHeader802154_setShortDestinationAddress(FrameHeader802154 *self, const uint8_t *address) {
+#if DESTINATION_ADDRESS_SIZE == 2
+  BitManipulation_copyBytes(address, self->data + DESTINATION_ADDRESS_OFFSET, 2);
+#endif
+}
+
+void FrameHeader802154_setExtendedDestinationAddress(FrameHeader802154 *self, const uint8_t *address) {
+#if DESTINATION_ADDRESS_SIZE == 8
+  BitManipulation_copyBytes(address, self->data + DESTINATION_ADDRESS_OFFSET, 8);
+#endif
+}
+
+void FrameHeader802154_setShortSourceAddress(FrameHeader802154 *self, const uint8_t *address) {
+#if SOURCE_ADDRESS_SIZE == 2
+  BitManipulation_copyBytes(address, self->data + SOURCE_ADDRESS_OFFSET, 2);
+#endif
+}
+
+void FrameHeader802154_setExtendedSourceAddress(FrameHeader802154 *self, const uint8_t *address) {
+#if SOURCE_ADDRESS_SIZE == 8
+  BitManipulation_copyBytes(address, self->data + SOURCE_ADDRESS_OFFSET, 8);
+#endif
+}
+
+void FrameHeader802154_setPanId(FrameHeader802154 *self, const uint8_t *pan_id) {
+  self->data[PAN_ID_OFFSET] = pan_id[0];
+  self->data[PAN_ID_OFFSET + 1] = pan_id[1];
+}
+
+void FrameHeader802154_setSequenceNumber(FrameHeader802154 *self, uint8_t number) {
+  self->data[SEQUENCE_NUMBER_OFFSET] = number;
+}
+
+#endif
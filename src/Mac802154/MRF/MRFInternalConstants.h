@@ -24,6 +24,7 @@ static const uint16_t mrf_register_rf_control5 = 0x205;
 static const uint16_t mrf_register_rf_control6 = 0x206;
 static const uint16_t mrf_register_rf_control7 = 0x207;
 static const uint16_t mrf_register_rf_control8 = 0x208;
+static const uint16_t mrf_register_rssi = 0x210;
 static const uint16_t mrf_register_sleep_clock_control0 = 0x211;
 static const uint16_t mrf_register_sleep_clock_control1 = 0x220;
 
@@ -33,37 +34,85 @@ static const uint8_t mrf_register_short_address_low_byte = 0x03;
 static const uint8_t mrf_register_short_address_high_byte = 0x04;
 static const uint8_t mrf_register_extended_address0 = 0x05;
 static const uint8_t mrf_register_tx_normal_fifo_control = 0x1B;
+static const uint8_t mrf_register_tx_status = 0x24;
 static const uint8_t mrf_register_rx_flush = 0x0D;
+static const uint8_t mrf_register_tx_mac_control = 0x11;
+static const uint8_t mrf_register_wake_control = 0x22;
+static const uint8_t mrf_register_sleep_acknowledgement = 0x35;
+static const uint8_t mrf_register_beacon_and_superframe_order = 0x10;
+static const uint8_t mrf_register_end_slot_of_cap_and_gts1 = 0x13;
+static const uint8_t mrf_register_tx_gts1_fifo_control = 0x1C;
+static const uint8_t mrf_register_end_slot_of_gts2_and_gts3 = 0x1E;
+static const uint8_t mrf_register_end_slot_of_gts4_and_gts5 = 0x1F;
+static const uint8_t mrf_register_end_slot_of_gts6_and_gts7 = 0x20;
 
 static const uint8_t mrf_fifo_enable = 0x08;
 static const uint8_t mrf_tx_normal_fifo_length = 0x80;
 static const uint16_t mrf_tx_fifo_start = 0x0;
+static const uint8_t mrf_tx_fifo_length_fields_size = 2;
+static const uint16_t mrf_beacon_fifo_start = 0x080;
+static const uint8_t mrf_beacon_fifo_length = 0x80;
+static const uint16_t mrf_tx_gts1_fifo_start = 0x100;
 static const uint16_t mrf_rx_fifo_start = 0x300;
 static const uint8_t mrf_rx_fifo_length = 0x90;
 
+static const uint8_t mrf_value_promiscuous_mode = 0x01;
+static const uint8_t mrf_value_accept_error_frames = 0x02;
+static const uint8_t mrf_value_receive_mac_command_frames_only = 0x08;
+static const uint8_t mrf_value_receive_data_frames_only = 0x04;
+static const uint8_t mrf_value_receive_beacon_frames_only = 0x02;
 static const uint8_t mrf_value_full_software_reset = 0x07;
+static const uint8_t mrf_value_power_management_reset = 0x04;
+static const uint8_t mrf_value_immediate_wake_up_enabled = 0x80;
+static const uint8_t mrf_value_register_wake_up = 0x40;
+static const uint8_t mrf_value_sleep = 0x80;
 static const uint8_t mrf_value_recommended_transmitter_on_time_before_beginning_a_packet = 0x18;
 static const uint8_t mrf_value_recommended_interframe_spacing = 0x95;
 static const uint8_t mrf_value_recommended_rf_optimize_control0 = 0x03;
 static const uint8_t mrf_value_recommended_rf_optimize_control1 = 0x01;
 static const uint8_t mrf_value_recommended_rf_control8 = 0x10;
 static const uint8_t mrf_value_phase_locked_loop_enabled = 0x80;
-static const uint8_t mrf_value_transmitter_power_minus30dB = 0x03 << 6;
-static const uint8_t mrf_value_transmitter_power_minus20dB = 0x02 << 6;
-static const uint8_t mrf_value_transmitter_power_minus10dB = 0x01 << 6;
 static const uint8_t mrf_value_transmitter_power_0dB = 0;
+static const uint8_t mrf_value_transmitter_power_offset = 3;
 static const uint8_t mrf_value_enable_tx_filter = 0x01 << 7;
 static const uint8_t mrf_value_20MHz_clock_recovery_less_than_1ms = 0x01 << 4;
 static const uint8_t mrf_value_use_internal_100kHz_oscillator = 0x80;
 static const uint8_t mrf_value_disable_deprecated_clkout_sleep_clock_feature = 1 << 5;
 static const uint8_t mrf_value_minimum_sleep_clock_divisor_for_internal_oscillator = 1;
 static const uint8_t mrf_value_clear_channel_assessment_energy_detection_only = 0x80;
+static const uint8_t mrf_value_clear_channel_assessment_carrier_sense_only = 0x40;
+static const uint8_t mrf_value_clear_channel_assessment_carrier_sense_and_energy_detection = 0xC0;
+static const uint8_t mrf_value_recommended_carrier_sense_threshold = 0x0E << 2;
+static const uint8_t mrf_value_minimum_backoff_exponent_offset = 3;
+static const uint8_t mrf_value_default_minimum_backoff_exponent = 3;
+static const uint8_t mrf_value_largest_minimum_backoff_exponent = 3;
+static const uint8_t mrf_value_default_maximum_csma_backoffs = 4;
+static const uint8_t mrf_value_largest_maximum_csma_backoffs = 5;
 static const uint8_t mrf_value_recommended_energy_detection_threshold = 0x60;
 static const uint8_t mrf_value_append_rssi_value_to_rxfifo = 0x40;
+static const uint8_t mrf_value_initiate_rssi_measurement = 0x80;
+static const uint8_t mrf_value_rssi_ready = 0x01;
 static const uint8_t mrf_value_rf_state_machine_reset_state = 0x04;
 static const uint8_t mrf_value_rf_state_machine_operating_state = 0x00;
 static const uint8_t mrf_value_delay_interval_after_state_machine_reset = 200;
+static const uint16_t mrf_value_delay_interval_for_oscillator_after_wake_up = 2000;
 static const uint8_t mrf_value_rx_interrupt_enabled = (uint8_t) ~(1 << 3);
+static const uint8_t mrf_value_rx_and_tx_normal_interrupt_enabled = (uint8_t) ~((1 << 3) | 1);
+static const uint8_t mrf_value_tx_normal_interrupt = 1;
+static const uint8_t mrf_value_rx_interrupt = 1 << 3;
+static const uint8_t mrf_value_trigger_tx_normal_fifo = 1;
+static const uint8_t mrf_value_tx_normal_acknowledgement_request = 1 << 2;
+static const uint8_t mrf_value_tx_normal_status_failed = 1;
+static const uint8_t mrf_value_tx_status_channel_busy = 1 << 5;
+static const uint8_t mrf_value_tx_normal_retries_offset = 6;
 static const uint8_t mrf_value_rx_decode_inversion = (uint8_t) (1 << 2);
+static const uint8_t mrf_value_pan_coordinator = 0x08;
+static const uint8_t mrf_value_slotted_mode = 0x20;
+static const uint8_t mrf_value_beacon_order_offset = 4;
+static const uint8_t mrf_value_nonbeacon_enabled_order = 0xFF;
+static const uint8_t mrf_value_end_slot_offset = 4;
+static const uint8_t mrf_value_trigger_tx_gts_fifo = 1;
+static const uint8_t mrf_value_tx_gts_acknowledgement_request = 1 << 2;
+static const uint8_t mrf_value_tx_gts_slot_offset = 3;
 
 #endif //COMMUNICATIONMODULE_NETWORKHARDWAREMRFIMPL_H
@@ -2,51 +2,115 @@
 
 extern void debug(uint8_t *string);
 
+enum {
+  MRF_STATE_NO_FIELD,
+  MRF_STATE_HEADER_FIELD,
+  MRF_STATE_FRAME_LENGTH_FIELD,
+  MRF_STATE_SEQUENCE_NUMBER_FIELD,
+  MRF_STATE_PAYLOAD_FIELD,
+};
+
+static void markAsChanged(MrfState *mrf, uint8_t changes) {
+  mrf->state |= changes;
+  mrf->current_field = MRF_STATE_NO_FIELD;
+}
+
+/*
+ * Has to be called after every change to the frame header. In
+ * case the header size changed, the payload moves to a different
+ * address on the mrf and the frame length changes as well.
+ */
+static void updateHeaderLength(MrfState *mrf, uint8_t changes) {
+  uint8_t payload_length = MrfState_getPayloadLength(mrf);
+  uint8_t header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
+  if (header_length != mrf->header.frame_header_length) {
+    mrf->header.frame_header_length = header_length;
+    mrf->header.frame_length = (uint8_t) (header_length + payload_length);
+    changes |= MRF_STATE_HEADER_LENGTH_CHANGED | MRF_STATE_PAYLOAD_CHANGED;
+  }
+  markAsChanged(mrf, changes);
+}
+
 void MrfState_init(MrfState *mrf) {
   FrameHeader802154_init(&mrf->header.frame_header);
   mrf->header.frame_header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
   mrf->header.frame_length = mrf->header.frame_header_length;
-  mrf->state = 0;
+  mrf->payload = NULL;
+  mrf->payload_segments = NULL;
+  mrf->number_of_payload_segments = 0;
+  mrf->state = MRF_STATE_FRAME_HEADER_CHANGED | MRF_STATE_FRAME_LENGTH_CHANGED;
+  mrf->current_field = MRF_STATE_NO_FIELD;
 }
 
 void MrfState_setShortDestinationAddress(MrfState *mrf, const uint8_t *address) {
   FrameHeader802154_setShortDestinationAddress(&mrf->header.frame_header, address);
-  mrf->header.frame_header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
-  mrf->state |= MRF_STATE_DESTINATION_ADDRESS_CHANGED;
+  updateHeaderLength(mrf, MRF_STATE_DESTINATION_ADDRESS_CHANGED);
 }
 
 void MrfState_setExtendedDestinationAddress(MrfState *mrf, const uint8_t *address) {
   FrameHeader802154_setExtendedDestinationAddress(&mrf->header.frame_header, address);
-  mrf->header.frame_header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
+  updateHeaderLength(mrf, MRF_STATE_DESTINATION_ADDRESS_CHANGED);
 }
 
 void MrfState_setShortSourceAddress(MrfState *mrf, const uint8_t *address) {
   FrameHeader802154_setShortSourceAddress(&mrf->header.frame_header, address);
-  mrf->header.frame_header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
+  updateHeaderLength(mrf, MRF_STATE_SOURCE_ADDRESS_CHANGED);
 }
 
 void
 MrfState_setExtendedSourceAddress(MrfState *mrf, const uint8_t *address)
 {
   FrameHeader802154_setExtendedSourceAddress(&mrf->header.frame_header, address);
-  mrf->header.frame_header_length = FrameHeader802154_getHeaderSize(&mrf->header.frame_header);
+  updateHeaderLength(mrf, MRF_STATE_SOURCE_ADDRESS_CHANGED);
+}
 
+static void setPayloadLength(MrfState *mrf, uint8_t payload_length) {
+  uint8_t changes = MRF_STATE_PAYLOAD_CHANGED;
+  if (payload_length != MrfState_getPayloadLength(mrf)) {
+    mrf->header.frame_length = payload_length + mrf->header.frame_header_length;
+    changes |= MRF_STATE_FRAME_LENGTH_CHANGED;
+  }
+  markAsChanged(mrf, changes);
 }
 
 void MrfState_setPayload(MrfState *mrf, const uint8_t *payload, uint8_t payload_length){
-  mrf->header.frame_length = payload_length + mrf->header.frame_header_length;
   mrf->payload = (uint8_t *) payload;
-  mrf->state |= MRF_STATE_FRAME_LENGTH_CHANGED | MRF_STATE_PAYLOAD_CHANGED;
+  mrf->payload_segments = NULL;
+  mrf->number_of_payload_segments = 0;
+  setPayloadLength(mrf, payload_length);
+}
+
+void MrfState_setPayloadVector(MrfState *mrf, const Mac802154PayloadSegment *segments, uint8_t number_of_segments) {
+  uint8_t payload_length = 0;
+  for (uint8_t i = 0; i < number_of_segments; i++) {
+    payload_length += segments[i].length;
+  }
+  mrf->payload = NULL;
+  mrf->payload_segments = segments;
+  mrf->number_of_payload_segments = number_of_segments;
+  setPayloadLength(mrf, payload_length);
 }
 
 uint8_t MrfState_getPayloadLength(MrfState *mrf) {
   return mrf->header.frame_length - mrf->header.frame_header_length;
 }
 
+/*
+ * Setting the sequence number changes the header size
+ * only if it was suppressed before.
+ */
+void
+MrfState_setSequenceNumber(MrfState *mrf, uint8_t sequence_number)
+{
+  FrameHeader802154_setSequenceNumber(&mrf->header.frame_header, sequence_number);
+  updateHeaderLength(mrf, MRF_STATE_SEQUENCE_NUMBER_CHANGED);
+}
+
 void
 MrfState_setPanId(MrfState *mrf, const uint8_t *pan_id)
 {
   FrameHeader802154_setPanId(&mrf->header.frame_header, pan_id);
+  markAsChanged(mrf, MRF_STATE_PAN_ID_CHANGED);
 }
 
 uint8_t
@@ -61,39 +125,127 @@ MrfState_getFullHeaderData(MrfState *mrf)
   return (uint8_t *) &mrf->header;
 }
 
+void
+MrfState_markAllFieldsAsChanged(MrfState *mrf)
+{
+  markAsChanged(mrf, MRF_STATE_FRAME_HEADER_CHANGED
+                     | MRF_STATE_FRAME_LENGTH_CHANGED
+                     | MRF_STATE_SEQUENCE_NUMBER_CHANGED
+                     | MRF_STATE_PAYLOAD_CHANGED);
+}
+
 const uint8_t *
 MrfState_getPayload(MrfState *mrf)
 {
   return mrf->payload;
 }
 
-bool
-MrfState_moveIteratorToNextField(MrfState *mrf)
+static MrfField
+getFrameLengthField(MrfState *mrf)
+{
+  MrfField field = {
+          .address = 1,
+          .data = &mrf->header.frame_length,
+          .length = 1,
+  };
+  return field;
+}
+
+/*
+ * The sequence number follows the two length fields
+ * and the frame control field in the tx normal fifo.
+ */
+static MrfField
+getSequenceNumberField(MrfState *mrf)
+{
+  MrfField field = {
+          .address = 4,
+          .data = FrameHeader802154_getSequenceNumberPtr(&mrf->header.frame_header),
+          .length = 1,
+  };
+  return field;
+}
+
+static uint8_t
+getFirstChangedField(MrfState *mrf)
 {
-  if (mrf->state & MRF_STATE_FRAME_LENGTH_CHANGED)
+  if (mrf->state & MRF_STATE_FRAME_HEADER_CHANGED)
   {
-    mrf->state &= ~(MRF_STATE_FRAME_LENGTH_CHANGED);
-    return true;
+    return MRF_STATE_HEADER_FIELD;
   }
-  else if (mrf->state & MRF_STATE_PAYLOAD_CHANGED)
+  else if (mrf->state & MRF_STATE_FRAME_LENGTH_CHANGED)
   {
-    mrf->state &= ~(MRF_STATE_PAYLOAD_CHANGED);
-    return true;
+    return MRF_STATE_FRAME_LENGTH_FIELD;
+  }
+  else if (mrf->state & MRF_STATE_SEQUENCE_NUMBER_CHANGED)
+  {
+    return MRF_STATE_SEQUENCE_NUMBER_FIELD;
+  }
+  else if ((mrf->state & MRF_STATE_PAYLOAD_CHANGED) && MrfState_getPayloadLength(mrf) > 0)
+  {
+    return MRF_STATE_PAYLOAD_FIELD;
   }
   else
   {
+    return MRF_STATE_NO_FIELD;
+  }
+}
+
+static void
+removeFieldFromChanges(MrfState *mrf, uint8_t field)
+{
+  switch (field)
+  {
+    case MRF_STATE_HEADER_FIELD:
+      /* the full header already includes the frame length and sequence number */
+      mrf->state &= ~(MRF_STATE_FRAME_HEADER_CHANGED
+                      | MRF_STATE_FRAME_LENGTH_CHANGED
+                      | MRF_STATE_SEQUENCE_NUMBER_CHANGED);
+      break;
+    case MRF_STATE_SEQUENCE_NUMBER_FIELD:
+      mrf->state &= ~(MRF_STATE_SEQUENCE_NUMBER_CHANGED);
+      break;
+    case MRF_STATE_FRAME_LENGTH_FIELD:
+      mrf->state &= ~(MRF_STATE_FRAME_LENGTH_CHANGED);
+      break;
+    default:
+      mrf->state &= ~(MRF_STATE_PAYLOAD_CHANGED);
+      break;
+  }
+}
+
+bool
+MrfState_moveIteratorToNextField(MrfState *mrf)
+{
+  mrf->current_field = getFirstChangedField(mrf);
+  if (mrf->current_field == MRF_STATE_NO_FIELD)
+  {
+    mrf->state &= ~(MRF_STATE_PAYLOAD_CHANGED);
     return false;
   }
+  removeFieldFromChanges(mrf, mrf->current_field);
+  return true;
 }
 
 MrfField
 MrfState_getCurrentField(MrfState *mrf)
 {
-  MrfField field;
-  field.length = MrfState_getFullHeaderLength(mrf);
-  field.data = (uint8_t *) &mrf->header;
-  field.address = 0;
-  return field;
+  uint8_t field = mrf->current_field;
+  if (field == MRF_STATE_NO_FIELD)
+  {
+    field = getFirstChangedField(mrf);
+  }
+  switch (field)
+  {
+    case MRF_STATE_FRAME_LENGTH_FIELD:
+      return getFrameLengthField(mrf);
+    case MRF_STATE_SEQUENCE_NUMBER_FIELD:
+      return getSequenceNumberField(mrf);
+    case MRF_STATE_PAYLOAD_FIELD:
+      return MrfState_getPayloadField(mrf);
+    default:
+      return MrfState_getFullHeaderField(mrf);
+  }
 }
 
 MrfField
@@ -114,6 +266,8 @@ MrfState_getPayloadField(MrfState *self)
           .data = MrfState_getPayload(self),
           .length = MrfState_getPayloadLength(self),
           .address = MrfState_getFullHeaderLength(self),
+          .segments = self->payload_segments,
+          .number_of_segments = self->number_of_payload_segments,
   };
   return field;
 }
@@ -122,4 +276,19 @@ void
 MrfState_enableAcknowledgement(MrfState *self)
 {
   FrameHeader802154_enableAcknowledgementRequest(&self->header.frame_header);
+  markAsChanged(self, MRF_STATE_FRAME_CONTROL_FIELD_CHANGED);
+}
+
+void
+MrfState_disableAcknowledgement(MrfState *self)
+{
+  FrameHeader802154_disableAcknowledgementRequest(&self->header.frame_header);
+  markAsChanged(self, MRF_STATE_FRAME_CONTROL_FIELD_CHANGED);
+}
+
+void
+MrfState_setFrameType(MrfState *self, uint8_t frame_type)
+{
+  FrameHeader802154_setFrameType(&self->header.frame_header, frame_type);
+  markAsChanged(self, MRF_STATE_FRAME_CONTROL_FIELD_CHANGED);
 }
\ No newline at end of file
@@ -34,7 +34,14 @@ enum {
   MRF_STATE_FRAME_CONTROL_FIELD_CHANGED = 1 << 2,
   MRF_STATE_PAN_ID_CHANGED              = 1 << 3,
   MRF_STATE_DESTINATION_ADDRESS_CHANGED = 1 << 4,
+  MRF_STATE_SOURCE_ADDRESS_CHANGED      = 1 << 5,
   MRF_STATE_PAYLOAD_CHANGED             = 1 << 6,
+  MRF_STATE_SEQUENCE_NUMBER_CHANGED     = 1 << 7,
+  MRF_STATE_FRAME_HEADER_CHANGED        = MRF_STATE_HEADER_LENGTH_CHANGED
+                                          | MRF_STATE_FRAME_CONTROL_FIELD_CHANGED
+                                          | MRF_STATE_PAN_ID_CHANGED
+                                          | MRF_STATE_DESTINATION_ADDRESS_CHANGED
+                                          | MRF_STATE_SOURCE_ADDRESS_CHANGED,
 };
 
 void MrfState_init(MrfState *mrf_state);
@@ -44,14 +51,48 @@ void MrfState_setShortSourceAddress(MrfState *mrf, const uint8_t *address);
 void MrfState_setExtendedSourceAddress(MrfState *mrf, const uint8_t *address);
 void MrfState_setPanId(MrfState *mrf, const uint8_t *pan_id);
 void MrfState_setPayload(MrfState *mrf, const uint8_t *payload, uint8_t payload_length);
+void MrfState_setPayloadVector(MrfState *mrf, const Mac802154PayloadSegment *segments, uint8_t number_of_segments);
 const uint8_t *MrfState_getPayload(MrfState *mrf);
 uint8_t MrfState_getPayloadLength(MrfState *mrf);
 MrfField MrfState_getPayloadField(MrfState *mrf_state);
-void MrfState_setSequenceNumber(MrfState *mrf);
+/**
+ * Only the sequence number itself is yielded by the iterator
+ * afterwards, unless further fields of the header changed.
+ */
+void MrfState_setSequenceNumber(MrfState *mrf, uint8_t sequence_number);
 void MrfState_disableSequenceNumber(MrfState *mrf);
 void MrfState_enableSequenceNumber(MrfState *mrf);
 void MrfState_enableAcknowledgement(MrfState *mrf);
+void MrfState_disableAcknowledgement(MrfState *mrf);
+void MrfState_setFrameType(MrfState *mrf, uint8_t frame_type);
 const uint8_t *MrfState_getFullHeaderData(MrfState *mrf);
+
+/**
+ * Makes the iterator yield the full header and the payload
+ * again, e.g. after writing the frame to the mrf failed.
+ */
+void MrfState_markAllFieldsAsChanged(MrfState *mrf);
+
+/**
+ * Iterates over the fields that changed since they were
+ * last returned. Use it like this
+ *
+ *     while (MrfState_moveIteratorToNextField(mrf)) {
+ *       MrfField field = MrfState_getCurrentField(mrf);
+ *       // write field to the mrf
+ *     }
+ *
+ * The fields are yielded in the order
+ *  1. the full header (including the frame length), if any header field
+ *     other than the sequence number changed
+ *  2. the frame length, if only the payload length changed
+ *  3. the sequence number, if it is the only header field that changed
+ *  4. the payload, if it was set or moved due to a changed header length
+ *
+ * Calling MrfState_getCurrentField() before moving the
+ * iterator yields the first changed field without removing it.
+ * @return false if there is no further changed field
+ */
 bool MrfState_moveIteratorToNextField(MrfState *mrf);
 
 MrfField MrfState_getCurrentField(MrfState *mrf);
@@ -1,7 +1,9 @@
 #include "src/Mac802154/MRF/Mac802154MRFImplIntern.h"
+#include "src/Mac802154/MRF/MrfAtomic.h"
 #include "EmbeddedUtilities/BitManipulation.h"
 #include "EmbeddedUtilities/Debug.h"
 #include <stdio.h>
+#include <string.h>
 
 size_t
 Mac802154MRF_getADTSize (void)
@@ -29,20 +31,202 @@ Mac802154MRF_create(Mac802154           * memory,
   setUpInterface(&impl->mac);
   impl->io.interface = config->interface;
   impl->io.device    = config->device;
+  impl->io.queue_head = 0;
+  impl->io.queue_tail = 0;
+  impl->io.busy       = false;
+  impl->io.next_on_interface = NULL;
+#if MRF_IO_STATISTICS
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_BUS_OPERATIONS; i++) {
+    Mac802154BusCounters empty = {0, 0, 0, 0};
+    impl->io.statistics.operation[i] = empty;
+  }
+  impl->io.tx_payload_start = mrf_tx_fifo_length_fields_size;
+#endif
+#if MRF_IO_REGISTER_CACHE
+  impl->io.register_cache.valid = 0;
+#endif
+#if MRF_CHANNEL_ACCESS_STATISTICS
+  impl->channel_access_statistics.frames = 0;
+  impl->channel_access_statistics.channel_access_failures = 0;
+  impl->channel_access_statistics.acknowledgement_failures = 0;
+  impl->channel_access_statistics.retransmissions = 0;
+#endif
+  impl->transmission_complete_callback.function = NULL;
+  impl->transmission_complete_callback.argument = NULL;
+  impl->transmission_in_progress = false;
+  impl->tx_normal_fifo_control = mrf_value_trigger_tx_normal_fifo;
+  impl->interrupt_status = 0;
+  impl->sequence_number = 0;
+  impl->beacon_sequence_number = 0;
+  impl->transmitter_power = limitTransmitterPower(config->transmitter_power);
+  impl->highest_transmitter_power = impl->transmitter_power;
+  resetReceiveFilter(impl);
+  resetSuperframe(impl);
+  impl->rx_queue.head = 0;
+  impl->rx_queue.tail = 0;
+  impl->tx_queue.head = 0;
+  impl->tx_queue.tail = 0;
+  impl->tx_queue.sending_head = false;
+#if MRF_DUPLICATE_FILTER_SIZE > 0
+  MrfDuplicateFilter_init(&impl->duplicate_filter);
+#endif
+#if MRF_NEIGHBOR_TABLE_SIZE > 0
+  MrfNeighborTable_init(&impl->neighbor_table);
+#endif
   setResetLineToDefinedState(config);
 }
 
+void
+Mac802154MRF_shareInterface(Mac802154 *self, Mac802154 *other)
+{
+  MrfIo_shareInterface(&((Mrf *) self)->io, &((Mrf *) other)->io);
+}
+
+void
+Mac802154MRF_setTransmitterPower(Mac802154 *self, uint8_t level)
+{
+  Mrf *impl = (Mrf *) self;
+  impl->highest_transmitter_power = limitTransmitterPower(level);
+  changeTransmitterPower(impl, impl->highest_transmitter_power);
+}
+
+uint8_t
+Mac802154MRF_getTransmitterPower(Mac802154 *self)
+{
+  return ((Mrf *) self)->transmitter_power;
+}
+
+/*
+ * A higher level means a lower power.
+ */
+void
+Mac802154MRF_adaptTransmitterPower(Mac802154 *self, uint8_t link_quality)
+{
+  Mrf *impl = (Mrf *) self;
+  uint8_t level = impl->transmitter_power;
+  if (link_quality > MRF_ADAPTIVE_POWER_REDUCE_THRESHOLD)
+  {
+    level = limitTransmitterPower(level + 1);
+  }
+  else if (link_quality < MRF_ADAPTIVE_POWER_RAISE_THRESHOLD)
+  {
+    level = level < impl->highest_transmitter_power + MRF_ADAPTIVE_POWER_RAISE_STEPS
+            ? impl->highest_transmitter_power
+            : level - MRF_ADAPTIVE_POWER_RAISE_STEPS;
+  }
+  changeTransmitterPower(impl, level);
+}
+
+/**
+ * The registers are written in the order given by the datasheet,
+ * writing ORDER starts sending beacons.
+ */
+bool
+Mac802154MRF_startBeaconEnabledPan(Mac802154             *self,
+                                   const Mac802154Beacon *beacon)
+{
+  Mrf *impl = (Mrf *) self;
+  if (beacon->beacon_order >= nonbeacon_enabled_order
+      || beacon->superframe_order > beacon->beacon_order
+      || !beaconFitsIntoFifo(beacon))
+  {
+    return false;
+  }
+  impl->pan_coordinator = true;
+  impl->guaranteed_time_slot = 0;
+  MrfIo_setControlRegister(&impl->io, mrf_register_receive_mac_control,
+                           getReceiveMacControl(impl));
+  writeBeaconToFifo(impl, beacon);
+  setUpSuperframe(impl, beacon);
+  return true;
+}
+
+bool
+Mac802154MRF_joinBeaconEnabledPan(Mac802154             *self,
+                                  const Mac802154Beacon *beacon)
+{
+  Mrf *impl = (Mrf *) self;
+  if (beacon->beacon_order >= nonbeacon_enabled_order)
+  {
+    return false;
+  }
+  setUpSuperframe(impl, beacon);
+  return true;
+}
+
+void
+Mac802154MRF_leaveBeaconEnabledPan(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  resetSuperframe(impl);
+  const MrfIo_RegisterValue nonbeacon_enabled[] = {
+    {
+      .address = mrf_register_beacon_and_superframe_order,
+      .value   = mrf_value_nonbeacon_enabled_order,
+    },
+    {
+      .address = mrf_register_receive_mac_control,
+      .value   = getReceiveMacControl(impl),
+    },
+    {
+      .address = mrf_register_tx_mac_control,
+      .value   = getTransmitterMacControl(impl),
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            nonbeacon_enabled,
+                            sizeof(nonbeacon_enabled) / sizeof(MrfIo_RegisterValue));
+}
+
+/**
+ * The gts fifo is written completely as the
+ * changes tracked by MrfState refer to the tx normal fifo.
+ */
+bool
+Mac802154MRF_sendInGuaranteedTimeSlot(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  if (impl->guaranteed_time_slot == 0)
+  {
+    return false;
+  }
+  setNextSequenceNumber(impl);
+  writeFrameToGuaranteedTimeSlotFifo(impl);
+  uint8_t acknowledgement_request = impl->tx_normal_fifo_control & mrf_value_tx_normal_acknowledgement_request
+                                    ? mrf_value_tx_gts_acknowledgement_request
+                                    : 0;
+  MrfIo_setControlRegister(&impl->io,
+                           mrf_register_tx_gts1_fifo_control,
+                           (uint8_t) (impl->guaranteed_time_slot << mrf_value_tx_gts_slot_offset
+                                      | acknowledgement_request
+                                      | mrf_value_trigger_tx_gts_fifo));
+  return true;
+}
+
 void
 setUpInterface(Mac802154 *interface)
 {
   interface->reconfigure = reconfigure;
   interface->setShortDestinationAddress = setShortDestinationAddress;
   interface->setPayload = setPayload;
+  interface->setPayloadVector = setPayloadVector;
   interface->setExtendedDestinationAddress = setExtendedDestinationAddress;
   interface->sendBlocking                   = sendBlocking;
+  interface->sendNonBlocking                = sendNonBlocking;
+  interface->setTransmissionCompleteCallback = setTransmissionCompleteCallback;
+  interface->enqueueFrame                   = enqueueFrame;
+  interface->getNumberOfFramesToSend        = getNumberOfFramesToSend;
+  interface->enableAcknowledgement          = enableAcknowledgement;
+  interface->disableAcknowledgement         = disableAcknowledgement;
+  interface->getTransmissionStatus          = getTransmissionStatus;
   interface->getReceivedPacketSize          = getReceivedMessageSize;
   interface->newPacketAvailable             = newMessageAvailable;
   interface->fetchPacketBlocking            = fetchMessageBlocking;
+  interface->fetchCompletePacketBlocking    = fetchCompletePacketBlocking;
+  interface->dequeuePacket                  = dequeuePacket;
+  interface->getNumberOfQueuedPackets       = getNumberOfQueuedPackets;
+  interface->getBusStatistics               = getBusStatistics;
+  interface->getChannelAccessStatistics     = getChannelAccessStatistics;
   interface->getPacketPayload               = getPacketPayload;
   interface->getPacketPayloadSize           = getPacketPayloadSize;
   interface->packetAddressIsShort           = packetAddressIsShort;
@@ -50,8 +234,17 @@ setUpInterface(Mac802154 *interface)
   interface->getPacketSourceAddressSize     = getPacketSourceAddressSize;
   interface->getPacketExtendedSourceAddress = getPacketExtendedSourceAddress;
   interface->getPacketShortSourceAddress    = getPacketShortSourceAddress;
+  interface->getPacketLinkQuality           = getPacketLinkQuality;
+  interface->getPacketRssi                  = getPacketRssi;
+  interface->getNeighborLinkQuality         = getNeighborLinkQuality;
+  interface->parsePacket                    = parsePacket;
   interface->enablePromiscuousMode          = enablePromiscuousMode;
   interface->disablePromiscuousMode         = disablePromiscuousMode;
+  interface->setReceiveFilter               = setReceiveFilter;
+  interface->setFrameType                   = setFrameType;
+  interface->scanEnergy                     = scanEnergy;
+  interface->sleep                          = goToSleep;
+  interface->wakeUp                         = wakeUp;
   interface->useExtendedSourceAddress       = useExtendedSourceAddress;
   interface->useShortSourceAddress          = useShortSourceAddress;
 }
@@ -65,10 +258,16 @@ reconfigure(Mac802154 *self,
   debug(String, "resetting mrf...\n");
   reset(impl);
   debug(String, "initializing mrf...\n");
+  impl->interrupt_status = 0;
+  impl->transmission_in_progress = false;
+  impl->tx_normal_fifo_control = mrf_value_trigger_tx_normal_fifo;
+  resetReceiveFilter(impl);
+  resetSuperframe(impl);
   setInitializationValuesFromDatasheet(&impl->io);
-  enableRXInterrupt(impl);
+  enableInterrupts(impl);
   setChannel(impl, config->channel);
   setUpTransmitterPower(impl);
+  setUpChannelAccess(impl);
   setShortSourceAddress(impl, config->short_source_address);
   setExtendedSourceAddress(impl, config->extended_source_address);
   setPanId(impl, config->pan_id);
@@ -113,12 +312,12 @@ setPanId(Mrf           *impl,
 }
 
 void
-enableRXInterrupt(Mrf *impl)
+enableInterrupts(Mrf *impl)
 {
   // clearing a bit in the register enables the corresponding interrupt
   MrfIo_setControlRegister(&impl->io,
                            mrf_register_interrupt_control,
-                           (uint8_t) ~(1 << 3));
+                           mrf_value_rx_and_tx_normal_interrupt_enabled);
 }
 
 void
@@ -132,51 +331,53 @@ reset(Mrf *impl)
 void
 setInitializationValuesFromDatasheet(MrfIo *io)
 {
-  MrfIo_setControlRegister(
-    io,
-    mrf_register_power_amplifier_control2,
-    (uint8_t) ((1 << mrf_fifo_enable) |
-               mrf_value_recommended_transmitter_on_time_before_beginning_a_packet)
-    );
-  MrfIo_setControlRegister(io,
-                           mrf_register_tx_stabilization,
-                           mrf_value_recommended_interframe_spacing);
-  MrfIo_setControlRegister(io,
-                           mrf_register_rf_control0,
-                           mrf_value_recommended_rf_optimize_control0);
-  MrfIo_setControlRegister(io,
-                           mrf_register_rf_control1,
-                           mrf_value_recommended_rf_optimize_control1);
-  MrfIo_setControlRegister(io,
-                           mrf_register_rf_control2,
-                           mrf_value_phase_locked_loop_enabled);
-  MrfIo_setControlRegister(
-    io,
-    mrf_register_rf_control6,
-    mrf_value_enable_tx_filter | mrf_value_20MHz_clock_recovery_less_than_1ms
-    );
-  MrfIo_setControlRegister(io,
-                           mrf_register_rf_control7,
-                           mrf_value_use_internal_100kHz_oscillator);
-  MrfIo_setControlRegister(io,
-                           mrf_register_rf_control8,
-                           mrf_value_recommended_rf_control8);
-  MrfIo_setControlRegister(
-    io,
-    mrf_register_sleep_clock_control1,
-    mrf_value_disable_deprecated_clkout_sleep_clock_feature | mrf_value_minimum_sleep_clock_divisor_for_internal_oscillator
-    );
-  MrfIo_setControlRegister(io,
-                           mrf_register_base_band2,
-                           mrf_value_clear_channel_assessment_energy_detection_only);
-  MrfIo_setControlRegister(io,
-                           mrf_register_energy_detection_threshold_for_clear_channel_assessment,
-                           mrf_value_recommended_energy_detection_threshold);
-  MrfIo_setControlRegister(io,
-                           mrf_register_base_band6,
-                           mrf_value_append_rssi_value_to_rxfifo);
-
-
+  const MrfIo_RegisterValue initialization_values[] = {
+    {
+      .address = mrf_register_power_amplifier_control2,
+      .value   = (uint8_t) ((1 << mrf_fifo_enable) |
+                            mrf_value_recommended_transmitter_on_time_before_beginning_a_packet),
+    },
+    {
+      .address = mrf_register_tx_stabilization,
+      .value   = mrf_value_recommended_interframe_spacing,
+    },
+    {
+      .address = mrf_register_rf_control0,
+      .value   = mrf_value_recommended_rf_optimize_control0,
+    },
+    {
+      .address = mrf_register_rf_control1,
+      .value   = mrf_value_recommended_rf_optimize_control1,
+    },
+    {
+      .address = mrf_register_rf_control2,
+      .value   = mrf_value_phase_locked_loop_enabled,
+    },
+    {
+      .address = mrf_register_rf_control6,
+      .value   = mrf_value_enable_tx_filter | mrf_value_20MHz_clock_recovery_less_than_1ms,
+    },
+    {
+      .address = mrf_register_rf_control7,
+      .value   = mrf_value_use_internal_100kHz_oscillator,
+    },
+    {
+      .address = mrf_register_rf_control8,
+      .value   = mrf_value_recommended_rf_control8,
+    },
+    {
+      .address = mrf_register_sleep_clock_control1,
+      .value   = mrf_value_disable_deprecated_clkout_sleep_clock_feature |
+                 mrf_value_minimum_sleep_clock_divisor_for_internal_oscillator,
+    },
+    {
+      .address = mrf_register_base_band6,
+      .value   = mrf_value_append_rssi_value_to_rxfifo,
+    },
+  };
+  MrfIo_setControlRegisters(io,
+                            initialization_values,
+                            sizeof(initialization_values) / sizeof(MrfIo_RegisterValue));
 }
 
 void
@@ -189,12 +390,214 @@ setChannel(Mrf    *impl,
   resetInternalRFStateMachine(impl);
 }
 
+/**
+ * Disabling reception keeps received frames from
+ * ending up in the rx fifo while we hop between channels.
+ */
+void
+scanEnergy(Mac802154 *self,
+           uint8_t    samples_per_channel,
+           uint8_t   *energy)
+{
+  Mrf *impl = (Mrf *) self;
+  disableReception(impl);
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_CHANNELS; i++)
+  {
+    setChannel(impl, (uint8_t) (MAC802154_FIRST_CHANNEL + i));
+    energy[i] = 0;
+    for (uint8_t sample = 0; sample < samples_per_channel; sample++)
+    {
+      uint8_t current = measureEnergy(impl);
+      if (current > energy[i])
+      {
+        energy[i] = current;
+      }
+    }
+  }
+  setChannel(impl, impl->config.channel);
+  enableReception(impl);
+}
+
+/**
+ * The measurement is started by setting RSSIMODE1,
+ * which is cleared by the mrf once RSSIRDY is set.
+ * RSSIMODE2 is kept, so the rssi is still appended
+ * to received frames.
+ */
+uint8_t
+measureEnergy(Mrf *impl)
+{
+  MrfIo_setControlRegister(&impl->io, mrf_register_base_band6,
+                           mrf_value_initiate_rssi_measurement
+                           | mrf_value_append_rssi_value_to_rxfifo);
+  while (!(MrfIo_readControlRegister(&impl->io, mrf_register_base_band6)
+           & mrf_value_rssi_ready)) {}
+  return MrfIo_readControlRegister(&impl->io, mrf_register_rssi);
+}
+
+/**
+ * The mrf retains its registers and memory while sleeping,
+ * so neither a reset nor the initialization values are
+ * needed on wake up. The header in the tx fifo stays
+ * valid as well, i.e. the MrfState is kept.
+ * Sleep is entered immediately via SLPACK and left by
+ * toggling REGWAKE, which requires IMMWAKE to be set.
+ * After waking up the 20MHz oscillator needs 2ms
+ * to stabilize before frames can be sent or received.
+ */
+void
+goToSleep(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  const MrfIo_RegisterValue sleep_sequence[] = {
+    {
+      .address = mrf_register_wake_control,
+      .value   = mrf_value_immediate_wake_up_enabled,
+    },
+    {
+      .address = mrf_register_software_reset,
+      .value   = mrf_value_power_management_reset,
+    },
+    {
+      .address = mrf_register_sleep_acknowledgement,
+      .value   = mrf_value_sleep,
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            sleep_sequence,
+                            sizeof(sleep_sequence) / sizeof(MrfIo_RegisterValue));
+}
+
+void
+wakeUp(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  const MrfIo_RegisterValue wake_up_sequence[] = {
+    {
+      .address = mrf_register_wake_control,
+      .value   = mrf_value_immediate_wake_up_enabled | mrf_value_register_wake_up,
+    },
+    {
+      .address = mrf_register_wake_control,
+      .value   = mrf_value_immediate_wake_up_enabled,
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            wake_up_sequence,
+                            sizeof(wake_up_sequence) / sizeof(MrfIo_RegisterValue));
+  resetInternalRFStateMachine(impl);
+  impl->delay_microseconds(mrf_value_delay_interval_for_oscillator_after_wake_up);
+}
+
 void
 setUpTransmitterPower(Mrf *impl)
 {
   MrfIo_setControlRegister(&impl->io,
                            mrf_register_rf_control3,
-                           mrf_value_transmitter_power_0dB);
+                           (uint8_t) (impl->transmitter_power << mrf_value_transmitter_power_offset));
+}
+
+uint8_t
+limitTransmitterPower(uint8_t level)
+{
+  return level > MRF_TRANSMITTER_POWER_LOWEST ? MRF_TRANSMITTER_POWER_LOWEST : level;
+}
+
+void
+changeTransmitterPower(Mrf *impl, uint8_t level)
+{
+  if (level != impl->transmitter_power)
+  {
+    impl->transmitter_power = level;
+    setUpTransmitterPower(impl);
+  }
+}
+
+static uint8_t
+limitValue(uint8_t value,
+           uint8_t largest_value)
+{
+  return value > largest_value ? largest_value : value;
+}
+
+static uint8_t
+getValueOrDefault(uint8_t value,
+                  uint8_t default_value,
+                  uint8_t largest_value)
+{
+  if (value == 0)
+  {
+    return default_value;
+  }
+  return limitValue(value, largest_value);
+}
+
+static uint8_t
+getClearChannelAssessmentControl(uint8_t mode)
+{
+  switch (mode)
+  {
+    case MAC802154_CCA_MODE_CARRIER_SENSE:
+      return mrf_value_clear_channel_assessment_carrier_sense_only
+             | mrf_value_recommended_carrier_sense_threshold;
+    case MAC802154_CCA_MODE_CARRIER_SENSE_AND_ENERGY_DETECTION:
+      return mrf_value_clear_channel_assessment_carrier_sense_and_energy_detection
+             | mrf_value_recommended_carrier_sense_threshold;
+    default:
+      return mrf_value_clear_channel_assessment_energy_detection_only;
+  }
+}
+
+/**
+ * The defaults equal the values written by earlier
+ * versions, i.e. the recommendations of the datasheet
+ * and the reset value of TXMCR.
+ */
+void
+setUpChannelAccess(Mrf *impl)
+{
+  const Mac802154Config *config = &impl->config;
+  const MrfIo_RegisterValue channel_access[] = {
+    {
+      .address = mrf_register_base_band2,
+      .value   = getClearChannelAssessmentControl(config->clear_channel_assessment_mode),
+    },
+    {
+      .address = mrf_register_energy_detection_threshold_for_clear_channel_assessment,
+      .value   = getValueOrDefault(config->energy_detection_threshold,
+                                   mrf_value_recommended_energy_detection_threshold,
+                                   0xFF),
+    },
+    {
+      .address = mrf_register_tx_mac_control,
+      .value   = getTransmitterMacControl(impl),
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            channel_access,
+                            sizeof(channel_access) / sizeof(MrfIo_RegisterValue));
+}
+
+uint8_t
+getTransmitterMacControl(const Mrf *impl)
+{
+  const Mac802154Config *config = &impl->config;
+  uint8_t minimum_backoff_exponent = mrf_value_default_minimum_backoff_exponent;
+  uint8_t maximum_csma_backoffs    = mrf_value_default_maximum_csma_backoffs;
+  if (config->custom_backoffs)
+  {
+    minimum_backoff_exponent = limitValue(config->minimum_backoff_exponent,
+                                          mrf_value_largest_minimum_backoff_exponent);
+    maximum_csma_backoffs    = limitValue(config->maximum_csma_backoffs,
+                                          mrf_value_largest_maximum_csma_backoffs);
+  }
+  uint8_t value = (uint8_t) ((minimum_backoff_exponent << mrf_value_minimum_backoff_exponent_offset)
+                             | maximum_csma_backoffs);
+  if (impl->slotted_mode)
+  {
+    value |= mrf_value_slotted_mode;
+  }
+  return value;
 }
 
 void
@@ -226,141 +629,1169 @@ setPayload(Mac802154     *self,
   MrfState_setPayload(&impl->state, payload, (uint8_t) payload_length);
 }
 
+void
+setPayloadVector(Mac802154                     *self,
+                 const Mac802154PayloadSegment *segments,
+                 uint8_t                        number_of_segments)
+{
+  Mrf *impl = (Mrf *) self;
+  MrfState_setPayloadVector(&impl->state, segments, number_of_segments);
+}
+
 void
 sendBlocking(Mac802154 *self)
 {
   Mrf     *impl = (Mrf *) self;
-
-  MrfField current_field = MrfState_getFullHeaderField(&impl->state);
-  MrfIo_writeBlockingToLongAddress(&impl->io,
-                                   current_field.data,
-                                   current_field.length,
-                                   current_field.address);
-  current_field = MrfState_getPayloadField(&impl->state);
-  MrfIo_writeBlockingToLongAddress(&impl->io,
-                                   current_field.data,
-                                   current_field.length,
-                                   current_field.address);
+  setNextSequenceNumber(impl);
+  writeFrameToTxFifo(impl);
   triggerSend(impl);
 }
 
-void
-setExtendedDestinationAddress(Mac802154     *self,
-                              const uint8_t *address)
+/**
+ * The frame is streamed to the mrf by the non blocking
+ * transfers of MrfIo, so we return as soon as all
+ * writes are queued. The last transfer triggers the
+ * transmission.
+ */
+bool
+sendNonBlocking(Mac802154 *self)
 {
   Mrf *impl = (Mrf *) self;
-  MrfState_setExtendedDestinationAddress(&impl->state, address);
+  return transmitNonBlocking(impl);
 }
 
-void
-triggerSend(Mrf *impl)
+/**
+ * A frame whose transfers do not fit into the transfer
+ * queue is rejected before anything is written, so the
+ * sequence number is not used up. Should queueing fail
+ * nevertheless, the fields queued so far are written
+ * without being triggered, so the whole frame is written
+ * again for the next transmission.
+ */
+bool
+transmitNonBlocking(Mrf *impl)
 {
-  MrfIo_setControlRegister(&impl->io, mrf_register_tx_normal_fifo_control, 1);
-  //here we basically assume a transmission success on completion
-  //actually reading the transmission status and throwing an exception
-  //if transmission failed would be better.
-  while (!(MrfIo_readControlRegister(&impl->io,
-                                     mrf_register_interrupt_status) & 1)) {}
+  if (MrfIo_getNumberOfFreeTransfers(&impl->io) < getMaximumNumberOfTransfersForFrame(impl))
+  {
+    return false;
+  }
+  impl->transmission_in_progress = true;
+  clearInterruptStatus(impl, mrf_value_tx_normal_interrupt);
+  setNextSequenceNumber(impl);
+  bool queued = true;
+  while (queued && MrfState_moveIteratorToNextField(&impl->state))
+  {
+    queued = queueField(impl, MrfState_getCurrentField(&impl->state));
+  }
+  MrfIo_NonBlockingWriteContext trigger = {
+    .callback = {
+      .function = NULL,
+      .argument = NULL,
+    },
+    .output_buffer = &impl->tx_normal_fifo_control,
+    .length = 1,
+    .address = mrf_register_tx_normal_fifo_control,
+  };
+  if (!queued || !MrfIo_writeNonBlockingToShortAddress(&impl->io, &trigger))
+  {
+    MrfState_markAllFieldsAsChanged(&impl->state);
+    impl->transmission_in_progress = false;
+    return false;
+  }
+  return true;
 }
 
+/**
+ * The full header, or the frame length and the sequence
+ * number, one transfer per payload segment and the trigger.
+ */
 uint8_t
-getReceivedMessageSize(Mac802154 *self)
+getMaximumNumberOfTransfersForFrame(const Mrf *impl)
 {
-  Mrf    *impl = (Mrf *) self;
-  uint8_t size = 0;
-  MrfIo_readBlockingFromLongAddress(&impl->io, mrf_rx_fifo_start, &size, 1);
-  return size + frame_length_field_size;
+  uint8_t payload_transfers = impl->state.number_of_payload_segments;
+  if (payload_transfers == 0)
+  {
+    payload_transfers = 1;
+  }
+  return (uint8_t) (payload_transfers + 3);
+}
+
+/**
+ * The tx queue is a ring buffer with free running head
+ * and tail indices like the rx queue. The frame at the
+ * head is the one currently transmitted, it is removed
+ * once the transmission completed. As frames sent with
+ * Mac802154_sendNonBlocking() complete the same way,
+ * sending_head tells whether the head was started at all.
+ */
+static uint8_t
+getNumberOfFramesToSendInternal(const MrfTxQueue *queue)
+{
+  return (uint8_t) (queue->tail - queue->head);
+}
+
+/**
+ * Without a queue (MRF_TX_QUEUE_SIZE 0) the queue
+ * always counts as full, so this is never reached.
+ */
+static Mac802154Frame *
+getQueuedFrame(MrfTxQueue *queue,
+               uint8_t     index)
+{
+#if MRF_TX_QUEUE_SIZE > 0
+  return &queue->frames[index & (MRF_TX_QUEUE_SIZE - 1)];
+#else
+  return NULL;
+#endif
 }
 
 bool
-newMessageAvailable(Mac802154 *self)
+enqueueFrame(Mac802154            *self,
+             const Mac802154Frame *frame)
 {
-  Mrf    *impl = (Mrf *) self;
-  uint8_t status_register_value = MrfIo_readControlRegister(&impl->io,
-                                                            mrf_register_interrupt_status);
-  bool    new_message = ((status_register_value >> 3) & 1);
-  return new_message;
+  Mrf        *impl  = (Mrf *) self;
+  MrfTxQueue *queue = &impl->tx_queue;
+  uint8_t     number_of_frames = getNumberOfFramesToSendInternal(queue);
+  if (number_of_frames == MRF_TX_QUEUE_SIZE)
+  {
+    return false;
+  }
+  *getQueuedFrame(queue, queue->tail) = *frame;
+  queue->tail++;
+  if (!impl->transmission_in_progress && !startQueuedFrame(impl) && number_of_frames == 0)
+  {
+    queue->tail--;
+    return false;
+  }
+  return true;
 }
 
-void
-fetchMessageBlocking(Mac802154 *self,
-                     uint8_t  *buffer,
-                     uint8_t   size)
+uint8_t
+getNumberOfFramesToSend(Mac802154 *self)
 {
   Mrf *impl = (Mrf *) self;
-  MrfIo_readBlockingFromLongAddress(&impl->io, mrf_rx_fifo_start, buffer, size);
+  return getNumberOfFramesToSendInternal(&impl->tx_queue);
+}
+
+void
+sendNextQueuedFrame(Mrf *impl)
+{
+  MrfTxQueue *queue = &impl->tx_queue;
+  if (queue->sending_head)
+  {
+    queue->sending_head = false;
+    queue->head++;
+  }
+  if (getNumberOfFramesToSendInternal(queue) > 0)
+  {
+    startQueuedFrame(impl);
+  }
 }
 
 /**
- * accept all packages with correct crc
- *
+ * If the transfers for the frame at the head cannot be
+ * queued, e.g. because the transmission complete callback
+ * started transfers of its own, the frame stays at the
+ * head and is started again by the next enqueueFrame().
  */
-void
-enablePromiscuousMode(Mac802154 *self)
+bool
+startQueuedFrame(Mrf *impl)
 {
-  Mrf *impl = (Mrf *) self;
-  MrfIo_setControlRegister(&impl->io, mrf_register_receive_mac_control, 1);
+  MrfTxQueue *queue = &impl->tx_queue;
+  loadFrame(impl, getQueuedFrame(queue, queue->head));
+  queue->sending_head = transmitNonBlocking(impl);
+  return queue->sending_head;
 }
 
+/**
+ * Setting the destination address marks the whole
+ * header as changed, so we skip it for consecutive
+ * frames to the same destination.
+ */
 void
-disablePromiscuousMode(Mac802154 *self)
+loadFrame(Mrf                  *impl,
+          const Mac802154Frame *frame)
 {
-  Mrf *impl = (Mrf *) self;
-  MrfIo_setControlRegister(&impl->io, mrf_register_receive_mac_control, 0);
+  if (destinationAddressChanged(impl, frame))
+  {
+    if (frame->destination_address_size == 8)
+    {
+      MrfState_setExtendedDestinationAddress(&impl->state, frame->destination_address);
+    }
+    else
+    {
+      MrfState_setShortDestinationAddress(&impl->state, frame->destination_address);
+    }
+  }
+  MrfState_setPayload(&impl->state, frame->payload, frame->payload_length);
 }
 
-const uint8_t *
-getPacketPayload(const uint8_t *packet)
+bool
+destinationAddressChanged(Mrf                  *impl,
+                          const Mac802154Frame *frame)
 {
-  packet += frame_length_field_size;
-  return packet + FrameHeader802154_getHeaderSize((FrameHeader802154 *) packet);
+  const FrameHeader802154 *header = &impl->state.header.frame_header;
+  uint8_t size = frame->destination_address_size;
+  return FrameHeader802154_getDestinationAddressSize(header) != size
+         || memcmp(FrameHeader802154_getDestinationAddressPtr(header),
+                   frame->destination_address, size) != 0;
 }
 
-uint8_t
-getPacketPayloadSize(const uint8_t *packet)
+void
+setNextSequenceNumber(Mrf *impl)
 {
-  uint8_t packet_size = packet[0];
-  uint8_t header_size =
-    FrameHeader802154_getHeaderSize((FrameHeader802154 *) (packet + 1));
-  uint8_t payload_size = packet_size
-                         - header_size
-                         - frame_check_sequence_size;
-  return payload_size;
+  MrfState_setSequenceNumber(&impl->state, impl->sequence_number);
+  impl->sequence_number++;
 }
 
 bool
-packetAddressIsShort(const uint8_t *packet)
+queueField(Mrf      *impl,
+           MrfField  field)
 {
-  return FrameHeader802154_getSourceAddressSize(
-    (FrameHeader802154*) (packet + 1)) == 2;
+  if (field.number_of_segments > 0)
+  {
+    return queueSegments(impl, field);
+  }
+  MrfIo_NonBlockingWriteContext context = {
+    .callback = {
+      .function = NULL,
+      .argument = NULL,
+    },
+    .output_buffer = field.data,
+    .length = field.length,
+    .address = field.address,
+  };
+  return MrfIo_writeNonBlockingToLongAddress(&impl->io, &context);
 }
 
+/**
+ * Non blocking transfers take a single buffer,
+ * so each segment is written by a transfer of its own.
+ */
 bool
-packetAddressIsLong(const uint8_t *packet)
+queueSegments(Mrf      *impl,
+              MrfField  field)
 {
-  return FrameHeader802154_getSourceAddressSize(
-    (FrameHeader802154*) (packet + 1)) == 8;
+  uint16_t address = field.address;
+  for (uint8_t i = 0; i < field.number_of_segments; i++)
+  {
+    const Mac802154PayloadSegment *segment = &field.segments[i];
+    if (segment->length > 0)
+    {
+      MrfField segment_field = {
+        .address = address,
+        .data = segment->data,
+        .length = segment->length,
+      };
+      if (!queueField(impl, segment_field))
+      {
+        return false;
+      }
+      address += segment->length;
+    }
+  }
+  return true;
 }
 
-uint8_t
-getPacketSourceAddressSize(const uint8_t *packet)
+void
+setTransmissionCompleteCallback(Mac802154         *self,
+                                Mac802154Callback  callback)
 {
-  return FrameHeader802154_getSourceAddressSize((FrameHeader802154 *) (packet +
-                                                                       1));
+  Mrf *impl = (Mrf *) self;
+  impl->transmission_complete_callback = callback;
 }
 
-const uint8_t*
-getPacketExtendedSourceAddress(const uint8_t *packet)
+void
+enableAcknowledgement(Mac802154 *self)
 {
-  return FrameHeader802154_getSourceAddressPtr(
-    (FrameHeader802154 *) (packet + 1));
+  Mrf *impl = (Mrf *) self;
+  MrfState_enableAcknowledgement(&impl->state);
+  impl->tx_normal_fifo_control = mrf_value_trigger_tx_normal_fifo
+                                 | mrf_value_tx_normal_acknowledgement_request;
 }
 
-const uint8_t *
-getPacketShortSourceAddress(const uint8_t *packet)
+void
+disableAcknowledgement(Mac802154 *self)
 {
-  return FrameHeader802154_getSourceAddressPtr(
-    (FrameHeader802154 *) (packet + 1));
+  Mrf *impl = (Mrf *) self;
+  MrfState_disableAcknowledgement(&impl->state);
+  impl->tx_normal_fifo_control = mrf_value_trigger_tx_normal_fifo;
+}
+
+/**
+ * The mrf keeps the status of the last transmission
+ * in TXSTAT until the next one finishes, so we read it
+ * on request only instead of after every transmission.
+ */
+void
+getTransmissionStatus(Mac802154                   *self,
+                      Mac802154TransmissionStatus *status)
+{
+  Mrf     *impl      = (Mrf *) self;
+  uint8_t  tx_status = MrfIo_readControlRegister(&impl->io,
+                                                 mrf_register_tx_status);
+  status->success      = !(tx_status & mrf_value_tx_normal_status_failed);
+  status->channel_busy = !status->success
+                         && (tx_status & mrf_value_tx_status_channel_busy);
+  status->retries      = tx_status >> mrf_value_tx_normal_retries_offset;
+}
+
+void
+countTransmission(Mrf *impl)
+{
+#if MRF_CHANNEL_ACCESS_STATISTICS
+  Mac802154TransmissionStatus status;
+  getTransmissionStatus(&impl->mac, &status);
+  Mac802154ChannelAccessStatistics *statistics = &impl->channel_access_statistics;
+  statistics->frames++;
+  statistics->retransmissions += status.retries;
+  if (status.channel_busy)
+  {
+    statistics->channel_access_failures++;
+  }
+  else if (!status.success)
+  {
+    statistics->acknowledgement_failures++;
+  }
+#endif
+}
+
+void
+getChannelAccessStatistics(Mac802154                        *self,
+                           Mac802154ChannelAccessStatistics *statistics)
+{
+#if MRF_CHANNEL_ACCESS_STATISTICS
+  *statistics = ((Mrf *) self)->channel_access_statistics;
+#else
+  statistics->frames = 0;
+  statistics->channel_access_failures = 0;
+  statistics->acknowledgement_failures = 0;
+  statistics->retransmissions = 0;
+#endif
+}
+
+/**
+ * The tx normal fifo keeps its content between transmissions,
+ * so only the fields that changed since the last transmission
+ * are written.
+ */
+void
+writeFrameToTxFifo(Mrf *impl)
+{
+  while (MrfState_moveIteratorToNextField(&impl->state))
+  {
+    MrfField current_field = MrfState_getCurrentField(&impl->state);
+    if (current_field.number_of_segments > 0)
+    {
+      MrfIo_writeSegmentsBlockingToLongAddress(&impl->io,
+                                               current_field.segments,
+                                               current_field.number_of_segments,
+                                               current_field.address);
+    }
+    else
+    {
+      MrfIo_writeBlockingToLongAddress(&impl->io,
+                                       current_field.data,
+                                       current_field.length,
+                                       current_field.address);
+    }
+  }
+}
+
+void
+setExtendedDestinationAddress(Mac802154     *self,
+                              const uint8_t *address)
+{
+  Mrf *impl = (Mrf *) self;
+  MrfState_setExtendedDestinationAddress(&impl->state, address);
+}
+
+void
+triggerSend(Mrf *impl)
+{
+  startTransmission(impl);
+  // the outcome is left in TXSTAT, see getTransmissionStatus()
+  while (!(readInterruptStatus(impl) & mrf_value_tx_normal_interrupt)) {}
+  clearInterruptStatus(impl, mrf_value_tx_normal_interrupt);
+  countTransmission(impl);
+}
+
+void
+startTransmission(Mrf *impl)
+{
+  clearInterruptStatus(impl, mrf_value_tx_normal_interrupt);
+  MrfIo_setControlRegister(&impl->io,
+                           mrf_register_tx_normal_fifo_control,
+                           impl->tx_normal_fifo_control);
+}
+
+/**
+ * Reading the interrupt status register clears all
+ * flags on the mrf. To not lose events that are evaluated
+ * somewhere else (e.g. a frame being received while we wait for a
+ * transmission to finish), we keep every flag until it is
+ * cleared explicitly.
+ * The flags are changed by Mac802154MRF_handleInterrupt() as well,
+ * so outside of it they are only changed with interrupts disabled.
+ */
+uint8_t
+readInterruptStatus(Mrf *impl)
+{
+  uint8_t status = MrfIo_readControlRegister(&impl->io,
+                                             mrf_register_interrupt_status);
+  MRF_ATOMIC_BLOCK
+  {
+    impl->interrupt_status |= status;
+    status = impl->interrupt_status;
+  }
+  return status;
+}
+
+void
+clearInterruptStatus(Mrf     *impl,
+                     uint8_t  flags)
+{
+  MRF_ATOMIC_BLOCK
+  {
+    impl->interrupt_status &= (uint8_t) ~flags;
+  }
+}
+
+/**
+ * Reading the status, TXSTAT and the rx fifo are blocking
+ * transfers, that would wait forever for non blocking transfers
+ * when called from within an interrupt. So we leave the flags
+ * on the mrf while the interface is busy. The next queued frame
+ * is started last, as its non blocking transfers would
+ * otherwise delay reading a packet received at the same time.
+ */
+bool
+Mac802154MRF_handleInterrupt(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  if (MrfIo_interfaceIsBusy(&impl->io))
+  {
+    return false;
+  }
+  uint8_t status                = readInterruptStatus(impl);
+  bool    transmission_finished = impl->transmission_in_progress
+                                  && (status & mrf_value_tx_normal_interrupt);
+  if (transmission_finished)
+  {
+    clearInterruptStatus(impl, mrf_value_tx_normal_interrupt);
+    impl->transmission_in_progress = false;
+    countTransmission(impl);
+  }
+  if (MRF_RX_QUEUE_SIZE > 0 && (status & mrf_value_rx_interrupt))
+  {
+    moveReceivedPacketToQueue(impl);
+  }
+  if (transmission_finished)
+  {
+    if (impl->transmission_complete_callback.function != NULL)
+    {
+      impl->transmission_complete_callback.function(
+        impl->transmission_complete_callback.argument);
+    }
+    sendNextQueuedFrame(impl);
+  }
+  return true;
+}
+
+/**
+ * The rx queue is a ring buffer with free running
+ * head and tail indices. New packets are only added
+ * during interrupt handling (moving the tail), while the
+ * application only removes packets (moving the head).
+ */
+static uint8_t
+getNumberOfQueuedPacketsInternal(const MrfRxQueue *queue)
+{
+  return (uint8_t) (queue->tail - queue->head);
+}
+
+static uint8_t *
+getQueuedPacket(MrfRxQueue *queue,
+                uint8_t     index)
+{
+#if MRF_RX_QUEUE_SIZE > 0
+  return queue->packets[index & (MRF_RX_QUEUE_SIZE - 1)];
+#else
+  return NULL;
+#endif
+}
+
+/**
+ * If the queue is full the rx flag stays set, so the packet
+ * is still reported by newMessageAvailable() and can be
+ * fetched directly or moved by the next interrupt.
+ */
+void
+moveReceivedPacketToQueue(Mrf *impl)
+{
+  MrfRxQueue *queue = &impl->rx_queue;
+  if (getNumberOfQueuedPacketsInternal(queue) == MRF_RX_QUEUE_SIZE)
+  {
+    return;
+  }
+  clearInterruptStatus(impl, mrf_value_rx_interrupt);
+  uint8_t *packet = getQueuedPacket(queue, queue->tail);
+  disableReception(impl);
+  MrfIo_readRxFifoBlocking(&impl->io, packet, MAC802154_MAXIMUM_PACKET_SIZE);
+  enableReception(impl);
+  if (packet[0] <= maximum_frame_size && acceptReceivedPacket(impl, packet))
+  {
+    queue->tail++;
+  }
+}
+
+/**
+ * Frames without source address cannot be assigned to a
+ * neighbor and are always accepted. A retransmission still
+ * tells us about the link, so it is added to the neighbor
+ * table before being dropped.
+ */
+bool
+acceptReceivedPacket(Mrf           *impl,
+                     const uint8_t *packet)
+{
+  const FrameHeader802154 *header =
+    (const FrameHeader802154 *) (packet + frame_length_field_size);
+  if (!passesReceiveFilter(impl, header))
+  {
+    return false;
+  }
+  uint8_t source_address_size = FrameHeader802154_getSourceAddressSize(header);
+  if (source_address_size == 0)
+  {
+    return true;
+  }
+  const uint8_t *source_address = FrameHeader802154_getSourceAddressPtr(header);
+  updateNeighborTable(impl, packet, source_address, source_address_size);
+  return !isDuplicate(impl, header, source_address, source_address_size);
+}
+
+/**
+ * Frames without sequence number cannot be
+ * identified and are never considered duplicates.
+ */
+bool
+isDuplicate(Mrf                     *impl,
+            const FrameHeader802154 *header,
+            const uint8_t           *source_address,
+            uint8_t                  source_address_size)
+{
+#if MRF_DUPLICATE_FILTER_SIZE > 0
+  if (FrameHeader802154_getSequenceNumberSize(header) == 0)
+  {
+    return false;
+  }
+  return MrfDuplicateFilter_isDuplicate(&impl->duplicate_filter,
+                                        source_address,
+                                        source_address_size,
+                                        *FrameHeader802154_getSequenceNumberPtr(header));
+#else
+  return false;
+#endif
+}
+
+void
+updateNeighborTable(Mrf           *impl,
+                    const uint8_t *packet,
+                    const uint8_t *source_address,
+                    uint8_t        source_address_size)
+{
+#if MRF_NEIGHBOR_TABLE_SIZE > 0
+  MrfNeighborTable_update(&impl->neighbor_table,
+                          source_address,
+                          source_address_size,
+                          getPacketLinkQuality(packet),
+                          getPacketRssi(packet));
+#endif
+}
+
+bool
+getNeighborLinkQuality(Mac802154            *self,
+                       const uint8_t        *address,
+                       uint8_t               address_size,
+                       Mac802154LinkQuality *quality)
+{
+#if MRF_NEIGHBOR_TABLE_SIZE > 0
+  Mrf *impl = (Mrf *) self;
+  return MrfNeighborTable_get(&impl->neighbor_table, address, address_size, quality);
+#else
+  return false;
+#endif
+}
+
+/**
+ * As recommended by the datasheet we stop the mrf from receiving
+ * frames while reading the rx fifo. Otherwise an incoming frame
+ * could overwrite the one we are currently reading.
+ */
+void
+disableReception(Mrf *impl)
+{
+  MrfIo_setControlRegister(&impl->io, mrf_register_base_band1, mrf_value_rx_decode_inversion);
+}
+
+void
+enableReception(Mrf *impl)
+{
+  MrfIo_setControlRegister(&impl->io, mrf_register_base_band1, 0);
+}
+
+uint8_t
+dequeuePacket(Mac802154 *self,
+              uint8_t   *buffer,
+              uint8_t    buffer_size)
+{
+  Mrf        *impl  = (Mrf *) self;
+  MrfRxQueue *queue = &impl->rx_queue;
+  if (getNumberOfQueuedPacketsInternal(queue) == 0)
+  {
+    return 0;
+  }
+  const uint8_t *packet = getQueuedPacket(queue, queue->head);
+  uint8_t packet_size = (uint8_t) (packet[0] + frame_length_field_size
+                                   + link_quality_field_size + rssi_field_size);
+  if (packet_size > buffer_size)
+  {
+    packet_size = buffer_size;
+  }
+  BitManipulation_copyBytes(packet, buffer, packet_size);
+  queue->head++;
+  return packet_size;
+}
+
+uint8_t
+getNumberOfQueuedPackets(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  return getNumberOfQueuedPacketsInternal(&impl->rx_queue);
+}
+
+void
+getBusStatistics(Mac802154              *self,
+                 Mac802154BusStatistics *statistics)
+{
+  Mrf *impl = (Mrf *) self;
+  MrfIo_getStatistics(&impl->io, statistics);
+}
+
+uint8_t
+getReceivedMessageSize(Mac802154 *self)
+{
+  Mrf    *impl = (Mrf *) self;
+  uint8_t size = 0;
+  MrfIo_readBlockingFromLongAddress(&impl->io, mrf_rx_fifo_start, &size, 1);
+  return size + frame_length_field_size;
+}
+
+bool
+newMessageAvailable(Mac802154 *self)
+{
+  Mrf    *impl = (Mrf *) self;
+  uint8_t status_register_value = readInterruptStatus(impl);
+  bool    new_message = status_register_value & mrf_value_rx_interrupt;
+  clearInterruptStatus(impl, mrf_value_rx_interrupt);
+  return new_message;
+}
+
+void
+fetchMessageBlocking(Mac802154 *self,
+                     uint8_t  *buffer,
+                     uint8_t   size)
+{
+  Mrf *impl = (Mrf *) self;
+  MrfIo_readBlockingFromLongAddress(&impl->io, mrf_rx_fifo_start, buffer, size);
+}
+
+uint8_t
+fetchCompletePacketBlocking(Mac802154 *self,
+                            uint8_t   *buffer,
+                            uint8_t    buffer_size)
+{
+  Mrf *impl = (Mrf *) self;
+  return MrfIo_readRxFifoBlocking(&impl->io, buffer, buffer_size);
+}
+
+/**
+ * accept all packages with correct crc
+ *
+ */
+void
+enablePromiscuousMode(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  impl->promiscuous_mode = true;
+  MrfIo_setControlRegister(&impl->io, mrf_register_receive_mac_control,
+                           getReceiveMacControl(impl));
+}
+
+void
+disablePromiscuousMode(Mac802154 *self)
+{
+  Mrf *impl = (Mrf *) self;
+  impl->promiscuous_mode = false;
+  MrfIo_setControlRegister(&impl->io, mrf_register_receive_mac_control,
+                           getReceiveMacControl(impl));
+}
+
+uint8_t
+getReceiveMacControl(const Mrf *impl)
+{
+  uint8_t value = 0;
+  if (impl->promiscuous_mode)
+  {
+    value |= mrf_value_promiscuous_mode;
+  }
+  if (impl->receive_filter.accept_corrupted_frames)
+  {
+    value |= mrf_value_accept_error_frames;
+  }
+  if (impl->pan_coordinator)
+  {
+    value |= mrf_value_pan_coordinator;
+  }
+  return value;
+}
+
+/**
+ * The MRF can restrict reception to a single
+ * frame type, except for acknowledgements.
+ */
+uint8_t
+getFrameTypeFilter(uint8_t frame_types)
+{
+  switch (frame_types)
+  {
+    case MAC802154_RECEIVE_BEACON_FRAMES:
+      return mrf_value_receive_beacon_frames_only;
+    case MAC802154_RECEIVE_DATA_FRAMES:
+      return mrf_value_receive_data_frames_only;
+    case MAC802154_RECEIVE_MAC_COMMAND_FRAMES:
+      return mrf_value_receive_mac_command_frames_only;
+    default:
+      return 0;
+  }
+}
+
+void
+setFrameType(Mac802154 *self, uint8_t frame_type)
+{
+  Mrf *impl = (Mrf *) self;
+  MrfState_setFrameType(&impl->state, frame_type);
+}
+
+void
+setReceiveFilter(Mac802154                    *self,
+                 const Mac802154ReceiveFilter *filter)
+{
+  Mrf *impl = (Mrf *) self;
+  impl->receive_filter = *filter;
+  setUpReceiveFilter(impl);
+}
+
+/**
+ * Writing RXFLUSH without the RXFLUSH bit
+ * only changes the frame type filter.
+ */
+void
+setUpReceiveFilter(Mrf *impl)
+{
+  const MrfIo_RegisterValue receive_filter[] = {
+    {
+      .address = mrf_register_receive_mac_control,
+      .value   = getReceiveMacControl(impl),
+    },
+    {
+      .address = mrf_register_rx_flush,
+      .value   = getFrameTypeFilter(impl->receive_filter.frame_types),
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            receive_filter,
+                            sizeof(receive_filter) / sizeof(MrfIo_RegisterValue));
+}
+
+/**
+ * Only updates the state, after a reset the
+ * registers of the MRF accept all frames anyway.
+ */
+void
+resetReceiveFilter(Mrf *impl)
+{
+  impl->promiscuous_mode = false;
+  impl->receive_filter.frame_types = 0;
+  impl->receive_filter.own_pan_id_only = false;
+  impl->receive_filter.accept_corrupted_frames = false;
+}
+
+bool
+passesReceiveFilter(const Mrf               *impl,
+                    const FrameHeader802154 *header)
+{
+  const Mac802154ReceiveFilter *filter = &impl->receive_filter;
+  if (filter->frame_types != 0
+      && !(filter->frame_types & (1 << FrameHeader802154_getFrameType(header))))
+  {
+    return false;
+  }
+  if (filter->own_pan_id_only && FrameHeader802154_getPanIdSize(header) > 0)
+  {
+    const uint8_t *pan_id = FrameHeader802154_getPanIdPtr(header);
+    bool is_broadcast = pan_id[0] == 0xFF && pan_id[1] == 0xFF;
+    bool is_own = pan_id[0] == impl->config.pan_id[0]
+                  && pan_id[1] == impl->config.pan_id[1];
+    return is_broadcast || is_own;
+  }
+  return true;
+}
+
+/**
+ * Like resetReceiveFilter() only the state is reset,
+ * the MRF starts in nonbeacon-enabled mode.
+ */
+void
+resetSuperframe(Mrf *impl)
+{
+  impl->pan_coordinator = false;
+  impl->slotted_mode = false;
+  impl->guaranteed_time_slot = 0;
+}
+
+/*
+ * The length of the beacon frame without the frame check
+ * sequence, i.e. the value of the frame length field of
+ * the beacon fifo.
+ */
+uint16_t
+getBeaconFrameLength(const Mac802154Beacon *beacon)
+{
+  uint8_t buffer[MAC802154_MAXIMUM_BEACON_SIZE_WITHOUT_PAYLOAD];
+  Mac802154Beacon without_payload = *beacon;
+  without_payload.payload_size = 0;
+  return (uint16_t) (beacon_frame_header_size
+                     + Mac802154Beacon_write(buffer, &without_payload)
+                     + beacon->payload_size);
+}
+
+/*
+ * The MRF appends the frame check sequence when sending, so it
+ * only counts for the frame size limit and not for the fifo.
+ */
+bool
+beaconFitsIntoFifo(const Mac802154Beacon *beacon)
+{
+  uint16_t frame_length = getBeaconFrameLength(beacon);
+  return frame_length + frame_check_sequence_size <= maximum_frame_size
+         && beacon_fifo_length_fields_size + frame_length <= mrf_beacon_fifo_length;
+}
+
+/*
+ * The beacon fifo has the layout of the tx normal fifo, the
+ * frame header consists of the frame control field (beacon, short
+ * source address, no destination address), the sequence number, the
+ * pan id and the short source address. The beacon payload is
+ * written from the buffer of the application.
+ * Beacons have their own sequence number, independent of the
+ * one of data and command frames.
+ */
+void
+writeBeaconToFifo(Mrf                   *impl,
+                  const Mac802154Beacon *beacon)
+{
+  uint8_t fifo[beacon_fifo_length_fields_size + beacon_frame_header_size
+               + MAC802154_MAXIMUM_BEACON_SIZE_WITHOUT_PAYLOAD];
+  Mac802154Beacon without_payload = *beacon;
+  without_payload.payload_size = 0;
+  uint8_t size = beacon_fifo_length_fields_size + beacon_frame_header_size;
+  size += Mac802154Beacon_write(fifo + size, &without_payload);
+  fifo[0] = beacon_frame_header_size;
+  fifo[1] = (uint8_t) getBeaconFrameLength(beacon);
+  fifo[2] = beacon_first_frame_control_byte;
+  fifo[3] = beacon_second_frame_control_byte;
+  fifo[4] = impl->beacon_sequence_number;
+  impl->beacon_sequence_number++;
+  fifo[5] = impl->config.pan_id[0];
+  fifo[6] = impl->config.pan_id[1];
+  fifo[7] = impl->config.short_source_address[0];
+  fifo[8] = impl->config.short_source_address[1];
+  MrfIo_writeBlockingToLongAddress(&impl->io, fifo, size, mrf_beacon_fifo_start);
+  if (beacon->payload_size > 0)
+  {
+    MrfIo_writeBlockingToLongAddress(&impl->io, beacon->payload, beacon->payload_size,
+                                     mrf_beacon_fifo_start + size);
+  }
+}
+
+/**
+ * ESLOTG1 holds the last slot of the contention access period and
+ * of the first guaranteed time slot, ESLOTG23 to ESLOTG67 the last
+ * slots of the following ones. Unused guaranteed time slots end
+ * where the previous one ends, i.e. they are empty.
+ */
+void
+setUpSuperframe(Mrf                   *impl,
+                const Mac802154Beacon *beacon)
+{
+  uint8_t ends[MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS + 1];
+  ends[0] = beacon->final_cap_slot;
+  uint8_t number_of_ends = 1 + getGuaranteedTimeSlotEnds(beacon, ends + 1);
+  for (uint8_t i = number_of_ends; i < sizeof(ends); i++)
+  {
+    ends[i] = ends[i - 1];
+  }
+  impl->slotted_mode = true;
+  impl->guaranteed_time_slot = findOwnGuaranteedTimeSlot(impl, beacon, ends + 1, number_of_ends - 1);
+  const MrfIo_RegisterValue superframe[] = {
+    {
+      .address = mrf_register_tx_mac_control,
+      .value   = getTransmitterMacControl(impl),
+    },
+    {
+      .address = mrf_register_end_slot_of_cap_and_gts1,
+      .value   = (uint8_t) (ends[1] << mrf_value_end_slot_offset | ends[0]),
+    },
+    {
+      .address = mrf_register_end_slot_of_gts2_and_gts3,
+      .value   = (uint8_t) (ends[3] << mrf_value_end_slot_offset | ends[2]),
+    },
+    {
+      .address = mrf_register_end_slot_of_gts4_and_gts5,
+      .value   = (uint8_t) (ends[5] << mrf_value_end_slot_offset | ends[4]),
+    },
+    {
+      .address = mrf_register_end_slot_of_gts6_and_gts7,
+      .value   = (uint8_t) (ends[7] << mrf_value_end_slot_offset | ends[6]),
+    },
+    {
+      .address = mrf_register_beacon_and_superframe_order,
+      .value   = (uint8_t) (beacon->beacon_order << mrf_value_beacon_order_offset
+                            | beacon->superframe_order),
+    },
+  };
+  MrfIo_setControlRegisters(&impl->io,
+                            superframe,
+                            sizeof(superframe) / sizeof(MrfIo_RegisterValue));
+}
+
+/**
+ * The beacon may list the guaranteed time slots in any order,
+ * the MRF numbers them by their position in the superframe.
+ * @return the number of guaranteed time slots, their last slots
+ * are stored in ascending order
+ */
+uint8_t
+getGuaranteedTimeSlotEnds(const Mac802154Beacon *beacon,
+                          uint8_t               *ends)
+{
+  uint8_t count = beacon->number_of_guaranteed_time_slots;
+  if (count > MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS)
+  {
+    count = MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS;
+  }
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const Mac802154GuaranteedTimeSlot *slot = &beacon->guaranteed_time_slots[i];
+    uint8_t end = (uint8_t) ((slot->starting_slot + slot->length - 1) & 0x0F);
+    uint8_t position = i;
+    while (position > 0 && ends[position - 1] > end)
+    {
+      ends[position] = ends[position - 1];
+      position--;
+    }
+    ends[position] = end;
+  }
+  return count;
+}
+
+/**
+ * @return the number (1-7) of the guaranteed time slot the
+ * device sends in, 0 if there is none
+ */
+uint8_t
+findOwnGuaranteedTimeSlot(const Mrf             *impl,
+                          const Mac802154Beacon *beacon,
+                          const uint8_t         *ends,
+                          uint8_t                number_of_ends)
+{
+  const uint8_t *own_address = impl->config.short_source_address;
+  for (uint8_t i = 0; i < number_of_ends; i++)
+  {
+    const Mac802154GuaranteedTimeSlot *slot = &beacon->guaranteed_time_slots[i];
+    if (!slot->receive
+        && slot->short_address[0] == own_address[0]
+        && slot->short_address[1] == own_address[1])
+    {
+      uint8_t end = (uint8_t) ((slot->starting_slot + slot->length - 1) & 0x0F);
+      uint8_t number = 1;
+      while (number <= number_of_ends && ends[number - 1] != end)
+      {
+        number++;
+      }
+      return number;
+    }
+  }
+  return 0;
+}
+
+void
+writeFrameToGuaranteedTimeSlotFifo(Mrf *impl)
+{
+  MrfField header = MrfState_getFullHeaderField(&impl->state);
+  MrfIo_writeBlockingToLongAddress(&impl->io,
+                                   header.data,
+                                   header.length,
+                                   mrf_tx_gts1_fifo_start + header.address);
+  MrfField payload = MrfState_getPayloadField(&impl->state);
+  if (payload.number_of_segments > 0)
+  {
+    MrfIo_writeSegmentsBlockingToLongAddress(&impl->io,
+                                             payload.segments,
+                                             payload.number_of_segments,
+                                             mrf_tx_gts1_fifo_start + payload.address);
+  }
+  else if (payload.length > 0)
+  {
+    MrfIo_writeBlockingToLongAddress(&impl->io,
+                                     payload.data,
+                                     payload.length,
+                                     mrf_tx_gts1_fifo_start + payload.address);
+  }
+}
+
+const uint8_t *
+getPacketPayload(const uint8_t *packet)
+{
+  packet += frame_length_field_size;
+  return packet + FrameHeader802154_getHeaderSize((FrameHeader802154 *) packet);
+}
+
+uint8_t
+getPacketPayloadSize(const uint8_t *packet)
+{
+  uint8_t packet_size = packet[0];
+  uint8_t header_size =
+    FrameHeader802154_getHeaderSize((FrameHeader802154 *) (packet + 1));
+  uint8_t payload_size = packet_size
+                         - header_size
+                         - frame_check_sequence_size;
+  return payload_size;
+}
+
+bool
+packetAddressIsShort(const uint8_t *packet)
+{
+  return FrameHeader802154_getSourceAddressSize(
+    (FrameHeader802154*) (packet + 1)) == 2;
+}
+
+bool
+packetAddressIsLong(const uint8_t *packet)
+{
+  return FrameHeader802154_getSourceAddressSize(
+    (FrameHeader802154*) (packet + 1)) == 8;
+}
+
+uint8_t
+getPacketSourceAddressSize(const uint8_t *packet)
+{
+  return FrameHeader802154_getSourceAddressSize((FrameHeader802154 *) (packet +
+                                                                       1));
+}
+
+const uint8_t*
+getPacketExtendedSourceAddress(const uint8_t *packet)
+{
+  return FrameHeader802154_getSourceAddressPtr(
+    (FrameHeader802154 *) (packet + 1));
+}
+
+const uint8_t *
+getPacketShortSourceAddress(const uint8_t *packet)
+{
+  return FrameHeader802154_getSourceAddressPtr(
+    (FrameHeader802154 *) (packet + 1));
+}
+
+/**
+ * The frame length field counts the frame including the fcs,
+ * the link quality and rssi follow directly behind it.
+ */
+uint8_t
+getPacketLinkQuality(const uint8_t *packet)
+{
+  return packet[frame_length_field_size + packet[0]];
+}
+
+uint8_t
+getPacketRssi(const uint8_t *packet)
+{
+  return packet[frame_length_field_size + packet[0] + link_quality_field_size];
+}
+
+/*
+ * The packet layout is
+ * [frame length][header][payload][fcs][link quality][rssi],
+ * where the frame length includes the fcs.
+ */
+bool
+parsePacket(const uint8_t      *packet,
+            uint8_t             packet_size,
+            Mac802154FrameView *view)
+{
+  if (packet_size < frame_length_field_size)
+  {
+    return false;
+  }
+  uint8_t frame_length = packet[0];
+  uint8_t frame_end = frame_length_field_size + frame_length;
+  if (frame_length > maximum_frame_size
+      || frame_length < frame_control_field_size + frame_check_sequence_size
+      || frame_end > packet_size)
+  {
+    return false;
+  }
+  const FrameHeader802154 *header =
+    (const FrameHeader802154 *) (packet + frame_length_field_size);
+  view->packet = packet;
+  view->sequence_number_size = FrameHeader802154_getSequenceNumberSize(header);
+  view->pan_id_size = FrameHeader802154_getPanIdSize(header);
+  view->destination_address_size =
+    FrameHeader802154_getDestinationAddressSize(header);
+  view->source_address_size = FrameHeader802154_getSourceAddressSize(header);
+  view->frame_type = FrameHeader802154_getFrameType(header);
+
+  view->sequence_number_offset =
+    frame_length_field_size + frame_control_field_size;
+  view->pan_id_offset =
+    view->sequence_number_offset + view->sequence_number_size;
+  view->destination_address_offset = view->pan_id_offset + view->pan_id_size;
+  view->source_address_offset =
+    view->destination_address_offset + view->destination_address_size;
+  view->payload_offset =
+    view->source_address_offset + view->source_address_size;
+  view->frame_check_sequence_offset = frame_end - frame_check_sequence_size;
+  if (view->payload_offset > view->frame_check_sequence_offset)
+  {
+    return false;
+  }
+  view->payload_size =
+    view->frame_check_sequence_offset - view->payload_offset;
+
+  view->link_quality_offset = 0;
+  view->rssi_offset = 0;
+  if (frame_end + link_quality_field_size <= packet_size)
+  {
+    view->link_quality_offset = frame_end;
+  }
+  if (frame_end + link_quality_field_size + rssi_field_size <= packet_size)
+  {
+    view->rssi_offset = frame_end + link_quality_field_size;
+  }
+  return true;
 }
 
 void
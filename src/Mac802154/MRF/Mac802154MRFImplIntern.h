@@ -4,10 +4,13 @@
 #include <stdio.h>
 #include "CommunicationModule/Mac802154.h"
 #include "CommunicationModule/Mac802154MRFImpl.h"
+#include "CommunicationModule/Mac802154Command.h"
 #include "src/Mac802154/MRF/MRFInternalConstants.h"
 #include "src/Mac802154/MRF/MRFHelperFunctions.h"
 #include "src/Mac802154/MRF/MRFState.h"
 #include "src/Mac802154/MRF/MrfIo.h"
+#include "src/Mac802154/MRF/MrfDuplicateFilter.h"
+#include "src/Mac802154/MRF/MrfNeighborTable.h"
 
 /**
  * # Data Frame Header structure #
@@ -19,7 +22,7 @@
  *  - only send data frames (this will change in future)
  *  - always use pan id compression
  *  - do not use any security mechanisms
- *  - do not use acknowledgments (this will change soon)
+ *  - acknowledgements are disabled by default (see Mac802154_enableAcknowledgement())
  *
  *  Referring to the 802.15.4 standard this leads to the following header value:
  *
@@ -28,11 +31,12 @@
  * | Frame Type        | 0b001 | Data Frame (other possible values are e.g. Acknowledgment or MAC Command)        |
  * | Security Enabled  | 0b0   | Disabled                                                                         |
  * | Frame Pending     | 0b0   | only relevant for specific modes and frames, we say no frame pending here        |
- * | AR                | 0b0   | tell the recepient we don't want an Acknowledgement                              |
+ * | AR                | 0b0/1 | set if acknowledgements are enabled                                              |
  * | PAN ID Compression| 0b1   | only use one PAN ID field because source and destination PAN ID will be the same |
  * | Reserved field    | 0b0   | -                                                                                |
  * | Sequence Number
- * | suppression       | 0b0   | We have to include a sequence number (not supressing makes changes easier later on)|
+ * | suppression       | 0b0   | the sequence number is incremented for every transmitted frame, receivers use it |
+ * |                   |       | to detect retransmissions after a lost acknowledgement                           |
  * | IE Present        | 0b0   | We don't include an information element
  * | Destination
  * | Addressing mode   | 0b10/0b11 | short destination address / long destination address
@@ -78,6 +82,21 @@ static void reconfigure(Mac802154 *self, const Mac802154Config *config);
 static void setShortDestinationAddress(Mac802154 *self, const uint8_t *address);
 static void setPayload(Mac802154 *self, const uint8_t *payload, size_t payload_length);
 static void sendBlocking(Mac802154 *self);
+static bool sendNonBlocking(Mac802154 *self);
+static bool transmitNonBlocking(Mrf *impl);
+static uint8_t getMaximumNumberOfTransfersForFrame(const Mrf *impl);
+static void setPayloadVector(Mac802154 *self, const Mac802154PayloadSegment *segments, uint8_t number_of_segments);
+static bool queueSegments(Mrf *impl, MrfField field);
+static bool enqueueFrame(Mac802154 *self, const Mac802154Frame *frame);
+static uint8_t getNumberOfFramesToSend(Mac802154 *self);
+static void sendNextQueuedFrame(Mrf *impl);
+static bool startQueuedFrame(Mrf *impl);
+static void loadFrame(Mrf *impl, const Mac802154Frame *frame);
+static bool destinationAddressChanged(Mrf *impl, const Mac802154Frame *frame);
+static void setTransmissionCompleteCallback(Mac802154 *self, Mac802154Callback callback);
+static void enableAcknowledgement(Mac802154 *self);
+static void disableAcknowledgement(Mac802154 *self);
+static void getTransmissionStatus(Mac802154 *self, Mac802154TransmissionStatus *status);
 static void setExtendedDestinationAddress(Mac802154 *self, const uint8_t *address);
 static void setShortSourceAddress(Mrf *impl, const uint8_t* address);
 static void setExtendedSourceAddress(Mrf *impl, const uint8_t *address);
@@ -85,6 +104,12 @@ static void setPanId(Mrf *impl, const uint8_t *pan_id);
 static uint8_t getReceivedMessageSize(Mac802154 *self);
 static bool newMessageAvailable(Mac802154 *self);
 static void fetchMessageBlocking(Mac802154 *self, uint8_t *buffer, uint8_t size);
+static uint8_t fetchCompletePacketBlocking(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+static uint8_t dequeuePacket(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size);
+static uint8_t getNumberOfQueuedPackets(Mac802154 *self);
+static void getBusStatistics(Mac802154 *self, Mac802154BusStatistics *statistics);
+static void getChannelAccessStatistics(Mac802154 *self, Mac802154ChannelAccessStatistics *statistics);
+static void countTransmission(Mrf *impl);
 static const uint8_t * getPacketPayload(const uint8_t *packet);
 static uint8_t getPacketPayloadSize(const uint8_t *packet);
 static bool packetAddressIsShort(const uint8_t *packet);
@@ -92,6 +117,11 @@ static bool packetAddressIsLong(const uint8_t *packet);
 static uint8_t getPacketSourceAddressSize(const uint8_t *packet);
 static const uint8_t * getPacketExtendedSourceAddress(const uint8_t *packet);
 static const uint8_t * getPacketShortSourceAddress(const uint8_t *packet);
+static uint8_t getPacketLinkQuality(const uint8_t *packet);
+static uint8_t getPacketRssi(const uint8_t *packet);
+static bool getNeighborLinkQuality(Mac802154 *self, const uint8_t *address, uint8_t address_size,
+                                   Mac802154LinkQuality *quality);
+static bool parsePacket(const uint8_t *packet, uint8_t packet_size, Mac802154FrameView *view);
 static void useExtendedSourceAddress(Mac802154 *self);
 static void useShortSourceAddress(Mac802154 *self);
 
@@ -99,19 +129,67 @@ static void reset(Mrf *impl);
 static void setInitializationValuesFromDatasheet(MrfIo *impl);
 
 static void setUpInterface(Mac802154 *interface);
-static void enableRXInterrupt(Mrf *impl);
+static void enableInterrupts(Mrf *impl);
 static void setChannel(Mrf *impl, uint8_t channel);
 static void setUpTransmitterPower(Mrf *impl);
+static uint8_t limitTransmitterPower(uint8_t level);
+static void changeTransmitterPower(Mrf *impl, uint8_t level);
+static void setUpChannelAccess(Mrf *impl);
+static uint8_t getTransmitterMacControl(const Mrf *impl);
 static void resetInternalRFStateMachine(Mrf *impl);
 static void triggerSend(Mrf *impl);
+static void startTransmission(Mrf *impl);
+static void writeFrameToTxFifo(Mrf *impl);
+static bool queueField(Mrf *impl, MrfField field);
+static uint8_t readInterruptStatus(Mrf *impl);
+static void clearInterruptStatus(Mrf *impl, uint8_t flags);
+static void moveReceivedPacketToQueue(Mrf *impl);
+static bool acceptReceivedPacket(Mrf *impl, const uint8_t *packet);
+static bool isDuplicate(Mrf *impl, const FrameHeader802154 *header,
+                        const uint8_t *source_address, uint8_t source_address_size);
+static void updateNeighborTable(Mrf *impl, const uint8_t *packet,
+                                const uint8_t *source_address, uint8_t source_address_size);
+static void setNextSequenceNumber(Mrf *impl);
+static void disableReception(Mrf *impl);
+static void enableReception(Mrf *impl);
 extern void debug(const uint8_t *string);
 static void enablePromiscuousMode(Mac802154 *impl);
 static void disablePromiscuousMode(Mac802154 *impl);
+static void setReceiveFilter(Mac802154 *self, const Mac802154ReceiveFilter *filter);
+static void setUpReceiveFilter(Mrf *impl);
+static void setFrameType(Mac802154 *self, uint8_t frame_type);
+static uint8_t getReceiveMacControl(const Mrf *impl);
+static uint8_t getFrameTypeFilter(uint8_t frame_types);
+static void resetReceiveFilter(Mrf *impl);
+static bool passesReceiveFilter(const Mrf *impl, const FrameHeader802154 *header);
+static void scanEnergy(Mac802154 *self, uint8_t samples_per_channel, uint8_t *energy);
+static uint8_t measureEnergy(Mrf *impl);
+static void goToSleep(Mac802154 *self);
+static void wakeUp(Mac802154 *self);
+static void resetSuperframe(Mrf *impl);
+static uint16_t getBeaconFrameLength(const Mac802154Beacon *beacon);
+static bool beaconFitsIntoFifo(const Mac802154Beacon *beacon);
+static void writeBeaconToFifo(Mrf *impl, const Mac802154Beacon *beacon);
+static void setUpSuperframe(Mrf *impl, const Mac802154Beacon *beacon);
+static uint8_t getGuaranteedTimeSlotEnds(const Mac802154Beacon *beacon, uint8_t *ends);
+static uint8_t findOwnGuaranteedTimeSlot(const Mrf *impl, const Mac802154Beacon *beacon,
+                                         const uint8_t *ends, uint8_t number_of_ends);
+static void writeFrameToGuaranteedTimeSlotFifo(Mrf *impl);
 
 static const uint8_t frame_length_field_size = 1;
+static const uint8_t frame_control_field_size = 2;
 static const uint8_t rssi_field_size = 1;
 static const uint8_t frame_check_sequence_size = 2;
 static const uint8_t link_quality_field_size = 1;
+static const uint8_t maximum_frame_size = 127;
+static const uint8_t beacon_frame_header_size = 7;
+static const uint8_t beacon_fifo_length_fields_size = 2;
+static const uint8_t beacon_first_frame_control_byte = FRAME_TYPE_BEACON;
+static const uint8_t beacon_second_frame_control_byte =
+    ADDRESSING_MODE_NEITHER_PAN_NOR_ADDRESS_PRESENT << 2
+    | FRAME_VERSION_2003 << 4
+    | ADDRESSING_MODE_SHORT_ADDRESS << 6;
+static const uint8_t nonbeacon_enabled_order = 15;
 
 
 
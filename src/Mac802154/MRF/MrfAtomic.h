@@ -0,0 +1,21 @@
+#ifndef COMMUNICATIONMODULE_MRFATOMIC_H
+#define COMMUNICATIONMODULE_MRFATOMIC_H
+
+/**
+ * Executes the following block with interrupts disabled, for
+ * state shared with Mac802154MRF_handleInterrupt(). On the host
+ * (tests and simulation) there are no interrupts to disable.
+ *
+ *     MRF_ATOMIC_BLOCK
+ *     {
+ *       impl->interrupt_status |= status;
+ *     }
+ */
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define MRF_ATOMIC_BLOCK ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define MRF_ATOMIC_BLOCK
+#endif
+
+#endif //COMMUNICATIONMODULE_MRFATOMIC_H
@@ -0,0 +1,61 @@
+#include <string.h>
+#include "src/Mac802154/MRF/MrfDuplicateFilter.h"
+
+#if MRF_DUPLICATE_FILTER_SIZE > 0
+
+static MrfDuplicateFilterEntry *findEntry(MrfDuplicateFilter *self,
+                                          const uint8_t *source_address,
+                                          uint8_t source_address_size);
+static void addEntry(MrfDuplicateFilter *self,
+                     const uint8_t *source_address,
+                     uint8_t source_address_size,
+                     uint8_t sequence_number);
+
+void MrfDuplicateFilter_init(MrfDuplicateFilter *self) {
+  for (uint8_t i = 0; i < MRF_DUPLICATE_FILTER_SIZE; i++) {
+    self->entries[i].source_address_size = 0;
+  }
+  self->next_entry = 0;
+}
+
+bool MrfDuplicateFilter_isDuplicate(MrfDuplicateFilter *self,
+                                    const uint8_t *source_address,
+                                    uint8_t source_address_size,
+                                    uint8_t sequence_number) {
+  MrfDuplicateFilterEntry *entry = findEntry(self, source_address, source_address_size);
+  if (entry == NULL) {
+    addEntry(self, source_address, source_address_size, sequence_number);
+    return false;
+  }
+  if (entry->sequence_number == sequence_number) {
+    return true;
+  }
+  entry->sequence_number = sequence_number;
+  return false;
+}
+
+MrfDuplicateFilterEntry *findEntry(MrfDuplicateFilter *self,
+                                   const uint8_t *source_address,
+                                   uint8_t source_address_size) {
+  for (uint8_t i = 0; i < MRF_DUPLICATE_FILTER_SIZE; i++) {
+    MrfDuplicateFilterEntry *entry = &self->entries[i];
+    if (entry->source_address_size == source_address_size
+        && memcmp(entry->source_address, source_address, source_address_size) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void addEntry(MrfDuplicateFilter *self,
+              const uint8_t *source_address,
+              uint8_t source_address_size,
+              uint8_t sequence_number) {
+  MrfDuplicateFilterEntry *entry = &self->entries[self->next_entry];
+  memcpy(entry->source_address, source_address, source_address_size);
+  entry->source_address_size = source_address_size;
+  entry->sequence_number = sequence_number;
+  self->next_entry = (uint8_t) ((self->next_entry + 1) % MRF_DUPLICATE_FILTER_SIZE);
+}
+
+#endif
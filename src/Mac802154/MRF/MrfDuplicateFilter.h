@@ -0,0 +1,32 @@
+#ifndef COMMUNICATIONMODULE_MRFDUPLICATEFILTER_H
+#define COMMUNICATIONMODULE_MRFDUPLICATEFILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CommunicationModule/Mac802154MRFImpl.h"
+
+/**
+ * Remembers the sequence number of the last frame received
+ * from each of the last MRF_DUPLICATE_FILTER_SIZE senders.
+ * A frame carrying the same sequence number as the previous
+ * frame of the same sender is a retransmission, that was sent
+ * because our acknowledgement got lost.
+ */
+
+typedef struct MrfDuplicateFilter MrfDuplicateFilter;
+
+void MrfDuplicateFilter_init(MrfDuplicateFilter *self);
+
+/**
+ * Records the frame and checks whether it was seen before.
+ * Once the table is full, the sender recorded first is forgotten.
+ * @param source_address_size 2 or 8, extended and short addresses
+ *        are never considered equal
+ * @return true if the last frame of this sender had the same sequence number
+ */
+bool MrfDuplicateFilter_isDuplicate(MrfDuplicateFilter *self,
+                                    const uint8_t *source_address,
+                                    uint8_t source_address_size,
+                                    uint8_t sequence_number);
+
+#endif //COMMUNICATIONMODULE_MRFDUPLICATEFILTER_H
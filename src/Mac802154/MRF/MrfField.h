@@ -3,14 +3,22 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "CommunicationModule/Mac802154.h"
 
 typedef struct MrfField MrfField;
 
+/**
+ * If number_of_segments is not zero, the data of the field
+ * is scattered over the segments, data is NULL in that case
+ * and length is the sum of the segment lengths.
+ */
 struct MrfField
 {
   uint16_t address;
   const uint8_t *data;
   uint8_t length;
+  const Mac802154PayloadSegment *segments;
+  uint8_t number_of_segments;
 };
 
 #endif //COMMUNICATIONMODULE_MRFFIELD_H
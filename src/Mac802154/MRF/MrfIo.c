@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include "src/Mac802154/MRF/MrfIo.h"
 #include "src/Mac802154/MRF/MRFHelperFunctions.h"
+#include "src/Mac802154/MRF/MRFInternalConstants.h"
 #include "EmbeddedUtilities/Debug.h"
 
 static void setWriteLongCommand(MrfIo *mrf, uint16_t address);
@@ -10,14 +11,73 @@ static void setWriteShortCommand(MrfIo *mrf, uint8_t address);
 static void setWriteLongCommand(MrfIo *mrf, uint16_t address);
 static void setReadShortCommand(MrfIo *mrf, uint8_t address);
 static void setReadLongCommand(MrfIo *mrf, uint16_t address);
+static void writeTransaction(MrfIo *mrf, const uint8_t *transaction, uint8_t command_size, uint8_t data_size);
+static void countTransaction(MrfIo *mrf, const uint8_t *command, uint8_t command_size, uint8_t data_size);
+static void rememberTxHeaderLength(MrfIo *mrf, uint16_t address, const uint8_t *data, uint8_t size);
+#if MRF_IO_REGISTER_CACHE
+static uint8_t getCacheIndex(uint16_t address);
+#endif
+static bool registerHoldsValue(MrfIo *mrf, uint16_t address, uint8_t value);
+static void updateRegisterCache(MrfIo *mrf, uint16_t address, uint8_t value);
+static uint8_t writeRegisterSequence(MrfIo *mrf, const MrfIo_RegisterValue *registers, uint8_t count);
+static uint8_t getLengthOfLongAddressSequence(const MrfIo_RegisterValue *registers, uint8_t count);
 
 static bool isLongAddress(uint16_t address);
+static void waitForNonBlockingTransfers(MrfIo *mrf);
+static bool enqueueTransfer(MrfIo *mrf, const MrfIoCallback *callback, uint8_t *buffer, uint8_t length,
+                            uint16_t address, uint8_t type);
+static void startNextTransfer(MrfIo *mrf);
+static void startNextTransferOnInterface(MrfIo *mrf);
+static MrfIo *getNextOnInterface(MrfIo *mrf);
+static void finishCurrentTransfer(MrfIo *mrf);
+static void setCommandForTransfer(MrfIo *mrf, const MrfIoTransfer *transfer);
+static void onWriteComplete(void *mrf);
+static void onReadComplete(void *mrf);
+
+enum {
+  MRF_IO_TRANSFER_WRITE_LONG,
+  MRF_IO_TRANSFER_WRITE_SHORT,
+  MRF_IO_TRANSFER_READ_LONG,
+  MRF_IO_TRANSFER_READ_SHORT,
+};
+
+enum {
+  MRF_IO_STEP_COMMAND,
+  MRF_IO_STEP_DATA,
+};
+
+enum {
+  MRF_IO_NOT_CACHED = 0xFF,
+  MRF_IO_MAXIMUM_COMMAND_SIZE = 2,
+  MRF_IO_MAXIMUM_REGISTER_SEQUENCE_LENGTH = 8,
+};
 
 void MrfIo_writeBlockingToLongAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size, uint16_t address) {
+  waitForNonBlockingTransfers(mrf);
+  rememberTxHeaderLength(mrf, address, payload, size);
   setWriteLongCommand(mrf, address);
   writeBlockingWithCommand(mrf, payload, size);
 }
 
+void MrfIo_writeSegmentsBlockingToLongAddress(MrfIo *mrf, const Mac802154PayloadSegment *segments,
+                                              uint8_t number_of_segments, uint16_t address) {
+  waitForNonBlockingTransfers(mrf);
+  setWriteLongCommand(mrf, address);
+  uint8_t size = 0;
+  for (uint8_t i = 0; i < number_of_segments; i++) {
+    size += segments[i].length;
+  }
+  countTransaction(mrf, mrf->command, mrf->command_size, size);
+  PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
+  PeripheralInterface_writeBlocking(mrf->interface, mrf->command, mrf->command_size);
+  for (uint8_t i = 0; i < number_of_segments; i++) {
+    if (segments[i].length > 0) {
+      PeripheralInterface_writeBlocking(mrf->interface, segments[i].data, segments[i].length);
+    }
+  }
+  PeripheralInterface_deselectPeripheral(mrf->interface, mrf->device);
+}
+
 void setWriteLongCommand(MrfIo *mrf, uint16_t address) {
   mrf->command[0] = MRF_writeLongCommandFirstByte(address);
   mrf->command[1] = MRF_writeLongCommandSecondByte(address);
@@ -39,12 +99,23 @@ void setWriteLongCommand(MrfIo *mrf, uint16_t address) {
 *
 */
 void MrfIo_writeBlockingToShortAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size, uint8_t address) {
+  waitForNonBlockingTransfers(mrf);
   for (uint8_t i=0; i<size; i++) {
-    setWriteShortCommand(mrf, address+i);
-    writeBlockingWithCommand(mrf, payload+i, 1);
+    uint8_t transaction[2] = {
+            MRF_writeShortCommand(address+i),
+            payload[i],
+    };
+    writeTransaction(mrf, transaction, 1, 1);
   }
 }
 
+void writeTransaction(MrfIo *mrf, const uint8_t *transaction, uint8_t command_size, uint8_t data_size) {
+  countTransaction(mrf, transaction, command_size, data_size);
+  PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
+  PeripheralInterface_writeBlocking(mrf->interface, transaction, (uint8_t) (command_size + data_size));
+  PeripheralInterface_deselectPeripheral(mrf->interface, mrf->device);
+}
+
 void setWriteShortCommand(MrfIo *mrf, uint8_t address) {
   mrf->command_size = 1;
   mrf->command[0] = MRF_writeShortCommand(address);
@@ -63,6 +134,8 @@ void setReadShortCommand(MrfIo *mrf, uint8_t address) {
 
 
 void writeBlockingWithCommand(MrfIo *mrf, const uint8_t *payload, uint8_t size){
+  waitForNonBlockingTransfers(mrf);
+  countTransaction(mrf, mrf->command, mrf->command_size, size);
   debug(String, "selecting peripheral...\n");
   PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
   debug(String, "done.\n writeBlocking...\n");
@@ -75,13 +148,40 @@ void writeBlockingWithCommand(MrfIo *mrf, const uint8_t *payload, uint8_t size){
 }
 
 void readBlockingWithCommand(MrfIo *mrf, uint8_t *payload, uint8_t size) {
+  waitForNonBlockingTransfers(mrf);
+  countTransaction(mrf, mrf->command, mrf->command_size, size);
   PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
   PeripheralInterface_writeBlocking(mrf->interface, mrf->command, mrf->command_size);
   PeripheralInterface_readBlocking(mrf->interface, payload, size);
   PeripheralInterface_deselectPeripheral(mrf->interface, mrf->device);
 }
 
+uint8_t MrfIo_readRxFifoBlocking(MrfIo *mrf, uint8_t *buffer, uint8_t buffer_size) {
+  // frame length field, link quality and rssi
+  const uint8_t additional_bytes = 3;
+  if (buffer_size == 0) {
+    return 0;
+  }
+  waitForNonBlockingTransfers(mrf);
+  setReadLongCommand(mrf, mrf_rx_fifo_start);
+  PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
+  PeripheralInterface_writeBlocking(mrf->interface, mrf->command, mrf->command_size);
+  PeripheralInterface_readBlocking(mrf->interface, buffer, 1);
+  uint8_t packet_size = (uint8_t) (buffer[0] + additional_bytes);
+  if (packet_size > buffer_size || packet_size < additional_bytes) {
+    packet_size = buffer_size;
+  }
+  PeripheralInterface_readBlocking(mrf->interface, buffer + 1, (uint8_t) (packet_size - 1));
+  PeripheralInterface_deselectPeripheral(mrf->interface, mrf->device);
+  countTransaction(mrf, mrf->command, mrf->command_size, packet_size);
+  return packet_size;
+}
+
 void MrfIo_setControlRegister(MrfIo *mrf, uint16_t address, uint8_t value) {
+  if (registerHoldsValue(mrf, address, value)) {
+    return;
+  }
+  waitForNonBlockingTransfers(mrf);
   if (isLongAddress(address)) {
     debug(String, "write command long address...");
     setWriteLongCommand(mrf, address);
@@ -92,9 +192,70 @@ void MrfIo_setControlRegister(MrfIo *mrf, uint16_t address, uint8_t value) {
   }
   debug(String, "start writing...\n");
   writeBlockingWithCommand(mrf, &value, 1);
+  updateRegisterCache(mrf, address, value);
+}
+
+void MrfIo_setControlRegisters(MrfIo *mrf, const MrfIo_RegisterValue *registers, uint8_t count) {
+  waitForNonBlockingTransfers(mrf);
+  uint8_t written = 0;
+  while (written < count) {
+    if (registerHoldsValue(mrf, registers[written].address, registers[written].value)) {
+      written++;
+    }
+    else {
+      written += writeRegisterSequence(mrf, registers + written, (uint8_t) (count - written));
+    }
+  }
+}
+
+/**
+ * Writes the first register and all directly following ones
+ * that can be written within the same transaction.
+ * @return the number of registers written
+ */
+uint8_t writeRegisterSequence(MrfIo *mrf, const MrfIo_RegisterValue *registers, uint8_t count) {
+  uint8_t transaction[MRF_IO_MAXIMUM_COMMAND_SIZE + MRF_IO_MAXIMUM_REGISTER_SEQUENCE_LENGTH];
+  uint8_t command_size;
+  uint8_t sequence_length;
+  if (isLongAddress(registers->address)) {
+    transaction[0] = MRF_writeLongCommandFirstByte(registers->address);
+    transaction[1] = MRF_writeLongCommandSecondByte(registers->address);
+    command_size = 2;
+    sequence_length = getLengthOfLongAddressSequence(registers, count);
+  }
+  else {
+    transaction[0] = MRF_writeShortCommand((uint8_t) registers->address);
+    command_size = 1;
+    sequence_length = 1;
+  }
+  for (uint8_t i = 0; i < sequence_length; i++) {
+    transaction[command_size + i] = registers[i].value;
+  }
+  writeTransaction(mrf, transaction, command_size, sequence_length);
+  for (uint8_t i = 0; i < sequence_length; i++) {
+    updateRegisterCache(mrf, registers[i].address, registers[i].value);
+  }
+  return sequence_length;
+}
+
+uint8_t getLengthOfLongAddressSequence(const MrfIo_RegisterValue *registers, uint8_t count) {
+  uint8_t length = 1;
+  while (length < count
+         && length < MRF_IO_MAXIMUM_REGISTER_SEQUENCE_LENGTH
+         && registers[length].address == registers->address + length) {
+    length++;
+  }
+  return length;
 }
 
 uint8_t MrfIo_readControlRegister(MrfIo *mrf, uint16_t address) {
+#if MRF_IO_REGISTER_CACHE
+  uint8_t index = getCacheIndex(address);
+  if (index != MRF_IO_NOT_CACHED && (mrf->register_cache.valid & (1u << index))) {
+    return mrf->register_cache.values[index];
+  }
+#endif
+  waitForNonBlockingTransfers(mrf);
   if (isLongAddress(address)) {
     setReadLongCommand(mrf, address);
   }
@@ -103,6 +264,7 @@ uint8_t MrfIo_readControlRegister(MrfIo *mrf, uint16_t address) {
   }
   uint8_t value = 0;
   readBlockingWithCommand(mrf, &value, 1);
+  updateRegisterCache(mrf, address, value);
   return value;
 }
 
@@ -112,6 +274,324 @@ bool isLongAddress(uint16_t address){
 }
 
 void MrfIo_readBlockingFromLongAddress(MrfIo *mrf, uint16_t register_address, uint8_t *buffer, uint8_t length) {
+  waitForNonBlockingTransfers(mrf);
   setReadLongCommand(mrf, register_address);
   readBlockingWithCommand(mrf, buffer, length);
 }
+
+/**
+ * The queue is a ring buffer of transfers. New transfers are only
+ * appended by the application (moving queue_tail), while finished
+ * transfers are only removed from within the interrupt driven
+ * completion callbacks (moving queue_head). As both indices are single
+ * bytes, no further locking is needed.
+ * A transfer is started by whoever finds the queue not busy after
+ * appending or removing a transfer. The completion callback clears
+ * the busy flag before looking for further transfers, so a transfer
+ * enqueued in the meantime is never missed.
+ */
+bool MrfIo_writeNonBlockingToLongAddress(MrfIo *mrf, const MrfIo_NonBlockingWriteContext *context) {
+  return enqueueTransfer(mrf, &context->callback, (uint8_t *) context->output_buffer, context->length,
+                         context->address, MRF_IO_TRANSFER_WRITE_LONG);
+}
+
+bool MrfIo_writeNonBlockingToShortAddress(MrfIo *mrf, const MrfIo_NonBlockingWriteContext *context) {
+  return enqueueTransfer(mrf, &context->callback, (uint8_t *) context->output_buffer, context->length,
+                         context->address, MRF_IO_TRANSFER_WRITE_SHORT);
+}
+
+bool MrfIo_readNonBlockingFromLongAddress(MrfIo *mrf, const MrfIo_NonBlockingReadContext *context) {
+  return enqueueTransfer(mrf, &context->callback, context->input_buffer, context->length,
+                         context->address, MRF_IO_TRANSFER_READ_LONG);
+}
+
+bool MrfIo_readNonBlockingFromShortAddress(MrfIo *mrf, const MrfIo_NonBlockingReadContext *context) {
+  return enqueueTransfer(mrf, &context->callback, context->input_buffer, context->length,
+                         context->address, MRF_IO_TRANSFER_READ_SHORT);
+}
+
+bool MrfIo_isBusy(MrfIo *mrf) {
+  return mrf->busy;
+}
+
+uint8_t MrfIo_getNumberOfFreeTransfers(MrfIo *mrf) {
+  uint8_t used = (uint8_t) ((mrf->queue_tail - mrf->queue_head) & (MRF_IO_TRANSFER_QUEUE_SIZE - 1));
+  return (uint8_t) (MRF_IO_TRANSFER_QUEUE_SIZE - 1 - used);
+}
+
+bool enqueueTransfer(MrfIo *mrf, const MrfIoCallback *callback, uint8_t *buffer, uint8_t length,
+                     uint16_t address, uint8_t type) {
+  uint8_t tail = mrf->queue_tail;
+  uint8_t next_tail = (uint8_t) ((tail + 1) & (MRF_IO_TRANSFER_QUEUE_SIZE - 1));
+  if (next_tail == mrf->queue_head) {
+    return false;
+  }
+  MrfIoTransfer *transfer = &mrf->queue[tail];
+  transfer->callback = *callback;
+  transfer->buffer = buffer;
+  transfer->length = length;
+  transfer->address = address;
+  transfer->type = type;
+  mrf->queue_tail = next_tail;
+  if (!MrfIo_interfaceIsBusy(mrf)) {
+    startNextTransfer(mrf);
+  }
+  return true;
+}
+
+void startNextTransfer(MrfIo *mrf) {
+  if (mrf->queue_head == mrf->queue_tail) {
+    return;
+  }
+  mrf->busy = true;
+  MrfIoTransfer *transfer = &mrf->queue[mrf->queue_head];
+  setCommandForTransfer(mrf, transfer);
+  mrf->transfer_step = MRF_IO_STEP_COMMAND;
+  PeripheralInterface_Callback write_callback = {
+          .function = onWriteComplete,
+          .argument = mrf,
+  };
+  PeripheralInterface_setWriteCallback(mrf->interface, write_callback);
+  PeripheralInterface_selectPeripheral(mrf->interface, mrf->device);
+  PeripheralInterface_writeNonBlocking(mrf->interface, mrf->command, mrf->command_size);
+}
+
+void setCommandForTransfer(MrfIo *mrf, const MrfIoTransfer *transfer) {
+  switch (transfer->type) {
+    case MRF_IO_TRANSFER_WRITE_LONG:
+      setWriteLongCommand(mrf, transfer->address);
+      break;
+    case MRF_IO_TRANSFER_WRITE_SHORT:
+      setWriteShortCommand(mrf, (uint8_t) transfer->address);
+      break;
+    case MRF_IO_TRANSFER_READ_LONG:
+      setReadLongCommand(mrf, transfer->address);
+      break;
+    case MRF_IO_TRANSFER_READ_SHORT:
+    default:
+      setReadShortCommand(mrf, (uint8_t) transfer->address);
+      break;
+  }
+}
+
+void MrfIo_handleWriteComplete(MrfIo *mrf) {
+  MrfIoTransfer *transfer = &mrf->queue[mrf->queue_head];
+  if (mrf->transfer_step == MRF_IO_STEP_DATA || transfer->length == 0) {
+    finishCurrentTransfer(mrf);
+    return;
+  }
+  mrf->transfer_step = MRF_IO_STEP_DATA;
+  if (transfer->type == MRF_IO_TRANSFER_WRITE_LONG || transfer->type == MRF_IO_TRANSFER_WRITE_SHORT) {
+    PeripheralInterface_writeNonBlocking(mrf->interface, transfer->buffer, transfer->length);
+  }
+  else {
+    PeripheralInterface_Callback read_callback = {
+            .function = onReadComplete,
+            .argument = mrf,
+    };
+    PeripheralInterface_setReadCallback(mrf->interface, read_callback);
+    PeripheralInterface_readNonBlocking(mrf->interface, transfer->buffer, transfer->length);
+  }
+}
+
+void MrfIo_handleReadComplete(MrfIo *mrf) {
+  finishCurrentTransfer(mrf);
+}
+
+void finishCurrentTransfer(MrfIo *mrf) {
+  PeripheralInterface_deselectPeripheral(mrf->interface, mrf->device);
+  MrfIoTransfer *transfer = &mrf->queue[mrf->queue_head];
+  if (transfer->type == MRF_IO_TRANSFER_WRITE_LONG) {
+    rememberTxHeaderLength(mrf, transfer->address, transfer->buffer, transfer->length);
+  }
+  countTransaction(mrf, mrf->command, mrf->command_size, transfer->length);
+  MrfIoCallback callback = mrf->queue[mrf->queue_head].callback;
+  mrf->queue_head = (uint8_t) ((mrf->queue_head + 1) & (MRF_IO_TRANSFER_QUEUE_SIZE - 1));
+  mrf->busy = false;
+  if (callback.function != NULL) {
+    callback.function(callback.argument);
+  }
+  if (!MrfIo_interfaceIsBusy(mrf)) {
+    startNextTransferOnInterface(mrf);
+  }
+}
+
+void onWriteComplete(void *mrf) {
+  MrfIo_handleWriteComplete((MrfIo *) mrf);
+}
+
+void onReadComplete(void *mrf) {
+  MrfIo_handleReadComplete((MrfIo *) mrf);
+}
+
+void waitForNonBlockingTransfers(MrfIo *mrf) {
+  while (MrfIo_interfaceIsBusy(mrf)) {}
+}
+
+void MrfIo_shareInterface(MrfIo *mrf, MrfIo *other) {
+  if (other->next_on_interface == NULL) {
+    other->next_on_interface = other;
+  }
+  mrf->next_on_interface = other->next_on_interface;
+  other->next_on_interface = mrf;
+}
+
+MrfIo *getNextOnInterface(MrfIo *mrf) {
+  return mrf->next_on_interface == NULL ? mrf : mrf->next_on_interface;
+}
+
+bool MrfIo_interfaceIsBusy(MrfIo *mrf) {
+  MrfIo *current = mrf;
+  do {
+    if (current->busy) {
+      return true;
+    }
+    current = getNextOnInterface(current);
+  } while (current != mrf);
+  return false;
+}
+
+/**
+ * Starts with the MrfIo following mrf and ends
+ * with mrf itself, so a MrfIo with a long queue
+ * cannot keep the others from the interface.
+ */
+void startNextTransferOnInterface(MrfIo *mrf) {
+  MrfIo *current = mrf;
+  do {
+    current = getNextOnInterface(current);
+    startNextTransfer(current);
+  } while (current != mrf && !current->busy);
+}
+
+void MrfIo_getStatistics(MrfIo *mrf, Mac802154BusStatistics *statistics) {
+#if MRF_IO_STATISTICS
+  *statistics = mrf->statistics;
+#else
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_BUS_OPERATIONS; i++) {
+    Mac802154BusCounters *counters = &statistics->operation[i];
+    counters->transactions = 0;
+    counters->command_bytes = 0;
+    counters->bytes_written = 0;
+    counters->bytes_read = 0;
+  }
+#endif
+}
+
+#if MRF_IO_REGISTER_CACHE
+/*
+ * Only registers that are never changed by the mrf itself are
+ * cached. E.g. BBREG6 is excluded, as RSSIRDY is set and RSSIMODE1
+ * is cleared by the mrf, and so are strobes like RFCTL that have to
+ * be written even if the value did not change.
+ */
+static uint8_t getCacheIndex(uint16_t address) {
+  if (address >= mrf_register_rf_control0 && address <= mrf_register_rf_control8) {
+    return (uint8_t) (address - mrf_register_rf_control0);
+  }
+  const uint16_t other_registers[] = {
+          mrf_register_receive_mac_control,
+          mrf_register_power_amplifier_control2,
+          mrf_register_tx_stabilization,
+          mrf_register_base_band2,
+          mrf_register_energy_detection_threshold_for_clear_channel_assessment,
+          mrf_register_sleep_clock_control0,
+          mrf_register_sleep_clock_control1,
+  };
+  const uint8_t first_index = (uint8_t) (mrf_register_rf_control8 - mrf_register_rf_control0 + 1);
+  for (uint8_t i = 0; i < sizeof(other_registers) / sizeof(other_registers[0]); i++) {
+    if (other_registers[i] == address) {
+      return (uint8_t) (first_index + i);
+    }
+  }
+  return MRF_IO_NOT_CACHED;
+}
+#endif
+
+bool registerHoldsValue(MrfIo *mrf, uint16_t address, uint8_t value) {
+#if MRF_IO_REGISTER_CACHE
+  uint8_t index = getCacheIndex(address);
+  return index != MRF_IO_NOT_CACHED
+         && (mrf->register_cache.valid & (1u << index))
+         && mrf->register_cache.values[index] == value;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Any software reset might restore the default
+ * values, so the whole cache is discarded.
+ */
+void updateRegisterCache(MrfIo *mrf, uint16_t address, uint8_t value) {
+#if MRF_IO_REGISTER_CACHE
+  if (address == mrf_register_software_reset) {
+    mrf->register_cache.valid = 0;
+    return;
+  }
+  uint8_t index = getCacheIndex(address);
+  if (index != MRF_IO_NOT_CACHED) {
+    mrf->register_cache.values[index] = value;
+    mrf->register_cache.valid |= (uint16_t) (1u << index);
+  }
+#endif
+}
+
+/*
+ * The tx normal fifo starts with the header length and the
+ * frame length field, followed by the header and the payload.
+ * So the first byte written to it tells where the payload starts.
+ */
+void rememberTxHeaderLength(MrfIo *mrf, uint16_t address, const uint8_t *data, uint8_t size) {
+#if MRF_IO_STATISTICS
+  if (address == mrf_tx_fifo_start && size > 0) {
+    mrf->tx_payload_start = (uint8_t) (mrf_tx_fifo_length_fields_size + data[0]);
+  }
+#endif
+}
+
+#if MRF_IO_STATISTICS
+static uint8_t getOperation(MrfIo *mrf, uint16_t address, bool long_address, bool write) {
+  if (long_address && address >= mrf_rx_fifo_start && address < mrf_rx_fifo_start + mrf_rx_fifo_length) {
+    return MAC802154_BUS_OPERATION_RX_FETCH;
+  }
+  if (long_address && write && address < mrf_tx_normal_fifo_length) {
+    return address < mrf->tx_payload_start ? MAC802154_BUS_OPERATION_HEADER_WRITE
+                                           : MAC802154_BUS_OPERATION_PAYLOAD_WRITE;
+  }
+  if (!long_address && !write
+      && (address == mrf_register_interrupt_status || address == mrf_register_tx_status)) {
+    return MAC802154_BUS_OPERATION_STATUS_POLL;
+  }
+  return MAC802154_BUS_OPERATION_REGISTER_CONFIG;
+}
+#endif
+
+/*
+ * Address and direction are decoded from the command
+ * bytes, see MRFHelperFunctions.h for their layout.
+ */
+void countTransaction(MrfIo *mrf, const uint8_t *command, uint8_t command_size, uint8_t data_size) {
+#if MRF_IO_STATISTICS
+  bool long_address = command_size == 2;
+  uint16_t address;
+  bool write;
+  if (long_address) {
+    address = (uint16_t) ((command[0] & 0x7F) << 3 | command[1] >> 5);
+    write = (command[1] >> 4) & 1;
+  }
+  else {
+    address = (uint16_t) ((command[0] >> 1) & 0x3F);
+    write = command[0] & 1;
+  }
+  Mac802154BusCounters *counters = &mrf->statistics.operation[getOperation(mrf, address, long_address, write)];
+  counters->transactions++;
+  counters->command_bytes += command_size;
+  if (write) {
+    counters->bytes_written += data_size;
+  }
+  else {
+    counters->bytes_read += data_size;
+  }
+#endif
+}
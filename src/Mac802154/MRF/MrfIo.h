@@ -2,6 +2,7 @@
 #define COMMUNICATIONMODULE_MRFIO_H_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "PeripheralInterface/PeripheralInterface.h"
 #include "CommunicationModule/Mac802154MRFImpl.h"
 
@@ -13,11 +14,30 @@
 typedef struct MrfIo MrfIo;
 typedef struct MrfIoCallback MrfIoCallback;
 typedef struct  MrfIo_NonBlockingWriteContext MrfIo_NonBlockingWriteContext;
+typedef struct  MrfIo_NonBlockingReadContext MrfIo_NonBlockingReadContext;
+typedef struct MrfIo_RegisterValue MrfIo_RegisterValue;
+
+/**
+ * Packed to keep lists of register values free of padding,
+ * so they can be compared bytewise.
+ */
+struct __attribute__((packed)) MrfIo_RegisterValue {
+  uint16_t address;
+  uint8_t value;
+};
 
 
 void MrfIo_writeBlockingToLongAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size, uint16_t address);
 void MrfIo_writeBlockingToShortAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size, uint8_t address);
 
+/**
+ * Writes the segments one after another to consecutive
+ * long addresses starting at address, using a single
+ * transaction.
+ */
+void MrfIo_writeSegmentsBlockingToLongAddress(MrfIo *mrf, const Mac802154PayloadSegment *segments,
+                                              uint8_t number_of_segments, uint16_t address);
+
 /**
  * Evaluates the register address to determine if it belongs to the short or long address space of
  * the mrf chip. Then synchronously writes that value to the address.
@@ -26,11 +46,112 @@ void MrfIo_writeBlockingToShortAddress(MrfIo *mrf, const uint8_t *payload, uint8
  * @param value
  */
 void MrfIo_setControlRegister(MrfIo *mrf, uint16_t register_address, uint8_t value);
+
+/**
+ * Synchronously writes a list of register values. Registers
+ * with consecutive long addresses are written within a single
+ * transaction. Registers in the short address space need one
+ * transaction each, but command and value are transmitted
+ * with a single write.
+ * @param registers list of (address, value) pairs, written in the given order
+ * @param count number of pairs in the list
+ */
+void MrfIo_setControlRegisters(MrfIo *mrf, const MrfIo_RegisterValue *registers, uint8_t count);
 uint8_t MrfIo_readControlRegister(MrfIo *mrf, uint16_t register_address);
 void MrfIo_readBlockingFromLongAddress(MrfIo *mrf, uint16_t register_address, uint8_t *buffer, uint8_t size);
-void MrfIo_readNonBlockingFromLongAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size);
 void MrfIo_readBlockingFromShortAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size);
-void MrfIo_readNonBlockingFromShortAddress(MrfIo *mrf, const uint8_t *payload, uint8_t size);
+
+/**
+ * Reads a complete packet from the rx fifo using a single transaction.
+ * First the frame length field is read, afterwards the frame itself as well
+ * as the link quality and rssi values following it are read without deselecting
+ * the peripheral in between.
+ * @return the number of bytes placed in the buffer, i.e. the size of the
+ *         value of the frame length field plus three or buffer_size
+ *         if the buffer was too small. Nothing is read for a buffer_size of 0.
+ */
+uint8_t MrfIo_readRxFifoBlocking(MrfIo *mrf, uint8_t *buffer, uint8_t buffer_size);
+
+/**
+ * # Non blocking transfers #
+ * The functions below queue a transfer and return immediately.
+ * The transfers are executed one after another. Each transfer
+ * is started from the completion callback of the previous one,
+ * i.e. from within the interrupt handling of the PeripheralInterface.
+ * For this to work the interrupts of the PeripheralInterface
+ * need to be forwarded to PeripheralInterface_handleWriteInterrupt()
+ * and PeripheralInterface_handleReadInterrupt() respectively.
+ * Once a transfer finished its callback is executed (if not NULL).
+ *
+ * The context is copied, so it can be safely removed after
+ * the function returned. However the buffers it points to have
+ * to stay alive until the transfer's callback was executed.
+ *
+ * The blocking functions wait for all queued transfers to finish
+ * before accessing the bus. So never call them from within
+ * a transfer callback.
+ *
+ * @return false if the queue is full and the transfer was discarded
+ */
+bool MrfIo_writeNonBlockingToLongAddress(MrfIo *mrf, const MrfIo_NonBlockingWriteContext *context);
+
+/**
+ * Writing to the short address space is only possible
+ * for one byte at a time, i.e. context->length has to be 1.
+ */
+bool MrfIo_writeNonBlockingToShortAddress(MrfIo *mrf, const MrfIo_NonBlockingWriteContext *context);
+bool MrfIo_readNonBlockingFromLongAddress(MrfIo *mrf, const MrfIo_NonBlockingReadContext *context);
+bool MrfIo_readNonBlockingFromShortAddress(MrfIo *mrf, const MrfIo_NonBlockingReadContext *context);
+
+/**
+ * @return true as long as queued non blocking transfers are not finished
+ */
+bool MrfIo_isBusy(MrfIo *mrf);
+
+/**
+ * @return the number of non blocking transfers that can be
+ * queued before the next one fails, MRF_IO_TRANSFER_QUEUE_SIZE - 1
+ * for an empty queue
+ */
+uint8_t MrfIo_getNumberOfFreeTransfers(MrfIo *mrf);
+
+/**
+ * Like MrfIo_isBusy(), but also true while a MrfIo sharing the
+ * PeripheralInterface (see MrfIo_shareInterface()) transfers data.
+ * Any blocking access waits until this returns false.
+ */
+bool MrfIo_interfaceIsBusy(MrfIo *mrf);
+
+/**
+ * Adds mrf to the MrfIos using the same PeripheralInterface
+ * as other. The MrfIos sharing an interface form a ring
+ * (linked via next_on_interface, NULL if the interface is not
+ * shared). A transfer is only started if no other MrfIo of the
+ * ring is busy, and whenever a transfer finishes the queues are
+ * searched for the next transfer starting with the following
+ * MrfIo, so every MrfIo gets its turn.
+ * Blocking functions wait until the whole ring is idle.
+ */
+void MrfIo_shareInterface(MrfIo *mrf, MrfIo *other);
+
+/**
+ * Copies the counters maintained if MRF_IO_STATISTICS is enabled.
+ * The operation of a transfer is derived from its address:
+ *  - writes to the tx normal fifo starting at the header length or frame
+ *    length field count as header writes, all others as payload writes
+ *  - reading the interrupt or transmission status is a status poll
+ *  - reads from the rx fifo are rx fetches
+ *  - everything else is register configuration
+ * Without MRF_IO_STATISTICS all counters are zero.
+ */
+void MrfIo_getStatistics(MrfIo *mrf, Mac802154BusStatistics *statistics);
+
+/**
+ * These are called from the callbacks registered at the PeripheralInterface
+ * and advance the currently running non blocking transfer.
+ */
+void MrfIo_handleWriteComplete(MrfIo *mrf);
+void MrfIo_handleReadComplete(MrfIo *mrf);
 
 
 
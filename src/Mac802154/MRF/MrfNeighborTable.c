@@ -0,0 +1,95 @@
+#include <string.h>
+#include "src/Mac802154/MRF/MrfNeighborTable.h"
+
+#if MRF_NEIGHBOR_TABLE_SIZE > 0
+
+static MrfNeighbor *findNeighbor(const MrfNeighborTable *self,
+                                 const uint8_t *address,
+                                 uint8_t address_size);
+static MrfNeighbor *addNeighbor(MrfNeighborTable *self,
+                                const uint8_t *address,
+                                uint8_t address_size);
+static uint8_t updateAverage(uint8_t average, uint8_t sample);
+
+enum {
+  MAXIMUM_NUMBER_OF_FRAMES = 0xFF,
+};
+
+void MrfNeighborTable_init(MrfNeighborTable *self) {
+  for (uint8_t i = 0; i < MRF_NEIGHBOR_TABLE_SIZE; i++) {
+    self->neighbors[i].address_size = 0;
+  }
+  self->next_entry = 0;
+}
+
+void MrfNeighborTable_update(MrfNeighborTable *self,
+                             const uint8_t *address,
+                             uint8_t address_size,
+                             uint8_t link_quality,
+                             uint8_t rssi) {
+  MrfNeighbor *neighbor = findNeighbor(self, address, address_size);
+  if (neighbor == NULL) {
+    neighbor = addNeighbor(self, address, address_size);
+    neighbor->quality.link_quality = link_quality;
+    neighbor->quality.rssi = rssi;
+    neighbor->quality.number_of_frames = 1;
+    return;
+  }
+  neighbor->quality.link_quality = updateAverage(neighbor->quality.link_quality, link_quality);
+  neighbor->quality.rssi = updateAverage(neighbor->quality.rssi, rssi);
+  if (neighbor->quality.number_of_frames < MAXIMUM_NUMBER_OF_FRAMES) {
+    neighbor->quality.number_of_frames++;
+  }
+}
+
+bool MrfNeighborTable_get(const MrfNeighborTable *self,
+                          const uint8_t *address,
+                          uint8_t address_size,
+                          Mac802154LinkQuality *quality) {
+  const MrfNeighbor *neighbor = findNeighbor(self, address, address_size);
+  if (neighbor == NULL) {
+    return false;
+  }
+  *quality = neighbor->quality;
+  return true;
+}
+
+MrfNeighbor *findNeighbor(const MrfNeighborTable *self,
+                          const uint8_t *address,
+                          uint8_t address_size) {
+  for (uint8_t i = 0; i < MRF_NEIGHBOR_TABLE_SIZE; i++) {
+    const MrfNeighbor *neighbor = &self->neighbors[i];
+    if (neighbor->address_size == address_size
+        && memcmp(neighbor->address, address, address_size) == 0) {
+      return (MrfNeighbor *) neighbor;
+    }
+  }
+  return NULL;
+}
+
+MrfNeighbor *addNeighbor(MrfNeighborTable *self,
+                         const uint8_t *address,
+                         uint8_t address_size) {
+  MrfNeighbor *neighbor = &self->neighbors[self->next_entry];
+  memcpy(neighbor->address, address, address_size);
+  neighbor->address_size = address_size;
+  self->next_entry = (uint8_t) ((self->next_entry + 1) % MRF_NEIGHBOR_TABLE_SIZE);
+  return neighbor;
+}
+
+/*
+ * Rounds towards the sample, so the average
+ * reaches a constant sample eventually.
+ */
+uint8_t updateAverage(uint8_t average, uint8_t sample) {
+  int16_t difference = (int16_t) sample - average;
+  if (difference > 0) {
+    difference += 3;
+  }
+  else {
+    difference -= 3;
+  }
+  return (uint8_t) (average + difference / 4);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef COMMUNICATIONMODULE_MRFNEIGHBORTABLE_H
+#define COMMUNICATIONMODULE_MRFNEIGHBORTABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CommunicationModule/Mac802154MRFImpl.h"
+
+/**
+ * Keeps moving averages of the link quality and rssi
+ * of the frames received from each of the last
+ * MRF_NEIGHBOR_TABLE_SIZE senders.
+ */
+
+typedef struct MrfNeighborTable MrfNeighborTable;
+
+void MrfNeighborTable_init(MrfNeighborTable *self);
+
+/**
+ * Adds the values of a received frame to the averages of its sender.
+ * The first frame of a sender initializes the averages, every following
+ * one is weighted by 1/4. Once the table is full, the sender recorded
+ * first is forgotten.
+ * @param address_size 2 or 8, extended and short addresses
+ *        are never considered equal
+ */
+void MrfNeighborTable_update(MrfNeighborTable *self,
+                             const uint8_t *address,
+                             uint8_t address_size,
+                             uint8_t link_quality,
+                             uint8_t rssi);
+
+/**
+ * @return false if the sender is not in the table
+ */
+bool MrfNeighborTable_get(const MrfNeighborTable *self,
+                          const uint8_t *address,
+                          uint8_t address_size,
+                          Mac802154LinkQuality *quality);
+
+#endif //COMMUNICATIONMODULE_MRFNEIGHBORTABLE_H
@@ -1,4 +1,5 @@
 #include "CommunicationModule/Mac802154.h"
+#include <stddef.h>
 
 
 void Mac802154_configure(Mac802154 *self, const Mac802154Config *config) {
@@ -9,6 +10,34 @@ void Mac802154_sendBlocking(Mac802154 *self) {
   self->sendBlocking(self);
 }
 
+bool Mac802154_sendNonBlocking(Mac802154 *self) {
+  return self->sendNonBlocking(self);
+}
+
+void Mac802154_setTransmissionCompleteCallback(Mac802154 *self, Mac802154Callback callback) {
+  self->setTransmissionCompleteCallback(self, callback);
+}
+
+bool Mac802154_enqueueFrame(Mac802154 *self, const Mac802154Frame *frame) {
+  return self->enqueueFrame(self, frame);
+}
+
+uint8_t Mac802154_getNumberOfFramesToSend(Mac802154 *self) {
+  return self->getNumberOfFramesToSend(self);
+}
+
+void Mac802154_enableAcknowledgement(Mac802154 *self) {
+  self->enableAcknowledgement(self);
+}
+
+void Mac802154_disableAcknowledgement(Mac802154 *self) {
+  self->disableAcknowledgement(self);
+}
+
+void Mac802154_getTransmissionStatus(Mac802154 *self, Mac802154TransmissionStatus *status) {
+  self->getTransmissionStatus(self, status);
+}
+
 void Mac802154_setShortDestinationAddress(Mac802154 *self, const uint8_t *address) {
   self->setShortDestinationAddress(self, address);
 }
@@ -17,6 +46,11 @@ void Mac802154_setPayload(Mac802154 *self, const uint8_t *payload, size_t payloa
   self->setPayload(self, payload, payload_length);
 }
 
+void Mac802154_setPayloadVector(Mac802154 *self, const Mac802154PayloadSegment *segments,
+                                uint8_t number_of_segments) {
+  self->setPayloadVector(self, segments, number_of_segments);
+}
+
 void Mac802154_setExtendedDestinationAddress(Mac802154 *self, const uint8_t *address) {
   self->setExtendedDestinationAddress(self, address);
 }
@@ -33,6 +67,26 @@ void Mac802154_fetchPacketBlocking(Mac802154 *self, uint8_t *buffer, uint8_t siz
   self->fetchPacketBlocking(self, buffer, size);
 }
 
+uint8_t Mac802154_fetchCompletePacketBlocking(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size) {
+  return self->fetchCompletePacketBlocking(self, buffer, buffer_size);
+}
+
+uint8_t Mac802154_dequeuePacket(Mac802154 *self, uint8_t *buffer, uint8_t buffer_size) {
+  return self->dequeuePacket(self, buffer, buffer_size);
+}
+
+uint8_t Mac802154_getNumberOfQueuedPackets(Mac802154 *self) {
+  return self->getNumberOfQueuedPackets(self);
+}
+
+void Mac802154_getBusStatistics(Mac802154 *self, Mac802154BusStatistics *statistics) {
+  self->getBusStatistics(self, statistics);
+}
+
+void Mac802154_getChannelAccessStatistics(Mac802154 *self, Mac802154ChannelAccessStatistics *statistics) {
+  self->getChannelAccessStatistics(self, statistics);
+}
+
 const uint8_t * Mac802154_getPacketPayload(Mac802154 *self, const uint8_t *packet) {
   return self->getPacketPayload(packet);
 }
@@ -60,6 +114,117 @@ Mac802154_getPacketShortSourceAddress(const Mac802154 *self, const uint8_t *pack
   return self->getPacketShortSourceAddress(packet);
 }
 
+uint8_t
+Mac802154_getPacketLinkQuality(const Mac802154 *self, const uint8_t *packet)
+{
+  return self->getPacketLinkQuality(packet);
+}
+
+uint8_t
+Mac802154_getPacketRssi(const Mac802154 *self, const uint8_t *packet)
+{
+  return self->getPacketRssi(packet);
+}
+
+bool
+Mac802154_getNeighborLinkQuality(Mac802154 *self, const uint8_t *address, uint8_t address_size,
+                                 Mac802154LinkQuality *quality)
+{
+  return self->getNeighborLinkQuality(self, address, address_size, quality);
+}
+
+bool
+Mac802154_parsePacket(Mac802154 *self, const uint8_t *packet, uint8_t packet_size, Mac802154FrameView *view)
+{
+  return self->parsePacket(packet, packet_size, view);
+}
+
+static const uint8_t *
+getFieldOfView(const Mac802154FrameView *view, uint8_t offset, uint8_t size)
+{
+  if (size == 0) {
+    return NULL;
+  }
+  return view->packet + offset;
+}
+
+const uint8_t *
+Mac802154FrameView_getSequenceNumber(const Mac802154FrameView *view)
+{
+  return getFieldOfView(view, view->sequence_number_offset, view->sequence_number_size);
+}
+
+uint8_t
+Mac802154FrameView_getFrameType(const Mac802154FrameView *view)
+{
+  return view->frame_type;
+}
+
+const uint8_t *
+Mac802154FrameView_getPanId(const Mac802154FrameView *view)
+{
+  return getFieldOfView(view, view->pan_id_offset, view->pan_id_size);
+}
+
+const uint8_t *
+Mac802154FrameView_getDestinationAddress(const Mac802154FrameView *view)
+{
+  return getFieldOfView(view, view->destination_address_offset, view->destination_address_size);
+}
+
+uint8_t
+Mac802154FrameView_getDestinationAddressSize(const Mac802154FrameView *view)
+{
+  return view->destination_address_size;
+}
+
+const uint8_t *
+Mac802154FrameView_getSourceAddress(const Mac802154FrameView *view)
+{
+  return getFieldOfView(view, view->source_address_offset, view->source_address_size);
+}
+
+uint8_t
+Mac802154FrameView_getSourceAddressSize(const Mac802154FrameView *view)
+{
+  return view->source_address_size;
+}
+
+const uint8_t *
+Mac802154FrameView_getPayload(const Mac802154FrameView *view)
+{
+  return getFieldOfView(view, view->payload_offset, view->payload_size);
+}
+
+uint8_t
+Mac802154FrameView_getPayloadSize(const Mac802154FrameView *view)
+{
+  return view->payload_size;
+}
+
+const uint8_t *
+Mac802154FrameView_getFrameCheckSequence(const Mac802154FrameView *view)
+{
+  return view->packet + view->frame_check_sequence_offset;
+}
+
+const uint8_t *
+Mac802154FrameView_getLinkQuality(const Mac802154FrameView *view)
+{
+  if (view->link_quality_offset == 0) {
+    return NULL;
+  }
+  return view->packet + view->link_quality_offset;
+}
+
+const uint8_t *
+Mac802154FrameView_getRssi(const Mac802154FrameView *view)
+{
+  if (view->rssi_offset == 0) {
+    return NULL;
+  }
+  return view->packet + view->rssi_offset;
+}
 
 uint8_t
 Mac802154_getPacketPayloadSize(Mac802154 *self, const uint8_t *packet) {
@@ -78,6 +243,50 @@ Mac802154_disablePromiscuousMode(Mac802154 *self)
   self->disablePromiscuousMode(self);
 }
 
+void
+Mac802154_setReceiveFilter(Mac802154 *self, const Mac802154ReceiveFilter *filter)
+{
+  self->setReceiveFilter(self, filter);
+}
+
+void
+Mac802154_setFrameType(Mac802154 *self, uint8_t frame_type)
+{
+  self->setFrameType(self, frame_type);
+}
+
+void
+Mac802154_scanEnergy(Mac802154 *self, uint8_t samples_per_channel, uint8_t *energy)
+{
+  self->scanEnergy(self, samples_per_channel, energy);
+}
+
+uint8_t
+Mac802154_getQuietestChannel(const uint8_t *energy)
+{
+  uint8_t quietest = 0;
+  for (uint8_t i = 1; i < MAC802154_NUMBER_OF_CHANNELS; i++)
+  {
+    if (energy[i] < energy[quietest])
+    {
+      quietest = i;
+    }
+  }
+  return (uint8_t) (MAC802154_FIRST_CHANNEL + quietest);
+}
+
+void
+Mac802154_sleep(Mac802154 *self)
+{
+  self->sleep(self);
+}
+
+void
+Mac802154_wakeUp(Mac802154 *self)
+{
+  self->wakeUp(self);
+}
+
 void
 Mac802154_useExtendedSourceAddress(Mac802154 *self)
 {
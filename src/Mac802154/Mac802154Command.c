@@ -0,0 +1,199 @@
+#include <string.h>
+#include "CommunicationModule/Mac802154Command.h"
+
+/*
+ * Superframe specification (little endian):
+ * bits 0-3 beacon order, bits 4-7 superframe order,
+ * bits 8-11 final cap slot, bit 14 pan coordinator,
+ * bit 15 association permit
+ */
+enum {
+  ORDER_MASK = 0x0F,
+  SUPERFRAME_ORDER_OFFSET = 4,
+  PAN_COORDINATOR = 1 << 6,
+  ASSOCIATION_PERMIT = 1 << 7,
+  SUPERFRAME_SPECIFICATION_SIZE = 2,
+  GTS_DESCRIPTOR_COUNT_MASK = 0x07,
+  GTS_PERMIT = 1 << 7,
+  GTS_STARTING_SLOT_MASK = 0x0F,
+  GTS_LENGTH_OFFSET = 4,
+  GTS_DIRECTIONS_SIZE = 1,
+  GTS_DESCRIPTOR_SIZE = 3,
+  PENDING_SHORT_ADDRESSES_MASK = 0x07,
+  PENDING_EXTENDED_ADDRESSES_OFFSET = 4,
+  PENDING_EXTENDED_ADDRESSES_MASK = 0x07,
+  SHORT_ADDRESS_SIZE = 2,
+  EXTENDED_ADDRESS_SIZE = 8,
+  ASSOCIATION_REQUEST_SIZE = 2,
+  ASSOCIATION_RESPONSE_SIZE = 4,
+};
+
+static bool isCommand(const uint8_t *payload, uint8_t payload_size,
+                      uint8_t identifier, uint8_t size);
+
+static uint8_t writeGuaranteedTimeSlots(uint8_t *buffer, const Mac802154Beacon *beacon);
+
+static void parseGuaranteedTimeSlots(const uint8_t *descriptors, uint8_t directions, Mac802154Beacon *beacon);
+
+uint8_t Mac802154Command_writeAssociationRequest(uint8_t *buffer, uint8_t capability_information) {
+  buffer[0] = MAC802154_COMMAND_ASSOCIATION_REQUEST;
+  buffer[1] = capability_information;
+  return ASSOCIATION_REQUEST_SIZE;
+}
+
+uint8_t Mac802154Command_writeAssociationResponse(uint8_t *buffer, const Mac802154AssociationResponse *response) {
+  buffer[0] = MAC802154_COMMAND_ASSOCIATION_RESPONSE;
+  buffer[1] = response->short_address[0];
+  buffer[2] = response->short_address[1];
+  buffer[3] = response->status;
+  return ASSOCIATION_RESPONSE_SIZE;
+}
+
+uint8_t Mac802154Command_writeDataRequest(uint8_t *buffer) {
+  buffer[0] = MAC802154_COMMAND_DATA_REQUEST;
+  return 1;
+}
+
+uint8_t Mac802154Command_writeBeaconRequest(uint8_t *buffer) {
+  buffer[0] = MAC802154_COMMAND_BEACON_REQUEST;
+  return 1;
+}
+
+uint8_t Mac802154Command_getIdentifier(const uint8_t *payload, uint8_t payload_size) {
+  if (payload_size == 0) {
+    return 0;
+  }
+  return payload[0];
+}
+
+bool Mac802154Command_parseAssociationRequest(const uint8_t *payload, uint8_t payload_size,
+                                              uint8_t *capability_information) {
+  if (!isCommand(payload, payload_size, MAC802154_COMMAND_ASSOCIATION_REQUEST, ASSOCIATION_REQUEST_SIZE)) {
+    return false;
+  }
+  *capability_information = payload[1];
+  return true;
+}
+
+bool Mac802154Command_parseAssociationResponse(const uint8_t *payload, uint8_t payload_size,
+                                               Mac802154AssociationResponse *response) {
+  if (!isCommand(payload, payload_size, MAC802154_COMMAND_ASSOCIATION_RESPONSE, ASSOCIATION_RESPONSE_SIZE)) {
+    return false;
+  }
+  response->short_address[0] = payload[1];
+  response->short_address[1] = payload[2];
+  response->status = payload[3];
+  return true;
+}
+
+bool isCommand(const uint8_t *payload, uint8_t payload_size, uint8_t identifier, uint8_t size) {
+  return payload_size >= size && payload[0] == identifier;
+}
+
+/*
+ * | Superframe Specification | GTS Specification | GTS Directions | GTS List | Pending Address Specification | Payload |
+ * |--------------------------|-------------------|----------------|----------|-------------------------------|---------|
+ * | 2                        | 1                 | 0/1            | 3 * k    | 1                             | n       |
+ *
+ * The directions and the list are omitted if there are no
+ * guaranteed time slots. Each descriptor consists of the short
+ * address, the starting slot (bits 0-3) and the length (bits 4-7).
+ */
+uint8_t Mac802154Beacon_write(uint8_t *buffer, const Mac802154Beacon *beacon) {
+  buffer[0] = (uint8_t) ((beacon->beacon_order & ORDER_MASK)
+                         | (beacon->superframe_order & ORDER_MASK) << SUPERFRAME_ORDER_OFFSET);
+  buffer[1] = (uint8_t) (beacon->final_cap_slot & ORDER_MASK);
+  if (beacon->pan_coordinator) {
+    buffer[1] |= PAN_COORDINATOR;
+  }
+  if (beacon->association_permit) {
+    buffer[1] |= ASSOCIATION_PERMIT;
+  }
+  uint8_t offset = SUPERFRAME_SPECIFICATION_SIZE;
+  offset += writeGuaranteedTimeSlots(buffer + offset, beacon);
+  buffer[offset] = 0;
+  offset++;
+  if (beacon->payload_size > 0) {
+    memcpy(buffer + offset, beacon->payload, beacon->payload_size);
+  }
+  return (uint8_t) (offset + beacon->payload_size);
+}
+
+uint8_t writeGuaranteedTimeSlots(uint8_t *buffer, const Mac802154Beacon *beacon) {
+  uint8_t count = beacon->number_of_guaranteed_time_slots;
+  if (count > MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS) {
+    count = MAC802154_MAXIMUM_GUARANTEED_TIME_SLOTS;
+  }
+  buffer[0] = count;
+  if (beacon->guaranteed_time_slot_permit) {
+    buffer[0] |= GTS_PERMIT;
+  }
+  if (count == 0) {
+    return 1;
+  }
+  uint8_t directions = 0;
+  uint8_t *descriptor = buffer + 1 + GTS_DIRECTIONS_SIZE;
+  for (uint8_t i = 0; i < count; i++) {
+    const Mac802154GuaranteedTimeSlot *slot = &beacon->guaranteed_time_slots[i];
+    if (slot->receive) {
+      directions |= (uint8_t) (1 << i);
+    }
+    descriptor[0] = slot->short_address[0];
+    descriptor[1] = slot->short_address[1];
+    descriptor[2] = (uint8_t) ((slot->starting_slot & GTS_STARTING_SLOT_MASK)
+                               | slot->length << GTS_LENGTH_OFFSET);
+    descriptor += GTS_DESCRIPTOR_SIZE;
+  }
+  buffer[1] = directions;
+  return (uint8_t) (1 + GTS_DIRECTIONS_SIZE + count * GTS_DESCRIPTOR_SIZE);
+}
+
+bool Mac802154Beacon_parse(const uint8_t *payload, uint8_t payload_size, Mac802154Beacon *beacon) {
+  if (payload_size < SUPERFRAME_SPECIFICATION_SIZE + 2) {
+    return false;
+  }
+  beacon->beacon_order = payload[0] & ORDER_MASK;
+  beacon->superframe_order = payload[0] >> SUPERFRAME_ORDER_OFFSET;
+  beacon->final_cap_slot = payload[1] & ORDER_MASK;
+  beacon->pan_coordinator = (payload[1] & PAN_COORDINATOR) != 0;
+  beacon->association_permit = (payload[1] & ASSOCIATION_PERMIT) != 0;
+  uint16_t offset = SUPERFRAME_SPECIFICATION_SIZE;
+  uint8_t gts_descriptor_count = payload[offset] & GTS_DESCRIPTOR_COUNT_MASK;
+  beacon->guaranteed_time_slot_permit = (payload[offset] & GTS_PERMIT) != 0;
+  beacon->number_of_guaranteed_time_slots = 0;
+  offset++;
+  if (gts_descriptor_count > 0) {
+    offset += GTS_DIRECTIONS_SIZE + gts_descriptor_count * GTS_DESCRIPTOR_SIZE;
+  }
+  if (offset >= payload_size) {
+    return false;
+  }
+  if (gts_descriptor_count > 0) {
+    beacon->number_of_guaranteed_time_slots = gts_descriptor_count;
+    parseGuaranteedTimeSlots(payload + SUPERFRAME_SPECIFICATION_SIZE + 1 + GTS_DIRECTIONS_SIZE,
+                             payload[SUPERFRAME_SPECIFICATION_SIZE + 1], beacon);
+  }
+  uint8_t pending_addresses = payload[offset];
+  offset++;
+  offset += (pending_addresses & PENDING_SHORT_ADDRESSES_MASK) * SHORT_ADDRESS_SIZE
+            + ((pending_addresses >> PENDING_EXTENDED_ADDRESSES_OFFSET) & PENDING_EXTENDED_ADDRESSES_MASK)
+              * EXTENDED_ADDRESS_SIZE;
+  if (offset > payload_size) {
+    return false;
+  }
+  beacon->payload_size = (uint8_t) (payload_size - offset);
+  beacon->payload = beacon->payload_size > 0 ? payload + offset : NULL;
+  return true;
+}
+
+void parseGuaranteedTimeSlots(const uint8_t *descriptors, uint8_t directions, Mac802154Beacon *beacon) {
+  for (uint8_t i = 0; i < beacon->number_of_guaranteed_time_slots; i++) {
+    Mac802154GuaranteedTimeSlot *slot = &beacon->guaranteed_time_slots[i];
+    slot->short_address[0] = descriptors[0];
+    slot->short_address[1] = descriptors[1];
+    slot->starting_slot = descriptors[2] & GTS_STARTING_SLOT_MASK;
+    slot->length = descriptors[2] >> GTS_LENGTH_OFFSET;
+    slot->receive = (directions & (1 << i)) != 0;
+    descriptors += GTS_DESCRIPTOR_SIZE;
+  }
+}
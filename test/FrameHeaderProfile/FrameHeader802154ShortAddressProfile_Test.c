@@ -0,0 +1,80 @@
+#include "unity.h"
+#include "src/Mac802154/MRF/FrameHeader802154.h"
+#include "CommunicationModule/FrameHeader802154Struct.h"
+#include "CommunicationModule/Mac802154.h"
+
+/**
+ * Built with FRAME_HEADER802154_PROFILE set to
+ * FRAME_HEADER802154_PROFILE_SHORT_ADDRESSES (see BUILD).
+ * The fields have to end up at the same positions, the generic
+ * functions reading the header expect them.
+ */
+
+static FrameHeader802154 header_memory;
+static FrameHeader802154 *header = &header_memory;
+static const uint8_t pan_id[] = {0x34, 0x12};
+static const uint8_t destination[] = {0x02, 0x00};
+static const uint8_t source[] = {0x01, 0x00};
+
+void setUp(void) {
+  FrameHeader802154_init(header);
+}
+
+void test_profileIsEnabled(void) {
+  TEST_ASSERT_EQUAL_INT(FRAME_HEADER802154_PROFILE_SHORT_ADDRESSES, FRAME_HEADER802154_PROFILE);
+}
+
+void test_controlFieldMatchesDefaultOfGenericHeader(void) {
+  uint8_t expected_control_field[] = {0x41, 0xA8};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_control_field, FrameHeader802154_getHeaderPtr(header), 2);
+}
+
+void test_headerSizeIncludesSequenceNumberPanIdAndShortAddresses(void) {
+  TEST_ASSERT_EQUAL_UINT8(9, FrameHeader802154_getHeaderSize(header));
+  TEST_ASSERT_EQUAL_UINT8(2, FrameHeader802154_getDestinationAddressSize(header));
+  TEST_ASSERT_EQUAL_UINT8(2, FrameHeader802154_getSourceAddressSize(header));
+}
+
+void test_fieldsAreWrittenToTheirFixedOffsets(void) {
+  FrameHeader802154_setShortSourceAddress(header, source);
+  FrameHeader802154_setShortDestinationAddress(header, destination);
+  FrameHeader802154_setPanId(header, pan_id);
+  FrameHeader802154_setSequenceNumber(header, 0x07);
+  uint8_t expected[] = {0x41, 0xA8, 0x07, 0x34, 0x12, 0x02, 0x00, 0x01, 0x00};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, FrameHeader802154_getHeaderPtr(header), sizeof(expected));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(destination, FrameHeader802154_getDestinationAddressPtr(header), 2);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(source, FrameHeader802154_getSourceAddressPtr(header), 2);
+}
+
+void test_settingSequenceNumberTwiceDoesNotMoveFields(void) {
+  FrameHeader802154_setPanId(header, pan_id);
+  FrameHeader802154_setSequenceNumber(header, 1);
+  FrameHeader802154_setSequenceNumber(header, 2);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(pan_id, FrameHeader802154_getPanIdPtr(header), 2);
+}
+
+void test_extendedAddressesAreIgnored(void) {
+  const uint8_t extended_address[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  FrameHeader802154_setExtendedDestinationAddress(header, extended_address);
+  FrameHeader802154_setExtendedSourceAddress(header, extended_address);
+  TEST_ASSERT_EQUAL_UINT8(9, FrameHeader802154_getHeaderSize(header));
+}
+
+void test_sequenceNumberCannotBeSuppressed(void) {
+  FrameHeader802154_enableSequenceNumberSuppression(header);
+  TEST_ASSERT_EQUAL_UINT8(1, FrameHeader802154_getSequenceNumberSize(header));
+}
+
+void test_acknowledgementRequest(void) {
+  FrameHeader802154_enableAcknowledgementRequest(header);
+  TEST_ASSERT_BIT_HIGH(5, *FrameHeader802154_getHeaderPtr(header));
+  FrameHeader802154_disableAcknowledgementRequest(header);
+  TEST_ASSERT_BIT_LOW(5, *FrameHeader802154_getHeaderPtr(header));
+}
+
+void test_frameTypeKeepsOtherControlFieldBits(void) {
+  FrameHeader802154_enableAcknowledgementRequest(header);
+  FrameHeader802154_setFrameType(header, FRAME_TYPE_MAC_COMMAND);
+  TEST_ASSERT_EQUAL_HEX8(0x63, *FrameHeader802154_getHeaderPtr(header));
+  TEST_ASSERT_EQUAL_UINT8(FRAME_TYPE_MAC_COMMAND, FrameHeader802154_getFrameType(header));
+}
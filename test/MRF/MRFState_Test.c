@@ -123,6 +123,38 @@ void test_getPayload(void) {
   TEST_ASSERT_EQUAL_PTR(payload, MrfState_getPayload(&mrf_state));
 }
 
+void
+test_getPayloadFieldOfPayloadVector(void)
+{
+  uint8_t header[] = "abc";
+  uint8_t data[] = "defgh";
+  Mac802154PayloadSegment segments[2] = {
+      {.data = header, .length = 3},
+      {.data = data, .length = 5},
+  };
+  MrfState_setPayloadVector(&mrf_state, segments, 2);
+  MrfField field = MrfState_getPayloadField(&mrf_state);
+  TEST_ASSERT_EQUAL_UINT8(8, MrfState_getPayloadLength(&mrf_state));
+  TEST_ASSERT_EQUAL_UINT8(8, field.length);
+  TEST_ASSERT_EQUAL_UINT8(frame802_header_length + 2, field.address);
+  TEST_ASSERT_EQUAL_PTR(segments, field.segments);
+  TEST_ASSERT_EQUAL_UINT8(2, field.number_of_segments);
+}
+
+void
+test_setPayloadReplacesPayloadVector(void)
+{
+  uint8_t payload[] = "abc";
+  Mac802154PayloadSegment segments[1] = {
+      {.data = payload, .length = 3},
+  };
+  MrfState_setPayloadVector(&mrf_state, segments, 1);
+  MrfState_setPayload(&mrf_state, payload, 3);
+  MrfField field = MrfState_getPayloadField(&mrf_state);
+  TEST_ASSERT_EQUAL_PTR(payload, field.data);
+  TEST_ASSERT_EQUAL_UINT8(0, field.number_of_segments);
+}
+
 void
 test_getPayloadLength(void)
 {
@@ -234,3 +266,157 @@ test_enableAcknowledgement(void)
   FrameHeader802154_enableAcknowledgementRequest_Expect(&mrf_state.header.frame_header);
   MrfState_enableAcknowledgement(&mrf_state);
 }
+
+void
+test_disableAcknowledgement(void)
+{
+  FrameHeader802154_disableAcknowledgementRequest_Expect(&mrf_state.header.frame_header);
+  MrfState_disableAcknowledgement(&mrf_state);
+}
+
+void
+test_setFrameType(void)
+{
+  FrameHeader802154_setFrameType_Expect(&mrf_state.header.frame_header, FRAME_TYPE_MAC_COMMAND);
+  MrfState_setFrameType(&mrf_state, FRAME_TYPE_MAC_COMMAND);
+}
+
+static void
+moveIteratorBehindLastField(void)
+{
+  while (MrfState_moveIteratorToNextField(&mrf_state)) {}
+}
+
+void
+test_noChangedFieldsAfterIteratingAllFields(void)
+{
+  moveIteratorBehindLastField();
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_onlyPayloadAfterSettingPayloadOfSameLength(void)
+{
+  uint8_t first_payload[] = "mimimi";
+  uint8_t second_payload[] = "mamama";
+  MrfState_setPayload(&mrf_state, first_payload, 6);
+  moveIteratorBehindLastField();
+  MrfState_setPayload(&mrf_state, second_payload, 6);
+  MrfField expected = {
+      .address = frame802_header_length + 2,
+      .length = 6,
+      .data = second_payload,
+  };
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(expected, MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_frameLengthAndPayloadAfterChangingPayloadLength(void)
+{
+  uint8_t payload[] = "mimimi";
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  MrfState_setPayload(&mrf_state, payload, 5);
+  MrfField expected_frame_length = {
+      .address = 1,
+      .length = 1,
+      .data = &mrf_state.header.frame_length,
+  };
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(expected_frame_length, MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_EQUAL_UINT8(frame802_header_length + 5, mrf_state.header.frame_length);
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_PTR(payload, MrfState_getCurrentField(&mrf_state).data);
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_payloadMovesWhenHeaderSizeChanges(void)
+{
+  uint8_t payload[] = "mimimi";
+  uint8_t short_address[2] = {0xAB, 0x12};
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  FrameHeader802154_setShortDestinationAddress_Ignore();
+  FrameHeader802154_getHeaderSize_IgnoreAndReturn(frame802_header_length + 4);
+  MrfState_setShortDestinationAddress(&mrf_state, short_address);
+  MrfField expected_payload = {
+      .address = frame802_header_length + 4 + 2,
+      .length = 6,
+      .data = payload,
+  };
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_UINT8(0, MrfState_getCurrentField(&mrf_state).address);
+  TEST_ASSERT_EQUAL_UINT8(frame802_header_length + 4 + 6, mrf_state.header.frame_length);
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(expected_payload, MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_onlyHeaderAfterChangingPanId(void)
+{
+  uint8_t payload[] = "mimimi";
+  uint8_t pan_id[2] = {0x54, 0x11};
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  FrameHeader802154_setPanId_Ignore();
+  MrfState_setPanId(&mrf_state, pan_id);
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(MrfState_getFullHeaderField(&mrf_state), MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_onlySequenceNumberAfterChangingSequenceNumber(void)
+{
+  uint8_t payload[] = "mimimi";
+  uint8_t sequence_number = 0x17;
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  FrameHeader802154_setSequenceNumber_Expect(&mrf_state.header.frame_header, 0x17);
+  FrameHeader802154_getHeaderSize_IgnoreAndReturn(frame802_header_length);
+  FrameHeader802154_getSequenceNumberPtr_IgnoreAndReturn(&sequence_number);
+  MrfState_setSequenceNumber(&mrf_state, 0x17);
+  MrfField expected = {
+      .address = 4,
+      .length = 1,
+      .data = &sequence_number,
+  };
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(expected, MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_sequenceNumberIsWrittenWithFullHeader(void)
+{
+  uint8_t payload[] = "mimimi";
+  uint8_t pan_id[2] = {0x54, 0x11};
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  FrameHeader802154_setSequenceNumber_Ignore();
+  FrameHeader802154_setPanId_Ignore();
+  FrameHeader802154_getHeaderSize_IgnoreAndReturn(frame802_header_length);
+  MrfState_setSequenceNumber(&mrf_state, 3);
+  MrfState_setPanId(&mrf_state, pan_id);
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(MrfState_getFullHeaderField(&mrf_state), MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
+
+void
+test_headerAndPayloadAfterMarkingAllFieldsAsChanged(void)
+{
+  uint8_t payload[] = "mimimi";
+  MrfState_setPayload(&mrf_state, payload, 6);
+  moveIteratorBehindLastField();
+  MrfState_markAllFieldsAsChanged(&mrf_state);
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_MRF_FIELD(MrfState_getFullHeaderField(&mrf_state), MrfState_getCurrentField(&mrf_state));
+  TEST_ASSERT_TRUE(MrfState_moveIteratorToNextField(&mrf_state));
+  TEST_ASSERT_EQUAL_PTR(payload, MrfState_getCurrentField(&mrf_state).data);
+  TEST_ASSERT_FALSE(MrfState_moveIteratorToNextField(&mrf_state));
+}
@@ -119,53 +119,53 @@ test_initWithDifferentConfig(void)
   Mac802154_configure(mrf, &mac_config);
 }
 
+enum {
+  number_of_initialization_values = 10,
+  number_of_channel_access_values = 3,
+};
+static MrfIo_RegisterValue expected_initialization_values[number_of_initialization_values];
+static MrfIo_RegisterValue expected_channel_access_values[number_of_channel_access_values];
+
 void
 setUpInitializationValues(MrfIo *impl,
                           const Mac802154Config *config)
 {
   MrfIo_setControlRegister_Expect(
     impl, mrf_register_software_reset, mrf_value_full_software_reset);
+  const MrfIo_RegisterValue initialization_values[] = {
+    {
+      mrf_register_power_amplifier_control2,
+      mrf_fifo_enable |
+      mrf_value_recommended_transmitter_on_time_before_beginning_a_packet,
+    },
+    {mrf_register_tx_stabilization, mrf_value_recommended_interframe_spacing},
+    {mrf_register_rf_control0, mrf_value_recommended_rf_optimize_control0},
+    {mrf_register_rf_control1, mrf_value_recommended_rf_optimize_control1},
+    {mrf_register_rf_control2, mrf_value_phase_locked_loop_enabled},
+    {
+      mrf_register_rf_control6,
+      mrf_value_enable_tx_filter | mrf_value_20MHz_clock_recovery_less_than_1ms,
+    },
+    {mrf_register_rf_control7, mrf_value_use_internal_100kHz_oscillator},
+    {mrf_register_rf_control8, mrf_value_recommended_rf_control8},
+    {
+      mrf_register_sleep_clock_control1,
+      mrf_value_disable_deprecated_clkout_sleep_clock_feature |
+      mrf_value_minimum_sleep_clock_divisor_for_internal_oscillator,
+    },
+    {mrf_register_base_band6, mrf_value_append_rssi_value_to_rxfifo},
+  };
+  // the expectation is checked after we returned, so keep a copy alive
+  memcpy(expected_initialization_values,
+         initialization_values,
+         sizeof(initialization_values));
+  MrfIo_setControlRegisters_ExpectWithArray(
+    impl, 1, expected_initialization_values,
+    number_of_initialization_values, number_of_initialization_values);
   MrfIo_setControlRegister_Expect(
     impl,
-    mrf_register_power_amplifier_control2,
-    mrf_fifo_enable |
-    mrf_value_recommended_transmitter_on_time_before_beginning_a_packet);
-  MrfIo_setControlRegister_Expect(impl,
-                                  mrf_register_tx_stabilization,
-                                  mrf_value_recommended_interframe_spacing);
-  MrfIo_setControlRegister_Expect(impl,
-                                  mrf_register_rf_control0,
-                                  mrf_value_recommended_rf_optimize_control0);
-  MrfIo_setControlRegister_Expect(impl,
-                                  mrf_register_rf_control1,
-                                  mrf_value_recommended_rf_optimize_control1);
-  MrfIo_setControlRegister_Expect(
-    impl, mrf_register_rf_control2, mrf_value_phase_locked_loop_enabled);
-  MrfIo_setControlRegister_Expect(
-    impl,
-    mrf_register_rf_control6,
-    mrf_value_enable_tx_filter | mrf_value_20MHz_clock_recovery_less_than_1ms);
-  MrfIo_setControlRegister_Expect(
-    impl, mrf_register_rf_control7, mrf_value_use_internal_100kHz_oscillator);
-  MrfIo_setControlRegister_Expect(
-    impl, mrf_register_rf_control8, mrf_value_recommended_rf_control8);
-  MrfIo_setControlRegister_Expect(
-    impl,
-    mrf_register_sleep_clock_control1,
-    mrf_value_disable_deprecated_clkout_sleep_clock_feature |
-    mrf_value_minimum_sleep_clock_divisor_for_internal_oscillator);
-  MrfIo_setControlRegister_Expect(
-    impl,
-    mrf_register_base_band2,
-    mrf_value_clear_channel_assessment_energy_detection_only);
-  MrfIo_setControlRegister_Expect(
-    impl,
-    mrf_register_energy_detection_threshold_for_clear_channel_assessment,
-    mrf_value_recommended_energy_detection_threshold);
-  MrfIo_setControlRegister_Expect(
-    impl, mrf_register_base_band6, mrf_value_append_rssi_value_to_rxfifo);
-  MrfIo_setControlRegister_Expect(
-    impl, mrf_register_interrupt_control, mrf_value_rx_interrupt_enabled);
+    mrf_register_interrupt_control,
+    mrf_value_rx_and_tx_normal_interrupt_enabled);
 
   // select channel 11, afterwards the rf state machine should be reset
   MrfIo_setControlRegister_Expect(
@@ -185,6 +185,25 @@ setUpInitializationValues(MrfIo *impl,
   MrfIo_setControlRegister_Expect(
     impl, mrf_register_rf_control3, mrf_value_transmitter_power_0dB);
 
+  // unconfigured csma-ca parameters fall back to the recommended values
+  const MrfIo_RegisterValue channel_access_values[] = {
+    {
+      mrf_register_base_band2,
+      mrf_value_clear_channel_assessment_energy_detection_only,
+    },
+    {
+      mrf_register_energy_detection_threshold_for_clear_channel_assessment,
+      mrf_value_recommended_energy_detection_threshold,
+    },
+    {mrf_register_tx_mac_control, (3 << 3) | 4},
+  };
+  memcpy(expected_channel_access_values,
+         channel_access_values,
+         sizeof(channel_access_values));
+  MrfIo_setControlRegisters_ExpectWithArray(
+    impl, 1, expected_channel_access_values,
+    number_of_channel_access_values, number_of_channel_access_values);
+
   // here the addresses are required to be stored in ascending byte order (big
   // endian)
   MrfIo_writeBlockingToShortAddress_Expect(
@@ -213,6 +232,7 @@ test_sendBlocking(void)
 
   Mac802154_setPayload(mrf, (uint8_t *) payload, payload_length);
 
+  MrfState_setSequenceNumber_Expect(&impl->state, 0);
   uint8_t  fake_header_data[]         = "123456789";
   uint8_t  fake_header_length         = 9;
   uint8_t  fake_header_memory_address = 0;
@@ -221,7 +241,8 @@ test_sendBlocking(void)
     .length  = fake_header_length,
     .address = fake_header_memory_address,
   };
-  MrfState_getFullHeaderField_ExpectAnyArgsAndReturn(full_header);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(true);
+  MrfState_getCurrentField_ExpectAnyArgsAndReturn(full_header);
 
   MrfIo_writeBlockingToLongAddress_Expect(
     NULL, full_header.data, full_header.length, full_header.address);
@@ -232,12 +253,15 @@ test_sendBlocking(void)
     .length  = payload_length,
     .address = fake_header_length,
   };
-  MrfState_getPayloadField_ExpectAnyArgsAndReturn(payload_field);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(true);
+  MrfState_getCurrentField_ExpectAnyArgsAndReturn(payload_field);
 
   MrfIo_writeBlockingToLongAddress_Expect(
     NULL, payload_field.data, payload_field.length, payload_field.address);
   MrfIo_writeBlockingToLongAddress_IgnoreArg_mrf();
 
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+
   MrfIo_setControlRegister_Expect(
     &impl->io, mrf_register_tx_normal_fifo_control, 1);
 
@@ -251,6 +275,386 @@ test_sendBlocking(void)
   Mac802154_sendBlocking(mrf);
 }
 
+void
+test_sendBlockingWritesPayloadVectorInOneTransaction(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t header[] = "ab";
+  uint8_t data[] = "cde";
+  Mac802154PayloadSegment segments[2] = {
+    { .data = header, .length = 2 },
+    { .data = data, .length = 3 },
+  };
+  MrfState_setPayloadVector_Expect(&impl->state, segments, 2);
+  Mac802154_setPayloadVector(mrf, segments, 2);
+
+  MrfField payload_field = {
+    .data    = NULL,
+    .length  = 5,
+    .address = 11,
+    .segments = segments,
+    .number_of_segments = 2,
+  };
+  MrfState_setSequenceNumber_Expect(&impl->state, 0);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(true);
+  MrfState_getCurrentField_ExpectAnyArgsAndReturn(payload_field);
+  MrfIo_writeSegmentsBlockingToLongAddress_Expect(&impl->io, segments, 2, 11);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_tx_normal_fifo_control, mrf_value_trigger_tx_normal_fifo);
+  MrfIo_readControlRegister_ExpectAndReturn(
+    &impl->io, mrf_register_interrupt_status, mrf_value_tx_normal_interrupt);
+  Mac802154_sendBlocking(mrf);
+}
+
+void
+test_sendBlockingWithAcknowledgementRequestsAcknowledgementFromMrf(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  MrfState_enableAcknowledgement_Expect(&impl->state);
+  Mac802154_enableAcknowledgement(mrf);
+
+  MrfState_setSequenceNumber_Expect(&impl->state, 0);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_tx_normal_fifo_control,
+    mrf_value_trigger_tx_normal_fifo | mrf_value_tx_normal_acknowledgement_request);
+  MrfIo_readControlRegister_ExpectAndReturn(
+    &impl->io, mrf_register_interrupt_status, mrf_value_tx_normal_interrupt);
+  Mac802154_sendBlocking(mrf);
+}
+
+void
+test_disableAcknowledgementOnlyTriggersTransmission(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  MrfState_enableAcknowledgement_Expect(&impl->state);
+  Mac802154_enableAcknowledgement(mrf);
+  MrfState_disableAcknowledgement_Expect(&impl->state);
+  Mac802154_disableAcknowledgement(mrf);
+
+  MrfState_setSequenceNumber_Expect(&impl->state, 0);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_tx_normal_fifo_control, mrf_value_trigger_tx_normal_fifo);
+  MrfIo_readControlRegister_ExpectAndReturn(
+    &impl->io, mrf_register_interrupt_status, mrf_value_tx_normal_interrupt);
+  Mac802154_sendBlocking(mrf);
+}
+
+void
+test_sequenceNumberIsIncrementedForEveryFrame(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  for (uint16_t sequence_number = 0; sequence_number < 3; sequence_number++)
+    {
+      MrfState_setSequenceNumber_Expect(&impl->state, (uint8_t) sequence_number);
+      MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+      MrfIo_setControlRegister_Expect(
+        &impl->io, mrf_register_tx_normal_fifo_control, mrf_value_trigger_tx_normal_fifo);
+      MrfIo_readControlRegister_ExpectAndReturn(
+        &impl->io, mrf_register_interrupt_status, mrf_value_tx_normal_interrupt);
+      Mac802154_sendBlocking(mrf);
+    }
+}
+
+void
+test_getTransmissionStatusAfterSuccess(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  Mac802154TransmissionStatus status;
+  MrfIo_readControlRegister_ExpectAndReturn(&impl->io, mrf_register_tx_status, 1 << 6);
+  Mac802154_getTransmissionStatus(mrf, &status);
+  TEST_ASSERT_TRUE(status.success);
+  TEST_ASSERT_FALSE(status.channel_busy);
+  TEST_ASSERT_EQUAL_UINT8(1, status.retries);
+}
+
+void
+test_getTransmissionStatusAfterMissingAcknowledgement(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  Mac802154TransmissionStatus status;
+  MrfIo_readControlRegister_ExpectAndReturn(&impl->io, mrf_register_tx_status, (3 << 6) | 1);
+  Mac802154_getTransmissionStatus(mrf, &status);
+  TEST_ASSERT_FALSE(status.success);
+  TEST_ASSERT_FALSE(status.channel_busy);
+  TEST_ASSERT_EQUAL_UINT8(3, status.retries);
+}
+
+void
+test_getTransmissionStatusAfterChannelAccessFailure(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  Mac802154TransmissionStatus status;
+  MrfIo_readControlRegister_ExpectAndReturn(&impl->io, mrf_register_tx_status, (1 << 5) | 1);
+  Mac802154_getTransmissionStatus(mrf, &status);
+  TEST_ASSERT_FALSE(status.success);
+  TEST_ASSERT_TRUE(status.channel_busy);
+  TEST_ASSERT_EQUAL_UINT8(0, status.retries);
+}
+
+static uint8_t transmission_complete_callback_calls = 0;
+
+static void
+countTransmissionCompleteCallbackCalls(void *argument)
+{
+  uint8_t *counter = argument;
+  (*counter)++;
+}
+
+static void
+expectInterruptStatusRead(MrfIo *io, uint8_t status)
+{
+  MrfIo_interfaceIsBusy_ExpectAndReturn(io, false);
+  MrfIo_readControlRegister_ExpectAndReturn(
+    io, mrf_register_interrupt_status, status);
+}
+
+static void
+sendFrameNonBlocking(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t     header[]   = "12345";
+  uint8_t     payload[]  = "abc";
+  MrfField    header_field = {
+    .data    = header,
+    .length  = 5,
+    .address = 0,
+  };
+  MrfField    payload_field = {
+    .data    = payload,
+    .length  = 3,
+    .address = 5,
+  };
+  Mac802154Callback callback = {
+    .function = countTransmissionCompleteCallbackCalls,
+    .argument = &transmission_complete_callback_calls,
+  };
+  transmission_complete_callback_calls = 0;
+  Mac802154_setTransmissionCompleteCallback(mrf, callback);
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, MRF_IO_TRANSFER_QUEUE_SIZE - 1);
+  MrfState_setSequenceNumber_ExpectAnyArgs();
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(true);
+  MrfState_getCurrentField_ExpectAnyArgsAndReturn(header_field);
+  MrfIo_writeNonBlockingToLongAddress_ExpectAnyArgsAndReturn(true);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(true);
+  MrfState_getCurrentField_ExpectAnyArgsAndReturn(payload_field);
+  MrfIo_writeNonBlockingToLongAddress_ExpectAnyArgsAndReturn(true);
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_writeNonBlockingToShortAddress_ExpectAnyArgsAndReturn(true);
+  TEST_ASSERT_TRUE(Mac802154_sendNonBlocking(mrf));
+}
+
+void
+test_sendNonBlockingReturnsWithoutPollingTheInterruptStatus(void)
+{
+  sendFrameNonBlocking();
+  TEST_ASSERT_EQUAL_UINT8(0, transmission_complete_callback_calls);
+}
+
+void
+test_transmissionCompleteCallbackIsExecutedOnTxInterrupt(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  sendFrameNonBlocking();
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, transmission_complete_callback_calls);
+}
+
+void
+test_transmissionCompleteCallbackIsNotExecutedOnRxInterrupt(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  sendFrameNonBlocking();
+  expectInterruptStatusRead(&impl->io, mrf_value_rx_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(0, transmission_complete_callback_calls);
+}
+
+void
+test_transmissionCompleteCallbackIsExecutedOnlyOnce(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  sendFrameNonBlocking();
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, transmission_complete_callback_calls);
+}
+
+void
+test_interruptIsNotHandledWhileNonBlockingTransfersAreRunning(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  sendFrameNonBlocking();
+  MrfIo_interfaceIsBusy_ExpectAndReturn(&impl->io, true);
+  TEST_ASSERT_FALSE(Mac802154MRF_handleInterrupt(mrf));
+  TEST_ASSERT_EQUAL_UINT8(0, transmission_complete_callback_calls);
+
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(mrf));
+  TEST_ASSERT_EQUAL_UINT8(1, transmission_complete_callback_calls);
+}
+
+void
+test_sendNonBlockingFailsIfTransfersDoNotFitIntoQueue(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, 3);
+  TEST_ASSERT_FALSE(Mac802154_sendNonBlocking(mrf));
+  TEST_ASSERT_FALSE(impl->transmission_in_progress);
+}
+
+void
+test_frameIsWrittenCompletelyAfterQueueingTheTriggerFailed(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, MRF_IO_TRANSFER_QUEUE_SIZE - 1);
+  MrfState_setSequenceNumber_ExpectAnyArgs();
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_writeNonBlockingToShortAddress_ExpectAnyArgsAndReturn(false);
+  MrfState_markAllFieldsAsChanged_Expect(&impl->state);
+  TEST_ASSERT_FALSE(Mac802154_sendNonBlocking(mrf));
+  TEST_ASSERT_FALSE(impl->transmission_in_progress);
+}
+
+static Mac802154Frame
+createFrame(const uint8_t *payload, uint8_t payload_length)
+{
+  Mac802154Frame frame = {
+    .destination_address = {0xAB, 0xCD},
+    .destination_address_size = 2,
+    .payload = payload,
+    .payload_length = payload_length,
+  };
+  return frame;
+}
+
+static void
+expectQueuedFrameTransmitted(Mrf *impl, const Mac802154Frame *frame)
+{
+  FrameHeader802154_getDestinationAddressSize_ExpectAnyArgsAndReturn(0);
+  MrfState_setShortDestinationAddress_Expect(&impl->state, NULL);
+  MrfState_setShortDestinationAddress_IgnoreArg_address();
+  MrfState_setPayload_Expect(&impl->state, frame->payload, frame->payload_length);
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, MRF_IO_TRANSFER_QUEUE_SIZE - 1);
+  MrfState_setSequenceNumber_ExpectAnyArgs();
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_writeNonBlockingToShortAddress_ExpectAnyArgsAndReturn(true);
+}
+
+void
+test_enqueueFrameStartsTransmissionIfQueueIsEmpty(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  expectQueuedFrameTransmitted(impl, &frame);
+  TEST_ASSERT_TRUE(Mac802154_enqueueFrame(mrf, &frame));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfFramesToSend(mrf));
+}
+
+void
+test_enqueueFrameWithExtendedDestinationAddress(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  frame.destination_address_size = 8;
+  FrameHeader802154_getDestinationAddressSize_ExpectAnyArgsAndReturn(2);
+  MrfState_setExtendedDestinationAddress_Expect(&impl->state, NULL);
+  MrfState_setExtendedDestinationAddress_IgnoreArg_address();
+  MrfState_setPayload_Expect(&impl->state, payload, 3);
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, MRF_IO_TRANSFER_QUEUE_SIZE - 1);
+  MrfState_setSequenceNumber_ExpectAnyArgs();
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_writeNonBlockingToShortAddress_ExpectAnyArgsAndReturn(true);
+  Mac802154_enqueueFrame(mrf, &frame);
+}
+
+void
+test_destinationAddressIsKeptForFramesToSameDestination(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  FrameHeader802154_getDestinationAddressSize_ExpectAnyArgsAndReturn(2);
+  FrameHeader802154_getDestinationAddressPtr_ExpectAnyArgsAndReturn(frame.destination_address);
+  MrfState_setPayload_Expect(&impl->state, payload, 3);
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, MRF_IO_TRANSFER_QUEUE_SIZE - 1);
+  MrfState_setSequenceNumber_ExpectAnyArgs();
+  MrfState_moveIteratorToNextField_ExpectAnyArgsAndReturn(false);
+  MrfIo_writeNonBlockingToShortAddress_ExpectAnyArgsAndReturn(true);
+  Mac802154_enqueueFrame(mrf, &frame);
+}
+
+void
+test_enqueueFrameWhileTransmittingOnlyQueuesFrame(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  expectQueuedFrameTransmitted(impl, &frame);
+  Mac802154_enqueueFrame(mrf, &frame);
+  TEST_ASSERT_TRUE(Mac802154_enqueueFrame(mrf, &frame));
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154_getNumberOfFramesToSend(mrf));
+}
+
+void
+test_enqueueFrameFailsIfQueueIsFull(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  expectQueuedFrameTransmitted(impl, &frame);
+  for (uint8_t i = 0; i < MRF_TX_QUEUE_SIZE; i++)
+    {
+      TEST_ASSERT_TRUE(Mac802154_enqueueFrame(mrf, &frame));
+    }
+  TEST_ASSERT_FALSE(Mac802154_enqueueFrame(mrf, &frame));
+  TEST_ASSERT_EQUAL_UINT8(MRF_TX_QUEUE_SIZE, Mac802154_getNumberOfFramesToSend(mrf));
+}
+
+void
+test_enqueueFrameFailsIfTransfersDoNotFitIntoQueue(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t payload[] = "abc";
+  Mac802154Frame frame = createFrame(payload, 3);
+  FrameHeader802154_getDestinationAddressSize_ExpectAnyArgsAndReturn(0);
+  MrfState_setShortDestinationAddress_Expect(&impl->state, NULL);
+  MrfState_setShortDestinationAddress_IgnoreArg_address();
+  MrfState_setPayload_Expect(&impl->state, payload, 3);
+  MrfIo_getNumberOfFreeTransfers_ExpectAndReturn(&impl->io, 0);
+  TEST_ASSERT_FALSE(Mac802154_enqueueFrame(mrf, &frame));
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfFramesToSend(mrf));
+}
+
+void
+test_nextQueuedFrameIsTransmittedOnTransmissionComplete(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  uint8_t first_payload[] = "abc";
+  uint8_t second_payload[] = "defg";
+  Mac802154Frame first = createFrame(first_payload, 3);
+  Mac802154Frame second = createFrame(second_payload, 4);
+  expectQueuedFrameTransmitted(impl, &first);
+  Mac802154_enqueueFrame(mrf, &first);
+  Mac802154_enqueueFrame(mrf, &second);
+
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  expectQueuedFrameTransmitted(impl, &second);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfFramesToSend(mrf));
+
+  expectInterruptStatusRead(&impl->io, mrf_value_tx_normal_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfFramesToSend(mrf));
+}
+
 void
 test_getMessageSizeMessage(void)
 {
@@ -445,6 +849,196 @@ test_getPacketPayloadSize(void)
                           Mac802154_getPacketPayloadSize(mrf, packet));
 }
 
+void
+test_parsePacketStoresOffsetsOfAllFields(void)
+{
+  uint8_t packet[] = { 14, 0x41, 0xA8, 0x07, 0x34, 0x12, 0x02, 0x00,
+                       0x01, 0x00, 0xAA, 0xBB, 0xCC, 0xF1, 0xF2, 0x80, 0x42 };
+  const FrameHeader802154 *header = (const FrameHeader802154 *) (packet + 1);
+  FrameHeader802154_getSequenceNumberSize_ExpectAndReturn(header, 1);
+  FrameHeader802154_getPanIdSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getDestinationAddressSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getSourceAddressSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getFrameType_ExpectAndReturn(header, FRAME_TYPE_DATA);
+  Mac802154FrameView view;
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(mrf, packet, sizeof(packet), &view));
+  TEST_ASSERT_EQUAL_UINT8(FRAME_TYPE_DATA, Mac802154FrameView_getFrameType(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 3, Mac802154FrameView_getSequenceNumber(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 4, Mac802154FrameView_getPanId(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 6, Mac802154FrameView_getDestinationAddress(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 8, Mac802154FrameView_getSourceAddress(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 10, Mac802154FrameView_getPayload(&view));
+  TEST_ASSERT_EQUAL_UINT8(3, Mac802154FrameView_getPayloadSize(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 13, Mac802154FrameView_getFrameCheckSequence(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 15, Mac802154FrameView_getLinkQuality(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 16, Mac802154FrameView_getRssi(&view));
+}
+
+void
+test_parsePacketWithoutLinkQualityAndRssi(void)
+{
+  uint8_t packet[] = { 10, 0x41, 0xB8, 0x34, 0x12, 0x02, 0x00, 0x01, 0x00, 0xF1, 0xF2 };
+  const FrameHeader802154 *header = (const FrameHeader802154 *) (packet + 1);
+  FrameHeader802154_getSequenceNumberSize_ExpectAndReturn(header, 0);
+  FrameHeader802154_getPanIdSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getDestinationAddressSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getSourceAddressSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getFrameType_ExpectAndReturn(header, FRAME_TYPE_DATA);
+  Mac802154FrameView view;
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(mrf, packet, sizeof(packet), &view));
+  TEST_ASSERT_NULL(Mac802154FrameView_getSequenceNumber(&view));
+  TEST_ASSERT_EQUAL_PTR(packet + 3, Mac802154FrameView_getPanId(&view));
+  TEST_ASSERT_NULL(Mac802154FrameView_getPayload(&view));
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154FrameView_getPayloadSize(&view));
+  TEST_ASSERT_NULL(Mac802154FrameView_getLinkQuality(&view));
+  TEST_ASSERT_NULL(Mac802154FrameView_getRssi(&view));
+}
+
+void
+test_parsePacketFailsForTruncatedPacket(void)
+{
+  uint8_t packet[] = { 20, 0x41, 0xA8, 0x07 };
+  Mac802154FrameView view;
+  TEST_ASSERT_FALSE(Mac802154_parsePacket(mrf, packet, sizeof(packet), &view));
+}
+
+void
+test_parsePacketFailsIfHeaderIsLongerThanFrame(void)
+{
+  uint8_t packet[] = { 6, 0x41, 0xEC, 0x07, 0x34, 0x12, 0xF1, 0xF2 };
+  const FrameHeader802154 *header = (const FrameHeader802154 *) (packet + 1);
+  FrameHeader802154_getSequenceNumberSize_ExpectAndReturn(header, 1);
+  FrameHeader802154_getPanIdSize_ExpectAndReturn(header, 2);
+  FrameHeader802154_getDestinationAddressSize_ExpectAndReturn(header, 8);
+  FrameHeader802154_getSourceAddressSize_ExpectAndReturn(header, 8);
+  FrameHeader802154_getFrameType_ExpectAndReturn(header, FRAME_TYPE_DATA);
+  Mac802154FrameView view;
+  TEST_ASSERT_FALSE(Mac802154_parsePacket(mrf, packet, sizeof(packet), &view));
+}
+
+static void
+expectSetChannel(MrfIo *io, uint8_t channel)
+{
+  MrfIo_setControlRegister_Expect(
+    io, mrf_register_rf_control0, MRF_getRegisterValueForChannelNumber(channel));
+  MrfIo_setControlRegister_Expect(
+    io, mrf_register_rf_mode_control, mrf_value_rf_state_machine_reset_state);
+  MrfIo_setControlRegister_Expect(
+    io, mrf_register_rf_mode_control, mrf_value_rf_state_machine_operating_state);
+  fakeDelay_Expect(mrf_value_delay_interval_after_state_machine_reset);
+}
+
+static void
+expectEnergyMeasurement(MrfIo *io, uint8_t energy)
+{
+  MrfIo_setControlRegister_Expect(
+    io, mrf_register_base_band6,
+    mrf_value_initiate_rssi_measurement | mrf_value_append_rssi_value_to_rxfifo);
+  MrfIo_readControlRegister_ExpectAndReturn(io, mrf_register_base_band6, 0);
+  MrfIo_readControlRegister_ExpectAndReturn(
+    io, mrf_register_base_band6, mrf_value_rssi_ready);
+  MrfIo_readControlRegister_ExpectAndReturn(io, mrf_register_rssi, energy);
+}
+
+void
+test_scanEnergyKeepsHighestSamplePerChannel(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  MrfIo      *io   = &impl->io;
+  uint8_t     energy[MAC802154_NUMBER_OF_CHANNELS];
+  impl->config.channel = 13;
+  expectDisableReception(io);
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_CHANNELS; i++)
+    {
+      expectSetChannel(io, (uint8_t) (MAC802154_FIRST_CHANNEL + i));
+      expectEnergyMeasurement(io, i);
+      expectEnergyMeasurement(io, (uint8_t) (2 * i));
+    }
+  expectSetChannel(io, 13);
+  expectEnableReception(io);
+  Mac802154_scanEnergy(mrf, 2, energy);
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_CHANNELS; i++)
+    {
+      TEST_ASSERT_EQUAL_UINT8(2 * i, energy[i]);
+    }
+}
+
+void
+test_getQuietestChannelPrefersLowestChannel(void)
+{
+  uint8_t energy[MAC802154_NUMBER_OF_CHANNELS];
+  BitManipulation_fillArray(energy, 0x50, MAC802154_NUMBER_OF_CHANNELS);
+  energy[3] = 0x10;
+  energy[9] = 0x10;
+  TEST_ASSERT_EQUAL_UINT8(MAC802154_FIRST_CHANNEL + 3, Mac802154_getQuietestChannel(energy));
+}
+
+void
+test_sleepEnablesImmediateWakeUpAndEntersSleep(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  // the expectation is checked after we returned, so keep it alive
+  static const MrfIo_RegisterValue sleep_sequence[] = {
+    {mrf_register_wake_control, mrf_value_immediate_wake_up_enabled},
+    {mrf_register_software_reset, mrf_value_power_management_reset},
+    {mrf_register_sleep_acknowledgement, mrf_value_sleep},
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, sleep_sequence, 3, 3);
+  Mac802154_sleep(mrf);
+}
+
+void
+test_wakeUpResetsOnlyTheRFStateMachine(void)
+{
+  struct Mrf *impl = (struct Mrf *) mrf;
+  static const MrfIo_RegisterValue wake_up_sequence[] = {
+    {
+      mrf_register_wake_control,
+      mrf_value_immediate_wake_up_enabled | mrf_value_register_wake_up,
+    },
+    {mrf_register_wake_control, mrf_value_immediate_wake_up_enabled},
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, wake_up_sequence, 2, 2);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_rf_mode_control, mrf_value_rf_state_machine_reset_state);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_rf_mode_control, mrf_value_rf_state_machine_operating_state);
+  fakeDelay_Expect(mrf_value_delay_interval_after_state_machine_reset);
+  fakeDelay_Expect(mrf_value_delay_interval_for_oscillator_after_wake_up);
+  Mac802154_wakeUp(mrf);
+}
+
+void
+test_setTransmitterPowerWritesLargeAndSmallScaleSteps(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  // -10dB large scale and -0.5dB small scale
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_rf_control3, (1 << 6) | (1 << 3));
+  Mac802154MRF_setTransmitterPower(mrf, MRF_TRANSMITTER_POWER_MINUS_10DB + 1);
+  TEST_ASSERT_EQUAL_UINT8(9, Mac802154MRF_getTransmitterPower(mrf));
+}
+
+void
+test_setTransmitterPowerLimitsToLowestLevel(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  MrfIo_setControlRegister_Expect(&impl->io, mrf_register_rf_control3, 0xF8);
+  Mac802154MRF_setTransmitterPower(mrf, 200);
+}
+
+void
+test_adaptTransmitterPowerOnlyWritesIfLevelChanges(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  MrfIo_setControlRegister_Expect(&impl->io, mrf_register_rf_control3, 1 << 3);
+  Mac802154MRF_adaptTransmitterPower(mrf, 0xFF);
+  Mac802154MRF_adaptTransmitterPower(mrf, MRF_ADAPTIVE_POWER_RAISE_THRESHOLD);
+  MrfIo_setControlRegister_Expect(
+    &impl->io, mrf_register_rf_control3, mrf_value_transmitter_power_0dB);
+  Mac802154MRF_adaptTransmitterPower(mrf, 0);
+}
+
 void
 test_enablePromiscuousMode(void)
 {
@@ -463,6 +1057,201 @@ test_disablePromiscuousMode(void)
   Mac802154_disablePromiscuousMode(mrf);
 }
 
+void
+test_setFrameTypeChangesHeaderOfFollowingFrames(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  MrfState_setFrameType_Expect(&impl->state, FRAME_TYPE_MAC_COMMAND);
+  Mac802154_setFrameType(mrf, FRAME_TYPE_MAC_COMMAND);
+}
+
+void
+test_singleFrameTypeIsFilteredByHardware(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  static const MrfIo_RegisterValue filter_registers[] = {
+    {mrf_register_receive_mac_control, 0},
+    {mrf_register_rx_flush, mrf_value_receive_data_frames_only},
+  };
+  Mac802154ReceiveFilter filter = {
+    .frame_types = MAC802154_RECEIVE_DATA_FRAMES,
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, filter_registers, 2, 2);
+  Mac802154_setReceiveFilter(mrf, &filter);
+}
+
+void
+test_corruptedFramesAreAcceptedInPromiscuousMode(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  static const MrfIo_RegisterValue filter_registers[] = {
+    {mrf_register_receive_mac_control, mrf_value_accept_error_frames},
+    {mrf_register_rx_flush, 0},
+  };
+  Mac802154ReceiveFilter filter = {
+    .frame_types = MAC802154_RECEIVE_DATA_FRAMES | MAC802154_RECEIVE_MAC_COMMAND_FRAMES,
+    .accept_corrupted_frames = true,
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, filter_registers, 2, 2);
+  Mac802154_setReceiveFilter(mrf, &filter);
+  MrfIo_setControlRegister_Expect(&impl->io, mrf_register_receive_mac_control,
+                                  mrf_value_accept_error_frames | mrf_value_promiscuous_mode);
+  Mac802154_enablePromiscuousMode(mrf);
+}
+
+void
+test_coordinatorWritesBeaconFifoBeforeStartingSuperframe(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  mac_config.pan_id[0] = 0x34;
+  mac_config.pan_id[1] = 0x12;
+  mac_config.short_source_address[0] = 0x01;
+  impl->config = mac_config;
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 13,
+    .pan_coordinator = true,
+    .number_of_guaranteed_time_slots = 1,
+    .guaranteed_time_slots = {
+      {.short_address = {0x02, 0x00}, .starting_slot = 14, .length = 2},
+    },
+  };
+  static const uint8_t beacon_fifo[] = {
+    7, 15, 0x00, 0x80, 0x00, 0x34, 0x12, 0x01, 0x00,
+    0x46, 0x4D, 0x01, 0x00, 0x02, 0x00, 0x2E, 0x00,
+  };
+  static const MrfIo_RegisterValue superframe_registers[] = {
+    {mrf_register_tx_mac_control, (3 << 3) | 4 | mrf_value_slotted_mode},
+    {mrf_register_end_slot_of_cap_and_gts1, 0xFD},
+    {mrf_register_end_slot_of_gts2_and_gts3, 0xFF},
+    {mrf_register_end_slot_of_gts4_and_gts5, 0xFF},
+    {mrf_register_end_slot_of_gts6_and_gts7, 0xFF},
+    {mrf_register_beacon_and_superframe_order, 0x64},
+  };
+  MrfIo_setControlRegister_Expect(&impl->io, mrf_register_receive_mac_control,
+                                  mrf_value_pan_coordinator);
+  MrfIo_writeBlockingToLongAddress_ExpectWithArray(&impl->io, 1, beacon_fifo, sizeof(beacon_fifo),
+                                                   sizeof(beacon_fifo), mrf_beacon_fifo_start);
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, superframe_registers, 6, 6);
+  TEST_ASSERT_TRUE(Mac802154MRF_startBeaconEnabledPan(mrf, &beacon));
+}
+
+void
+test_beaconSequenceNumberIsIndependentOfDataFrames(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  impl->config = mac_config;
+  impl->sequence_number = 0x20;
+  impl->beacon_sequence_number = 0x05;
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 15,
+  };
+  static const uint8_t beacon_fifo[] = {
+    7, 11, 0x00, 0x80, 0x05, 0x00, 0x00, 0x00, 0x00,
+    0x46, 0x0F, 0x00, 0x00,
+  };
+  MrfIo_setControlRegister_Ignore();
+  MrfIo_writeBlockingToLongAddress_ExpectWithArray(&impl->io, 1, beacon_fifo, sizeof(beacon_fifo),
+                                                   sizeof(beacon_fifo), mrf_beacon_fifo_start);
+  MrfIo_setControlRegisters_Ignore();
+  TEST_ASSERT_TRUE(Mac802154MRF_startBeaconEnabledPan(mrf, &beacon));
+  TEST_ASSERT_EQUAL_UINT8(0x20, impl->sequence_number);
+  TEST_ASSERT_EQUAL_UINT8(0x06, impl->beacon_sequence_number);
+}
+
+void
+test_startBeaconEnabledPanFailsIfBeaconExceedsFrameSize(void)
+{
+  static const uint8_t payload[115] = {0};
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 15,
+    .payload = payload,
+    .payload_size = sizeof(payload),
+  };
+  TEST_ASSERT_FALSE(Mac802154MRF_startBeaconEnabledPan(mrf, &beacon));
+  TEST_ASSERT_FALSE(((Mrf *) mrf)->pan_coordinator);
+}
+
+void
+test_deviceSendsInItsGuaranteedTimeSlot(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  mac_config.short_source_address[0] = 0x02;
+  impl->config = mac_config;
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 11,
+    .number_of_guaranteed_time_slots = 3,
+    .guaranteed_time_slots = {
+      {.short_address = {0x02, 0x00}, .starting_slot = 14, .length = 2},
+      {.short_address = {0x02, 0x00}, .starting_slot = 13, .length = 1, .receive = true},
+      {.short_address = {0x05, 0x00}, .starting_slot = 12, .length = 1},
+    },
+  };
+  // the own slot for sending is the third one in the superframe
+  static const MrfIo_RegisterValue superframe_registers[] = {
+    {mrf_register_tx_mac_control, (3 << 3) | 4 | mrf_value_slotted_mode},
+    {mrf_register_end_slot_of_cap_and_gts1, 0xCB},
+    {mrf_register_end_slot_of_gts2_and_gts3, 0xFD},
+    {mrf_register_end_slot_of_gts4_and_gts5, 0xFF},
+    {mrf_register_end_slot_of_gts6_and_gts7, 0xFF},
+    {mrf_register_beacon_and_superframe_order, 0x64},
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, superframe_registers, 6, 6);
+  TEST_ASSERT_TRUE(Mac802154MRF_joinBeaconEnabledPan(mrf, &beacon));
+
+  const uint8_t header_data[] = {9, 12, 0x41, 0x88, 0x00, 0x34, 0x12, 0x01, 0x00, 0x02, 0x00};
+  const uint8_t payload[] = "abc";
+  MrfField header_field = {
+    .data = header_data,
+    .length = sizeof(header_data),
+    .address = 0,
+  };
+  MrfField payload_field = {
+    .data = payload,
+    .length = 3,
+    .address = sizeof(header_data),
+  };
+  MrfState_setSequenceNumber_Expect(&impl->state, 0);
+  MrfState_getFullHeaderField_ExpectAndReturn(&impl->state, header_field);
+  MrfIo_writeBlockingToLongAddress_Expect(&impl->io, header_data, sizeof(header_data),
+                                          mrf_tx_gts1_fifo_start);
+  MrfState_getPayloadField_ExpectAndReturn(&impl->state, payload_field);
+  MrfIo_writeBlockingToLongAddress_Expect(&impl->io, payload, 3,
+                                          mrf_tx_gts1_fifo_start + sizeof(header_data));
+  MrfIo_setControlRegister_Expect(&impl->io, mrf_register_tx_gts1_fifo_control,
+                                  (3 << mrf_value_tx_gts_slot_offset) | mrf_value_trigger_tx_gts_fifo);
+  TEST_ASSERT_TRUE(Mac802154MRF_sendInGuaranteedTimeSlot(mrf));
+}
+
+void
+test_sendingInGuaranteedTimeSlotFailsWithoutSlot(void)
+{
+  TEST_ASSERT_FALSE(Mac802154MRF_sendInGuaranteedTimeSlot(mrf));
+}
+
+void
+test_leavingBeaconEnabledPanRestoresUnslottedMode(void)
+{
+  Mrf *impl = (Mrf *) mrf;
+  impl->config = mac_config;
+  impl->pan_coordinator = true;
+  impl->slotted_mode = true;
+  static const MrfIo_RegisterValue nonbeacon_enabled_registers[] = {
+    {mrf_register_beacon_and_superframe_order, 0xFF},
+    {mrf_register_receive_mac_control, 0},
+    {mrf_register_tx_mac_control, (3 << 3) | 4},
+  };
+  MrfIo_setControlRegisters_ExpectWithArray(&impl->io, 1, nonbeacon_enabled_registers, 3, 3);
+  Mac802154MRF_leaveBeaconEnabledPan(mrf);
+}
+
 void
 test_useExtendedSourceAddress(void)
 {
@@ -499,3 +1288,172 @@ test_useShortSourceAddress(void)
                                         mac_config.short_source_address);
   Mac802154_useShortSourceAddress(mrf);
 }
+
+static void
+expectPacketRead(MrfIo *io, uint8_t *frame, uint8_t frame_length)
+{
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t packet_size = (uint8_t) (frame_length + 3);
+  packet[0] = frame_length;
+  memcpy(packet + 1, frame, frame_length + 2);
+  expectInterruptStatusRead(io, mrf_value_rx_interrupt);
+  expectDisableReception(io);
+  MrfIo_readRxFifoBlocking_ExpectAndReturn(
+    io, NULL, MAC802154_MAXIMUM_PACKET_SIZE, packet_size);
+  MrfIo_readRxFifoBlocking_IgnoreArg_buffer();
+  MrfIo_readRxFifoBlocking_ReturnArrayThruPtr_buffer(packet, packet_size);
+  expectEnableReception(io);
+}
+
+static void
+expectPacketMovedToQueue(MrfIo *io, uint8_t *frame, uint8_t frame_length)
+{
+  expectPacketRead(io, frame, frame_length);
+  FrameHeader802154_getSourceAddressSize_ExpectAnyArgsAndReturn(0);
+}
+
+void
+test_rxInterruptMovesPacketToQueue(void)
+{
+  MrfIo  *io      = &((struct Mrf *) mrf)->io;
+  uint8_t frame[] = { 0x41, 0xA8, 0x01, 0x02, 0x03, 0xEE, 0x12 };
+  uint8_t frame_length = 5;
+  expectPacketMovedToQueue(io, frame, frame_length);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(mrf));
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t size = Mac802154_dequeuePacket(mrf, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(frame_length + 3, size);
+  TEST_ASSERT_EQUAL_UINT8(frame_length, packet[0]);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(frame, packet + 1, frame_length + 2);
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfQueuedPackets(mrf));
+}
+
+void
+test_dequeueFromEmptyQueueReturnsZero(void)
+{
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_dequeuePacket(mrf, packet, sizeof(packet)));
+}
+
+void
+test_packetsAreDequeuedInOrderOfReception(void)
+{
+  MrfIo  *io           = &((struct Mrf *) mrf)->io;
+  uint8_t first[]      = { 1, 1, 1, 1, 1 };
+  uint8_t second[]     = { 2, 2, 2, 2, 2, 2 };
+  expectPacketMovedToQueue(io, first, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  expectPacketMovedToQueue(io, second, 4);
+  Mac802154MRF_handleInterrupt(mrf);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_dequeuePacket(mrf, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(3, packet[0]);
+  Mac802154_dequeuePacket(mrf, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(4, packet[0]);
+}
+
+void
+test_packetStaysInMrfWhenQueueIsFull(void)
+{
+  MrfIo  *io      = &((struct Mrf *) mrf)->io;
+  uint8_t frame[] = { 1, 2, 3, 4, 5 };
+  for (uint8_t i = 0; i < MRF_RX_QUEUE_SIZE; i++)
+    {
+      expectPacketMovedToQueue(io, frame, 3);
+      Mac802154MRF_handleInterrupt(mrf);
+    }
+  expectInterruptStatusRead(io, mrf_value_rx_interrupt);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(MRF_RX_QUEUE_SIZE,
+                          Mac802154_getNumberOfQueuedPackets(mrf));
+  MrfIo_readControlRegister_ExpectAndReturn(io, mrf_register_interrupt_status, 0);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(mrf));
+}
+
+static void
+expectPacketWithSequenceNumberRead(MrfIo *io, uint8_t *frame, uint8_t frame_length)
+{
+  static uint8_t source_address[] = { 0x11, 0x22 };
+  expectPacketRead(io, frame, frame_length);
+  FrameHeader802154_getSourceAddressSize_ExpectAnyArgsAndReturn(2);
+  FrameHeader802154_getSourceAddressPtr_ExpectAnyArgsAndReturn(source_address);
+  FrameHeader802154_getSequenceNumberSize_ExpectAnyArgsAndReturn(1);
+  FrameHeader802154_getSequenceNumberPtr_ExpectAnyArgsAndReturn(frame + 2);
+}
+
+void
+test_retransmittedPacketIsDiscarded(void)
+{
+  MrfIo  *io      = &((struct Mrf *) mrf)->io;
+  uint8_t frame[] = { 0x41, 0x88, 0x07, 0xEE, 0x12 };
+  expectPacketWithSequenceNumberRead(io, frame, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  expectPacketWithSequenceNumberRead(io, frame, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(mrf));
+}
+
+void
+test_packetWithNewSequenceNumberIsQueued(void)
+{
+  MrfIo  *io      = &((struct Mrf *) mrf)->io;
+  uint8_t first[]  = { 0x41, 0x88, 0x07, 0xEE, 0x12 };
+  uint8_t second[] = { 0x41, 0x88, 0x08, 0xEE, 0x12 };
+  expectPacketWithSequenceNumberRead(io, first, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  expectPacketWithSequenceNumberRead(io, second, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154_getNumberOfQueuedPackets(mrf));
+}
+
+void
+test_linkQualityOfReceivedPacketIsAddedToNeighborTable(void)
+{
+  MrfIo  *io      = &((struct Mrf *) mrf)->io;
+  uint8_t frame[] = { 0x41, 0x88, 0x07, 0xA0, 0x30 };
+  uint8_t source_address[] = { 0x11, 0x22 };
+  Mac802154LinkQuality quality;
+  TEST_ASSERT_FALSE(Mac802154_getNeighborLinkQuality(mrf, source_address, 2, &quality));
+  expectPacketWithSequenceNumberRead(io, frame, 3);
+  Mac802154MRF_handleInterrupt(mrf);
+  TEST_ASSERT_TRUE(Mac802154_getNeighborLinkQuality(mrf, source_address, 2, &quality));
+  TEST_ASSERT_EQUAL_UINT8(0xA0, quality.link_quality);
+  TEST_ASSERT_EQUAL_UINT8(0x30, quality.rssi);
+  TEST_ASSERT_EQUAL_UINT8(1, quality.number_of_frames);
+}
+
+void
+test_getPacketLinkQualityAndRssi(void)
+{
+  uint8_t packet[] = { 4, 0x41, 0xA8, 0xFF, 0xC0, 0xB5, 0x42 };
+  TEST_ASSERT_EQUAL_HEX8(0xB5, Mac802154_getPacketLinkQuality(mrf, packet));
+  TEST_ASSERT_EQUAL_HEX8(0x42, Mac802154_getPacketRssi(mrf, packet));
+}
+
+void
+test_fetchCompletePacketBlockingReadsRxFifoInOneTransaction(void)
+{
+  MrfIo  *io       = &((struct Mrf *) mrf)->io;
+  uint8_t packet[] = { 4, 0x41, 0xA8, 0x11, 0x22, 0xFF, 0xC0 };
+  MrfIo_readRxFifoBlocking_ExpectAndReturn(
+    io, NULL, MAC802154_MAXIMUM_PACKET_SIZE, sizeof(packet));
+  MrfIo_readRxFifoBlocking_IgnoreArg_buffer();
+  MrfIo_readRxFifoBlocking_ReturnArrayThruPtr_buffer(packet, sizeof(packet));
+
+  uint8_t buffer[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t size = Mac802154_fetchCompletePacketBlocking(mrf, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_UINT8(sizeof(packet), size);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(packet, buffer, sizeof(packet));
+}
+
+void
+test_getBusStatisticsIsForwardedToIo(void)
+{
+  MrfIo *io = &((struct Mrf *) mrf)->io;
+  Mac802154BusStatistics statistics;
+  MrfIo_getStatistics_Expect(io, &statistics);
+  Mac802154_getBusStatistics(mrf, &statistics);
+}
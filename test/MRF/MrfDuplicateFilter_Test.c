@@ -0,0 +1,50 @@
+#include "unity.h"
+#include "src/Mac802154/MRF/MrfDuplicateFilter.h"
+
+static MrfDuplicateFilter filter;
+static const uint8_t short_address[2] = {0x11, 0x22};
+static const uint8_t extended_address[8] = {0x11, 0x22, 0, 0, 0, 0, 0, 0};
+
+void debug(const uint8_t *message) {}
+
+void setUp(void) {
+  MrfDuplicateFilter_init(&filter);
+}
+
+void test_firstFrameIsNoDuplicate(void) {
+  TEST_ASSERT_FALSE(MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5));
+}
+
+void test_sameSequenceNumberFromSameSenderIsDuplicate(void) {
+  MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5);
+  TEST_ASSERT_TRUE(MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5));
+}
+
+void test_nextSequenceNumberIsNoDuplicate(void) {
+  MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5);
+  TEST_ASSERT_FALSE(MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 6));
+  TEST_ASSERT_TRUE(MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 6));
+}
+
+void test_sameSequenceNumberFromOtherSenderIsNoDuplicate(void) {
+  uint8_t other_address[2] = {0x11, 0x23};
+  MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5);
+  TEST_ASSERT_FALSE(MrfDuplicateFilter_isDuplicate(&filter, other_address, 2, 5));
+}
+
+void test_shortAndExtendedAddressAreDifferentSenders(void) {
+  MrfDuplicateFilter_isDuplicate(&filter, short_address, 2, 5);
+  TEST_ASSERT_FALSE(MrfDuplicateFilter_isDuplicate(&filter, extended_address, 8, 5));
+}
+
+void test_oldestSenderIsForgottenWhenTableIsFull(void) {
+  uint8_t address[2] = {0, 0};
+  for (uint8_t i = 0; i <= MRF_DUPLICATE_FILTER_SIZE; i++) {
+    address[0] = i;
+    MrfDuplicateFilter_isDuplicate(&filter, address, 2, 5);
+  }
+  address[0] = MRF_DUPLICATE_FILTER_SIZE;
+  TEST_ASSERT_TRUE(MrfDuplicateFilter_isDuplicate(&filter, address, 2, 5));
+  address[0] = 0;
+  TEST_ASSERT_FALSE(MrfDuplicateFilter_isDuplicate(&filter, address, 2, 5));
+}
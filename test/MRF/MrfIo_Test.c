@@ -7,7 +7,7 @@
 void debug(const uint8_t *message) {}
 
 void test_writeBlockingToLongAddress(void) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   uint8_t size = 2;
   uint8_t payload[size];
   uint16_t address = 19;
@@ -20,26 +20,90 @@ void test_writeBlockingToLongAddress(void) {
   MrfIo_writeBlockingToLongAddress(&mrf, payload, size, address);
 }
 
+void test_writeSegmentsBlockingToLongAddressUsesOneTransaction(void) {
+  MrfIo mrf = {0};
+  uint8_t header[2] = {1, 2};
+  uint8_t data[3] = {3, 4, 5};
+  Mac802154PayloadSegment segments[3] = {
+          {.data = header, .length = 2},
+          {.data = NULL, .length = 0},
+          {.data = data, .length = 3},
+  };
+  uint16_t address = 19;
+  uint8_t command[2] = {MRF_writeLongCommandFirstByte(address),
+                        MRF_writeLongCommandSecondByte(address)};
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, command, 2, 2);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, header, 2, 2);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, data, 3, 3);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_writeSegmentsBlockingToLongAddress(&mrf, segments, 3, address);
+}
+
 void test_writeBlockingToShortAddress(void) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   uint8_t size = 5;
   uint8_t address = 1;
   uint8_t payload[5] = {0,1,2,3,4};
-  uint8_t commands[size];
+  uint8_t transactions[size][2];
   for (uint8_t i=0; i<size; i++) {
-    commands[i] = MRF_writeShortCommand(address+i);
+    transactions[i][0] = MRF_writeShortCommand(address+i);
+    transactions[i][1] = payload[i];
   }
   for (uint8_t i=0; i<size; i++) {
     PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
-    PeripheralInterface_writeBlocking_Expect(mrf.interface, commands+i, 1);
-    PeripheralInterface_writeBlocking_Expect(mrf.interface, payload+i, 1);
+    PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, transactions[i], 2, 2);
     PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
   }
   MrfIo_writeBlockingToShortAddress(&mrf, payload, size, address);
 }
 
+void test_setControlRegistersWritesShortRegistersInSeparateTransactions(void) {
+  MrfIo mrf = {0};
+  MrfIo_RegisterValue registers[] = {
+          {mrf_register_tx_stabilization, 0x95},
+          {mrf_register_base_band2, 0x80},
+  };
+  uint8_t first_transaction[] = {MRF_writeShortCommand(mrf_register_tx_stabilization), 0x95};
+  uint8_t second_transaction[] = {MRF_writeShortCommand(mrf_register_base_band2), 0x80};
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, first_transaction, 2, 2);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, second_transaction, 2, 2);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_setControlRegisters(&mrf, registers, 2);
+}
+
+void test_setControlRegistersWritesConsecutiveLongRegistersInOneTransaction(void) {
+  MrfIo mrf = {0};
+  MrfIo_RegisterValue registers[] = {
+          {mrf_register_rf_control0, 0x03},
+          {mrf_register_rf_control1, 0x01},
+          {mrf_register_rf_control2, 0x80},
+          {mrf_register_rf_control6, 0x90},
+  };
+  uint8_t first_transaction[] = {
+          MRF_writeLongCommandFirstByte(mrf_register_rf_control0),
+          MRF_writeLongCommandSecondByte(mrf_register_rf_control0),
+          0x03, 0x01, 0x80,
+  };
+  uint8_t second_transaction[] = {
+          MRF_writeLongCommandFirstByte(mrf_register_rf_control6),
+          MRF_writeLongCommandSecondByte(mrf_register_rf_control6),
+          0x90,
+  };
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, first_transaction, 5, 5);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, second_transaction, 3, 3);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_setControlRegisters(&mrf, registers, 4);
+}
+
 void check_setControlRegister(uint16_t register_address, const uint8_t *command, uint8_t command_length) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
   PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, command, command_length, command_length);
   uint8_t value;
@@ -62,7 +126,7 @@ void test_setLongAddressRegisterValue(void) {
 }
 
 void check_readAddressControlRegister(uint16_t register_address, const uint8_t *command, uint8_t command_length) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
   PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, command, command_length, command_length);
   uint8_t value = 0xAB;
@@ -86,7 +150,7 @@ void test_readLongAddressControlRegister(void) {
 }
 
 void test_readBlockingFromLongAddress(void) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   uint8_t buffer;
   uint8_t expected_buffer = 0xC9;
   uint8_t command[] = {
@@ -104,7 +168,7 @@ void test_readBlockingFromLongAddress(void) {
 }
 
 void test_readBlockingFromLongAddress2(void) {
-  MrfIo mrf;
+  MrfIo mrf = {0};
   uint8_t buffer[3];
   uint8_t expected_buffer[] = {0xC9, 0xAB, 0x14};
   uint8_t command[] = {
@@ -120,3 +184,278 @@ void test_readBlockingFromLongAddress2(void) {
   MrfIo_readBlockingFromLongAddress(&mrf, mrf_rx_fifo_start, &buffer, 3);
   TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_buffer, buffer, 3);
 }
+
+static uint8_t callback_calls = 0;
+
+static void countCallbackCalls(void *counter) {
+  (*(uint8_t *) counter)++;
+}
+
+static void expectStartOfNonBlockingTransfer(MrfIo *mrf, const uint8_t *command, uint8_t command_size) {
+  PeripheralInterface_setWriteCallback_ExpectAnyArgs();
+  PeripheralInterface_selectPeripheral_Expect(mrf->interface, mrf->device);
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(mrf->interface, 1, command, command_size, command_size);
+}
+
+void test_writeNonBlockingToLongAddressOnlyWritesCommandBeforeReturning(void) {
+  MrfIo mrf = {0};
+  uint8_t payload[3] = {1, 2, 3};
+  uint16_t address = 5;
+  uint8_t command[2] = {MRF_writeLongCommandFirstByte(address),
+                        MRF_writeLongCommandSecondByte(address)};
+  MrfIo_NonBlockingWriteContext context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = payload,
+          .length = 3,
+          .address = address,
+  };
+  expectStartOfNonBlockingTransfer(&mrf, command, 2);
+  TEST_ASSERT_TRUE(MrfIo_writeNonBlockingToLongAddress(&mrf, &context));
+  TEST_ASSERT_TRUE(MrfIo_isBusy(&mrf));
+}
+
+void test_writeNonBlockingWritesPayloadAfterCommandAndExecutesCallback(void) {
+  MrfIo mrf = {0};
+  uint8_t payload[3] = {1, 2, 3};
+  uint16_t address = 5;
+  uint8_t command[2] = {MRF_writeLongCommandFirstByte(address),
+                        MRF_writeLongCommandSecondByte(address)};
+  callback_calls = 0;
+  MrfIo_NonBlockingWriteContext context = {
+          .callback = {.function = countCallbackCalls, .argument = &callback_calls},
+          .output_buffer = payload,
+          .length = 3,
+          .address = address,
+  };
+  expectStartOfNonBlockingTransfer(&mrf, command, 2);
+  MrfIo_writeNonBlockingToLongAddress(&mrf, &context);
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(mrf.interface, 1, payload, 3, 3);
+  MrfIo_handleWriteComplete(&mrf);
+  TEST_ASSERT_EQUAL_UINT8(0, callback_calls);
+
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_handleWriteComplete(&mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, callback_calls);
+  TEST_ASSERT_FALSE(MrfIo_isBusy(&mrf));
+}
+
+void test_queuedTransferIsStartedFromCompletionOfPreviousTransfer(void) {
+  MrfIo mrf = {0};
+  uint8_t header[2] = {7, 9};
+  uint8_t payload[4] = {1, 2, 3, 4};
+  uint8_t header_command[2] = {MRF_writeLongCommandFirstByte(0),
+                               MRF_writeLongCommandSecondByte(0)};
+  uint8_t payload_command[2] = {MRF_writeLongCommandFirstByte(2),
+                                MRF_writeLongCommandSecondByte(2)};
+  MrfIo_NonBlockingWriteContext header_context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = header,
+          .length = 2,
+          .address = 0,
+  };
+  MrfIo_NonBlockingWriteContext payload_context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = payload,
+          .length = 4,
+          .address = 2,
+  };
+  expectStartOfNonBlockingTransfer(&mrf, header_command, 2);
+  MrfIo_writeNonBlockingToLongAddress(&mrf, &header_context);
+  MrfIo_writeNonBlockingToLongAddress(&mrf, &payload_context);
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(mrf.interface, 1, header, 2, 2);
+  MrfIo_handleWriteComplete(&mrf);
+
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  expectStartOfNonBlockingTransfer(&mrf, payload_command, 2);
+  MrfIo_handleWriteComplete(&mrf);
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(mrf.interface, 1, payload, 4, 4);
+  MrfIo_handleWriteComplete(&mrf);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_handleWriteComplete(&mrf);
+  TEST_ASSERT_FALSE(MrfIo_isBusy(&mrf));
+}
+
+void test_writeNonBlockingFailsWhenQueueIsFull(void) {
+  MrfIo mrf = {0};
+  uint8_t value = 1;
+  uint8_t command = MRF_writeShortCommand(mrf_register_tx_normal_fifo_control);
+  MrfIo_NonBlockingWriteContext context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = &value,
+          .length = 1,
+          .address = mrf_register_tx_normal_fifo_control,
+  };
+  expectStartOfNonBlockingTransfer(&mrf, &command, 1);
+  for (uint8_t i = 0; i < MRF_IO_TRANSFER_QUEUE_SIZE - 1; i++) {
+    TEST_ASSERT_TRUE(MrfIo_writeNonBlockingToShortAddress(&mrf, &context));
+  }
+  TEST_ASSERT_FALSE(MrfIo_writeNonBlockingToShortAddress(&mrf, &context));
+}
+
+void test_numberOfFreeTransfersDecreasesWithEveryQueuedTransfer(void) {
+  MrfIo mrf = {0};
+  uint8_t value = 1;
+  uint8_t command = MRF_writeShortCommand(mrf_register_tx_normal_fifo_control);
+  MrfIo_NonBlockingWriteContext context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = &value,
+          .length = 1,
+          .address = mrf_register_tx_normal_fifo_control,
+  };
+  TEST_ASSERT_EQUAL_UINT8(MRF_IO_TRANSFER_QUEUE_SIZE - 1, MrfIo_getNumberOfFreeTransfers(&mrf));
+  expectStartOfNonBlockingTransfer(&mrf, &command, 1);
+  for (uint8_t i = 0; i < MRF_IO_TRANSFER_QUEUE_SIZE - 1; i++) {
+    MrfIo_writeNonBlockingToShortAddress(&mrf, &context);
+    TEST_ASSERT_EQUAL_UINT8(MRF_IO_TRANSFER_QUEUE_SIZE - 2 - i, MrfIo_getNumberOfFreeTransfers(&mrf));
+  }
+}
+
+void test_readNonBlockingFromLongAddress(void) {
+  MrfIo mrf = {0};
+  uint8_t buffer[2];
+  uint8_t expected[2] = {0xAB, 0xCD};
+  uint8_t command[2] = {MRF_readLongCommandFirstByte(mrf_rx_fifo_start),
+                        MRF_readLongCommandSecondByte(mrf_rx_fifo_start)};
+  callback_calls = 0;
+  MrfIo_NonBlockingReadContext context = {
+          .callback = {.function = countCallbackCalls, .argument = &callback_calls},
+          .input_buffer = buffer,
+          .length = 2,
+          .address = mrf_rx_fifo_start,
+  };
+  expectStartOfNonBlockingTransfer(&mrf, command, 2);
+  MrfIo_readNonBlockingFromLongAddress(&mrf, &context);
+
+  PeripheralInterface_setReadCallback_ExpectAnyArgs();
+  PeripheralInterface_readNonBlocking_Expect(mrf.interface, buffer, 2);
+  PeripheralInterface_readNonBlocking_IgnoreArg_buffer();
+  PeripheralInterface_readNonBlocking_ReturnArrayThruPtr_buffer(expected, 2);
+  MrfIo_handleWriteComplete(&mrf);
+
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+  MrfIo_handleReadComplete(&mrf);
+  TEST_ASSERT_EQUAL_UINT8(1, callback_calls);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, 2);
+}
+
+void test_readRxFifoBlockingReadsLengthAndFrameWithinOneTransaction(void) {
+  MrfIo mrf = {0};
+  uint8_t buffer[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t frame_length = 4;
+  uint8_t frame_with_link_quality_and_rssi[] = {0x41, 0xA8, 0x55, 0x66, 0xAA, 0xBB};
+  uint8_t command[] = {
+          MRF_readLongCommandFirstByte(mrf_rx_fifo_start),
+          MRF_readLongCommandSecondByte(mrf_rx_fifo_start),
+  };
+  PeripheralInterface_selectPeripheral_Expect(mrf.interface, mrf.device);
+  PeripheralInterface_writeBlocking_ExpectWithArray(mrf.interface, 1, command, 2, 2);
+  PeripheralInterface_readBlocking_Expect(mrf.interface, buffer, 1);
+  PeripheralInterface_readBlocking_ReturnArrayThruPtr_buffer(&frame_length, 1);
+  PeripheralInterface_readBlocking_Expect(mrf.interface, buffer + 1, frame_length + 2);
+  PeripheralInterface_readBlocking_IgnoreArg_buffer();
+  PeripheralInterface_readBlocking_ReturnArrayThruPtr_buffer(frame_with_link_quality_and_rssi, frame_length + 2);
+  PeripheralInterface_deselectPeripheral_Expect(mrf.interface, mrf.device);
+
+  uint8_t size = MrfIo_readRxFifoBlocking(&mrf, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_UINT8(frame_length + 3, size);
+  TEST_ASSERT_EQUAL_UINT8(frame_length, buffer[0]);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(frame_with_link_quality_and_rssi, buffer + 1, frame_length + 2);
+}
+
+void test_readRxFifoBlockingDoesNotOverflowBuffer(void) {
+  MrfIo mrf = {0};
+  uint8_t buffer[4];
+  uint8_t frame_length = 20;
+  PeripheralInterface_selectPeripheral_ExpectAnyArgs();
+  PeripheralInterface_writeBlocking_ExpectAnyArgs();
+  PeripheralInterface_readBlocking_Expect(mrf.interface, buffer, 1);
+  PeripheralInterface_readBlocking_ReturnArrayThruPtr_buffer(&frame_length, 1);
+  PeripheralInterface_readBlocking_Expect(mrf.interface, buffer + 1, 3);
+  PeripheralInterface_readBlocking_IgnoreArg_buffer();
+  PeripheralInterface_deselectPeripheral_ExpectAnyArgs();
+  TEST_ASSERT_EQUAL_UINT8(4, MrfIo_readRxFifoBlocking(&mrf, buffer, sizeof(buffer)));
+}
+
+void test_readRxFifoBlockingWithEmptyBufferReadsNothing(void) {
+  MrfIo mrf = {0};
+  uint8_t buffer[1] = {0xAA};
+  TEST_ASSERT_EQUAL_UINT8(0, MrfIo_readRxFifoBlocking(&mrf, buffer, 0));
+  TEST_ASSERT_EQUAL_HEX8(0xAA, buffer[0]);
+}
+
+static uint8_t first_device;
+static uint8_t second_device;
+
+static void setUpMrfIosSharingInterface(MrfIo *first, MrfIo *second) {
+  first->device = &first_device;
+  second->device = &second_device;
+  MrfIo_shareInterface(second, first);
+}
+
+static MrfIo_NonBlockingWriteContext createShortWriteContext(const uint8_t *value, uint8_t address) {
+  MrfIo_NonBlockingWriteContext context = {
+          .callback = {.function = NULL, .argument = NULL},
+          .output_buffer = value,
+          .length = 1,
+          .address = address,
+  };
+  return context;
+}
+
+void test_transferIsDeferredWhileOtherMrfIoOnSameInterfaceIsBusy(void) {
+  MrfIo first = {0};
+  MrfIo second = {0};
+  setUpMrfIosSharingInterface(&first, &second);
+  uint8_t first_value = 1;
+  uint8_t second_value = 2;
+  uint8_t command = MRF_writeShortCommand(mrf_register_tx_normal_fifo_control);
+  MrfIo_NonBlockingWriteContext first_context =
+          createShortWriteContext(&first_value, mrf_register_tx_normal_fifo_control);
+  MrfIo_NonBlockingWriteContext second_context =
+          createShortWriteContext(&second_value, mrf_register_tx_normal_fifo_control);
+  expectStartOfNonBlockingTransfer(&first, &command, 1);
+  MrfIo_writeNonBlockingToShortAddress(&first, &first_context);
+  MrfIo_writeNonBlockingToShortAddress(&second, &second_context);
+  TEST_ASSERT_FALSE(MrfIo_isBusy(&second));
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(first.interface, 1, &first_value, 1, 1);
+  MrfIo_handleWriteComplete(&first);
+  PeripheralInterface_deselectPeripheral_Expect(first.interface, first.device);
+  expectStartOfNonBlockingTransfer(&second, &command, 1);
+  MrfIo_handleWriteComplete(&first);
+  TEST_ASSERT_FALSE(MrfIo_isBusy(&first));
+  TEST_ASSERT_TRUE(MrfIo_isBusy(&second));
+}
+
+void test_mrfIosSharingInterfaceTakeTurns(void) {
+  MrfIo first = {0};
+  MrfIo second = {0};
+  setUpMrfIosSharingInterface(&first, &second);
+  uint8_t value = 1;
+  uint8_t first_command = MRF_writeShortCommand(mrf_register_tx_normal_fifo_control);
+  uint8_t second_command = MRF_writeShortCommand(mrf_register_interrupt_control);
+  MrfIo_NonBlockingWriteContext first_context =
+          createShortWriteContext(&value, mrf_register_tx_normal_fifo_control);
+  MrfIo_NonBlockingWriteContext second_context =
+          createShortWriteContext(&value, mrf_register_interrupt_control);
+  expectStartOfNonBlockingTransfer(&first, &first_command, 1);
+  MrfIo_writeNonBlockingToShortAddress(&first, &first_context);
+  MrfIo_writeNonBlockingToShortAddress(&first, &first_context);
+  MrfIo_writeNonBlockingToShortAddress(&second, &second_context);
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(first.interface, 1, &value, 1, 1);
+  MrfIo_handleWriteComplete(&first);
+  PeripheralInterface_deselectPeripheral_Expect(first.interface, first.device);
+  expectStartOfNonBlockingTransfer(&second, &second_command, 1);
+  MrfIo_handleWriteComplete(&first);
+
+  PeripheralInterface_writeNonBlocking_ExpectWithArray(second.interface, 1, &value, 1, 1);
+  MrfIo_handleWriteComplete(&second);
+  PeripheralInterface_deselectPeripheral_Expect(second.interface, second.device);
+  expectStartOfNonBlockingTransfer(&first, &first_command, 1);
+  MrfIo_handleWriteComplete(&second);
+  TEST_ASSERT_TRUE(MrfIo_isBusy(&first));
+}
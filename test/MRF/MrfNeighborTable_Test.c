@@ -0,0 +1,75 @@
+#include "unity.h"
+#include "src/Mac802154/MRF/MrfNeighborTable.h"
+
+static MrfNeighborTable table;
+static const uint8_t short_address[2] = {0x11, 0x22};
+static const uint8_t extended_address[8] = {0x11, 0x22, 0, 0, 0, 0, 0, 0};
+
+void debug(const uint8_t *message) {}
+
+void setUp(void) {
+  MrfNeighborTable_init(&table);
+}
+
+void test_unknownNeighborIsNotFound(void) {
+  Mac802154LinkQuality quality;
+  TEST_ASSERT_FALSE(MrfNeighborTable_get(&table, short_address, 2, &quality));
+}
+
+void test_firstFrameInitializesAverages(void) {
+  Mac802154LinkQuality quality;
+  MrfNeighborTable_update(&table, short_address, 2, 200, 100);
+  TEST_ASSERT_TRUE(MrfNeighborTable_get(&table, short_address, 2, &quality));
+  TEST_ASSERT_EQUAL_UINT8(200, quality.link_quality);
+  TEST_ASSERT_EQUAL_UINT8(100, quality.rssi);
+  TEST_ASSERT_EQUAL_UINT8(1, quality.number_of_frames);
+}
+
+void test_followingFramesAreWeightedByAQuarter(void) {
+  Mac802154LinkQuality quality;
+  MrfNeighborTable_update(&table, short_address, 2, 200, 100);
+  MrfNeighborTable_update(&table, short_address, 2, 100, 140);
+  MrfNeighborTable_get(&table, short_address, 2, &quality);
+  TEST_ASSERT_EQUAL_UINT8(175, quality.link_quality);
+  TEST_ASSERT_EQUAL_UINT8(110, quality.rssi);
+  TEST_ASSERT_EQUAL_UINT8(2, quality.number_of_frames);
+}
+
+void test_averageReachesConstantSample(void) {
+  Mac802154LinkQuality quality;
+  MrfNeighborTable_update(&table, short_address, 2, 0, 255);
+  for (uint8_t i = 0; i < 40; i++) {
+    MrfNeighborTable_update(&table, short_address, 2, 255, 0);
+  }
+  MrfNeighborTable_get(&table, short_address, 2, &quality);
+  TEST_ASSERT_EQUAL_UINT8(255, quality.link_quality);
+  TEST_ASSERT_EQUAL_UINT8(0, quality.rssi);
+}
+
+void test_numberOfFramesSaturates(void) {
+  Mac802154LinkQuality quality;
+  for (uint16_t i = 0; i < 300; i++) {
+    MrfNeighborTable_update(&table, short_address, 2, 1, 1);
+  }
+  MrfNeighborTable_get(&table, short_address, 2, &quality);
+  TEST_ASSERT_EQUAL_UINT8(255, quality.number_of_frames);
+}
+
+void test_shortAndExtendedAddressAreDifferentNeighbors(void) {
+  Mac802154LinkQuality quality;
+  MrfNeighborTable_update(&table, short_address, 2, 200, 100);
+  TEST_ASSERT_FALSE(MrfNeighborTable_get(&table, extended_address, 8, &quality));
+}
+
+void test_oldestNeighborIsForgottenWhenTableIsFull(void) {
+  Mac802154LinkQuality quality;
+  uint8_t address[2] = {0, 0};
+  for (uint8_t i = 0; i <= MRF_NEIGHBOR_TABLE_SIZE; i++) {
+    address[0] = i;
+    MrfNeighborTable_update(&table, address, 2, i, i);
+  }
+  address[0] = 0;
+  TEST_ASSERT_FALSE(MrfNeighborTable_get(&table, address, 2, &quality));
+  address[0] = MRF_NEIGHBOR_TABLE_SIZE;
+  TEST_ASSERT_TRUE(MrfNeighborTable_get(&table, address, 2, &quality));
+}
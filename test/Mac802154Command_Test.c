@@ -0,0 +1,139 @@
+#include "unity.h"
+#include "CommunicationModule/Mac802154Command.h"
+
+static uint8_t buffer[32];
+
+void setUp(void) {
+  for (uint8_t i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = 0xEE;
+  }
+}
+
+void test_associationRequestCarriesCapabilityInformation(void) {
+  uint8_t capabilities = MAC802154_CAPABILITY_RECEIVER_ON_WHEN_IDLE | MAC802154_CAPABILITY_ALLOCATE_ADDRESS;
+  uint8_t expected[] = {0x01, 0x88};
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154Command_writeAssociationRequest(buffer, capabilities));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, 2);
+
+  uint8_t parsed_capabilities = 0;
+  TEST_ASSERT_TRUE(Mac802154Command_parseAssociationRequest(buffer, 2, &parsed_capabilities));
+  TEST_ASSERT_EQUAL_HEX8(capabilities, parsed_capabilities);
+}
+
+void test_associationResponseCarriesAddressAndStatus(void) {
+  Mac802154AssociationResponse response = {
+    .short_address = {0x05, 0x00},
+    .status = MAC802154_ASSOCIATION_SUCCESSFUL,
+  };
+  uint8_t expected[] = {0x02, 0x05, 0x00, 0x00};
+  TEST_ASSERT_EQUAL_UINT8(4, Mac802154Command_writeAssociationResponse(buffer, &response));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, 4);
+
+  Mac802154AssociationResponse parsed;
+  TEST_ASSERT_TRUE(Mac802154Command_parseAssociationResponse(buffer, 4, &parsed));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(response.short_address, parsed.short_address, 2);
+  TEST_ASSERT_EQUAL_UINT8(MAC802154_ASSOCIATION_SUCCESSFUL, parsed.status);
+}
+
+void test_commandsWithoutPayloadConsistOfTheIdentifier(void) {
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154Command_writeDataRequest(buffer));
+  TEST_ASSERT_EQUAL_UINT8(MAC802154_COMMAND_DATA_REQUEST, Mac802154Command_getIdentifier(buffer, 1));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154Command_writeBeaconRequest(buffer));
+  TEST_ASSERT_EQUAL_UINT8(MAC802154_COMMAND_BEACON_REQUEST, Mac802154Command_getIdentifier(buffer, 1));
+}
+
+void test_getIdentifierOfEmptyPayload(void) {
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154Command_getIdentifier(buffer, 0));
+}
+
+void test_parseFailsForOtherCommandOrTruncatedPayload(void) {
+  Mac802154AssociationResponse response;
+  uint8_t capabilities;
+  Mac802154Command_writeAssociationRequest(buffer, 0);
+  TEST_ASSERT_FALSE(Mac802154Command_parseAssociationResponse(buffer, 4, &response));
+  TEST_ASSERT_FALSE(Mac802154Command_parseAssociationRequest(buffer, 1, &capabilities));
+}
+
+void test_beaconOfNonbeaconEnabledPan(void) {
+  const uint8_t payload[] = {'n', 'e', 't'};
+  Mac802154Beacon beacon = {
+    .beacon_order = 15,
+    .superframe_order = 15,
+    .final_cap_slot = 15,
+    .pan_coordinator = true,
+    .association_permit = true,
+    .payload = payload,
+    .payload_size = 3,
+  };
+  uint8_t expected[] = {0xFF, 0xCF, 0x00, 0x00, 'n', 'e', 't'};
+  TEST_ASSERT_EQUAL_UINT8(7, Mac802154Beacon_write(buffer, &beacon));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, 7);
+
+  Mac802154Beacon parsed;
+  TEST_ASSERT_TRUE(Mac802154Beacon_parse(buffer, 7, &parsed));
+  TEST_ASSERT_EQUAL_UINT8(15, parsed.beacon_order);
+  TEST_ASSERT_EQUAL_UINT8(15, parsed.superframe_order);
+  TEST_ASSERT_EQUAL_UINT8(15, parsed.final_cap_slot);
+  TEST_ASSERT_TRUE(parsed.pan_coordinator);
+  TEST_ASSERT_TRUE(parsed.association_permit);
+  TEST_ASSERT_EQUAL_UINT8(3, parsed.payload_size);
+  TEST_ASSERT_EQUAL_PTR(buffer + 4, parsed.payload);
+}
+
+void test_parseBeaconReadsGuaranteedTimeSlotsAndSkipsPendingAddresses(void) {
+  uint8_t beacon_payload[] = {
+    0x44, 0x08,
+    0x81, 0x01, 0x12, 0x34, 0x22,
+    0x11, 0x05, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    'x',
+  };
+  Mac802154Beacon parsed;
+  TEST_ASSERT_TRUE(Mac802154Beacon_parse(beacon_payload, sizeof(beacon_payload), &parsed));
+  TEST_ASSERT_EQUAL_UINT8(4, parsed.beacon_order);
+  TEST_ASSERT_EQUAL_UINT8(4, parsed.superframe_order);
+  TEST_ASSERT_EQUAL_UINT8(8, parsed.final_cap_slot);
+  TEST_ASSERT_FALSE(parsed.pan_coordinator);
+  TEST_ASSERT_TRUE(parsed.guaranteed_time_slot_permit);
+  TEST_ASSERT_EQUAL_UINT8(1, parsed.number_of_guaranteed_time_slots);
+  uint8_t expected_address[] = {0x12, 0x34};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected_address, parsed.guaranteed_time_slots[0].short_address, 2);
+  TEST_ASSERT_EQUAL_UINT8(2, parsed.guaranteed_time_slots[0].starting_slot);
+  TEST_ASSERT_EQUAL_UINT8(2, parsed.guaranteed_time_slots[0].length);
+  TEST_ASSERT_TRUE(parsed.guaranteed_time_slots[0].receive);
+  TEST_ASSERT_EQUAL_UINT8(1, parsed.payload_size);
+  TEST_ASSERT_EQUAL_HEX8('x', *parsed.payload);
+}
+
+void test_beaconWithGuaranteedTimeSlots(void) {
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 11,
+    .pan_coordinator = true,
+    .guaranteed_time_slot_permit = true,
+    .number_of_guaranteed_time_slots = 2,
+    .guaranteed_time_slots = {
+      {.short_address = {0x01, 0x00}, .starting_slot = 14, .length = 2},
+      {.short_address = {0x02, 0x00}, .starting_slot = 12, .length = 2, .receive = true},
+    },
+  };
+  uint8_t expected[] = {0x46, 0x4B, 0x82, 0x02, 0x01, 0x00, 0x2E, 0x02, 0x00, 0x2C, 0x00};
+  TEST_ASSERT_EQUAL_UINT8(sizeof(expected), Mac802154Beacon_write(buffer, &beacon));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+
+  Mac802154Beacon parsed;
+  TEST_ASSERT_TRUE(Mac802154Beacon_parse(buffer, sizeof(expected), &parsed));
+  TEST_ASSERT_EQUAL_UINT8(2, parsed.number_of_guaranteed_time_slots);
+  TEST_ASSERT_EQUAL_UINT8(14, parsed.guaranteed_time_slots[0].starting_slot);
+  TEST_ASSERT_FALSE(parsed.guaranteed_time_slots[0].receive);
+  TEST_ASSERT_EQUAL_HEX8(0x02, parsed.guaranteed_time_slots[1].short_address[0]);
+  TEST_ASSERT_TRUE(parsed.guaranteed_time_slots[1].receive);
+  TEST_ASSERT_EQUAL_UINT8(0, parsed.payload_size);
+}
+
+void test_parseBeaconFailsIfListsExceedPayload(void) {
+  uint8_t beacon_payload[] = {0xFF, 0xCF, 0x00, 0x02, 0x01, 0x00};
+  Mac802154Beacon parsed;
+  TEST_ASSERT_FALSE(Mac802154Beacon_parse(beacon_payload, sizeof(beacon_payload), &parsed));
+  TEST_ASSERT_FALSE(Mac802154Beacon_parse(beacon_payload, 3, &parsed));
+}
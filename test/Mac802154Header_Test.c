@@ -60,12 +60,31 @@ void test_controlFieldIsCorrectlyInitialized(void) {
   TEST_ASSERT_EQUAL_HEX8_ARRAY(default_control_field, header_data, 2);
 }
 
+void test_getFrameTypeOfFreshHeaderIsData(void) {
+  TEST_ASSERT_EQUAL_UINT8(1, FrameHeader802154_getFrameType(header));
+}
+
+void test_setFrameTypeOnlyChangesFrameTypeBits(void) {
+  FrameHeader802154_setFrameType(header, 3);
+  TEST_ASSERT_EQUAL_UINT8(3, FrameHeader802154_getFrameType(header));
+  TEST_ASSERT_EQUAL_HEX8(0x43, header_data[0]);
+}
+
 void test_setSequenceNumber(void) {
   uint8_t number = 23;
   FrameHeader802154_setSequenceNumber(header, number);
   TEST_ASSERT_EQUAL_UINT8(number, *FrameHeader802154_getSequenceNumberPtr(header));
 }
 
+void test_setSequenceNumberTwiceKeepsPanIdInPlace(void) {
+  uint8_t pan_id[2] = {0xCD, 0xAB};
+  FrameHeader802154_setPanId(header, pan_id);
+  FrameHeader802154_setSequenceNumber(header, 1);
+  FrameHeader802154_setSequenceNumber(header, 2);
+  TEST_ASSERT_EQUAL_UINT8(2, *FrameHeader802154_getSequenceNumberPtr(header));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(pan_id, FrameHeader802154_getPanIdPtr(header), 2);
+}
+
 void test_getSequenceNumberSizeWhenPresent(void) {
   uint8_t number = 234;
   FrameHeader802154_setSequenceNumber(header, number);
@@ -430,3 +449,20 @@ void test_getSourceAddressPtr(void) {
   const uint8_t *source_address = FrameHeader802154_getSourceAddressPtr(header);
   TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, source_address, 2);
 }
+
+void test_beaconWithoutDestinationAddressCarriesSourcePanId(void) {
+  uint8_t beacon[] = {0x00, 0x80, 0x07, 0x34, 0x12, 0x01, 0x00};
+  FrameHeader802154 *beacon_header = (FrameHeader802154 *) beacon;
+  TEST_ASSERT_EQUAL_UINT8(7, FrameHeader802154_getHeaderSize(beacon_header));
+  TEST_ASSERT_EQUAL_UINT8(2, FrameHeader802154_getPanIdSize(beacon_header));
+  TEST_ASSERT_EQUAL_PTR(beacon + 3, FrameHeader802154_getPanIdPtr(beacon_header));
+  TEST_ASSERT_EQUAL_PTR(beacon + 5, FrameHeader802154_getSourceAddressPtr(beacon_header));
+}
+
+void test_acknowledgementRequestCanBeEnabledAndDisabled(void) {
+  const uint8_t acknowledgement_request_bit = 5;
+  FrameHeader802154_enableAcknowledgementRequest(header);
+  TEST_ASSERT_BIT_HIGH(acknowledgement_request_bit, *FrameHeader802154_getHeaderPtr(header));
+  FrameHeader802154_disableAcknowledgementRequest(header);
+  TEST_ASSERT_BIT_LOW(acknowledgement_request_bit, *FrameHeader802154_getHeaderPtr(header));
+}
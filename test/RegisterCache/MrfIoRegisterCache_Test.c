@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "CommunicationModule/CommunicationModule.h"
+#include "src/Mac802154/MRF/MrfIo.h"
+#include "src/Mac802154/MRF/MRFInternalConstants.h"
+#include "test/Simulation/MrfSimulator.h"
+
+/**
+ * Built with MRF_IO_REGISTER_CACHE enabled (see BUILD).
+ * The driver runs against the simulated MRF24J40, so the
+ * spi transactions saved by the cache can be counted.
+ */
+
+void debug(const uint8_t *message) {}
+
+static MrfSimulatorMedium medium;
+static MrfSimulator chip;
+static Mac802154 *mac;
+static Mac802154Config config;
+
+static void
+advanceSimulatedTime(uint16_t microseconds)
+{
+  MrfSimulatorMedium_advanceTime(&medium, microseconds);
+}
+
+static uint32_t
+getSpiTransactions(void)
+{
+  return MrfSimulator_getStatistics(&chip)->spi_transactions;
+}
+
+static MrfIo *
+getIo(void)
+{
+  return &((Mrf *) mac)->io;
+}
+
+void
+setUp(void)
+{
+  MrfSimulatorMedium_init(&medium);
+  MrfSimulator_create(&chip, &medium);
+  MRFConfig hardware_config = {
+    .transmitter_power = 0,
+    .reset_line = {
+      .data_direction_register = NULL,
+      .data_register = NULL,
+      .pin_number = 0,
+    },
+    .delay_microseconds = advanceSimulatedTime,
+    .interface = MrfSimulator_getInterface(&chip),
+    .device = NULL,
+  };
+  memset(&config, 0, sizeof(config));
+  config.channel = 12;
+  mac = malloc(Mac802154MRF_getADTSize());
+  Mac802154MRF_create(mac, &hardware_config);
+  Mac802154_configure(mac, &config);
+}
+
+void
+tearDown(void)
+{
+  free(mac);
+}
+
+void
+test_cacheIsEnabled(void)
+{
+  TEST_ASSERT_EQUAL_INT(1, MRF_IO_REGISTER_CACHE);
+}
+
+void
+test_promiscuousModeIsOnlyWrittenWhenChanged(void)
+{
+  uint32_t transactions = getSpiTransactions();
+  Mac802154_enablePromiscuousMode(mac);
+  Mac802154_enablePromiscuousMode(mac);
+  TEST_ASSERT_EQUAL_UINT32(transactions + 1, getSpiTransactions());
+  TEST_ASSERT_EQUAL_HEX8(1, MrfSimulator_getShortRegister(&chip, mrf_register_receive_mac_control));
+
+  Mac802154_disablePromiscuousMode(mac);
+  Mac802154_disablePromiscuousMode(mac);
+  TEST_ASSERT_EQUAL_UINT32(transactions + 2, getSpiTransactions());
+  TEST_ASSERT_EQUAL_HEX8(0, MrfSimulator_getShortRegister(&chip, mrf_register_receive_mac_control));
+}
+
+void
+test_cachedRegisterIsReadWithoutBusAccess(void)
+{
+  uint32_t transactions = getSpiTransactions();
+  uint8_t value = MrfIo_readControlRegister(getIo(), mrf_register_rf_control0);
+  TEST_ASSERT_EQUAL_HEX8(MrfSimulator_getLongRegister(&chip, mrf_register_rf_control0), value);
+  TEST_ASSERT_EQUAL_UINT32(transactions, getSpiTransactions());
+}
+
+void
+test_uncachedRegisterIsReadFromBus(void)
+{
+  uint32_t transactions = getSpiTransactions();
+  MrfIo_readControlRegister(getIo(), mrf_register_interrupt_status);
+  MrfIo_readControlRegister(getIo(), mrf_register_interrupt_status);
+  TEST_ASSERT_EQUAL_UINT32(transactions + 2, getSpiTransactions());
+}
+
+void
+test_reconfigureWritesAllRegistersAfterSoftwareReset(void)
+{
+  uint32_t transactions = getSpiTransactions();
+  Mac802154_configure(mac, &config);
+  uint32_t first_configuration = getSpiTransactions() - transactions;
+  transactions = getSpiTransactions();
+  Mac802154_configure(mac, &config);
+  TEST_ASSERT_EQUAL_UINT32(first_configuration, getSpiTransactions() - transactions);
+  TEST_ASSERT_EQUAL_HEX8(mrf_value_recommended_interframe_spacing,
+                         MrfSimulator_getShortRegister(&chip, mrf_register_tx_stabilization));
+}
+
+void
+test_energyScanStillMeasuresEveryChannel(void)
+{
+  uint8_t energy[MAC802154_NUMBER_OF_CHANNELS];
+  MrfSimulator_setChannelEnergy(&chip, 20, 0x30);
+  Mac802154_scanEnergy(mac, 1, energy);
+  Mac802154_scanEnergy(mac, 1, energy);
+  TEST_ASSERT_EQUAL_HEX8(0x30, energy[20 - MAC802154_FIRST_CHANNEL]);
+  TEST_ASSERT_EQUAL_HEX8(0, energy[0]);
+}
@@ -0,0 +1,707 @@
+#include <string.h>
+#include "test/Simulation/MrfSimulator.h"
+
+/*
+ * Register addresses and bits as named in the datasheet.
+ * They are deliberately not taken from the driver, so
+ * mistakes in the driver's constants show up in tests.
+ */
+enum {
+  RXMCR = 0x00,
+  PANIDL = 0x01,
+  PANIDH = 0x02,
+  SADRL = 0x03,
+  SADRH = 0x04,
+  EADR0 = 0x05,
+  ORDER = 0x10,
+  TXMCR = 0x11,
+  RXFLUSH = 0x0D,
+  TXNCON = 0x1B,
+  TXG1CON = 0x1C,
+  WAKECON = 0x22,
+  TXSTAT = 0x24,
+  SOFTRST = 0x2A,
+  INTSTAT = 0x31,
+  INTCON = 0x32,
+  SLPACK = 0x35,
+  BBREG1 = 0x39,
+  BBREG2 = 0x3A,
+  BBREG6 = 0x3E,
+  CCAEDTH = 0x3F,
+  RFCON0 = 0x200,
+  RSSI = 0x210,
+  TX_NORMAL_FIFO = 0x000,
+  TX_BEACON_FIFO = 0x080,
+  TX_GTS1_FIFO = 0x100,
+  RX_FIFO = 0x300,
+};
+
+enum {
+  PROMI = 1,
+  RXFLUSH_BIT = 1,
+  BCNONLY = 1 << 1,
+  DATAONLY = 1 << 2,
+  CMDONLY = 1 << 3,
+  TXNTRIG = 1,
+  TXNACKREQ = 1 << 2,
+  TXNSTAT = 1,
+  CCAFAIL = 1 << 5,
+  TXNRETRY_OFFSET = 6,
+  RSTBB = 1 << 1,
+  RSTMAC = 1,
+  IMMWAKE = 1 << 7,
+  REGWAKE = 1 << 6,
+  SLPACK_BIT = 1 << 7,
+  TXNIF = 1,
+  RXIF = 1 << 3,
+  RXDECINV = 1 << 2,
+  CHANNEL_MASK = 0xF0,
+  CHANNEL_OFFSET = 4,
+  RSSIMODE1 = 1 << 7,
+  RSSIRDY = 1,
+  CCAMODE_ENERGY_DETECTION = 1 << 7,
+  CSMABF_MASK = 0x07,
+  PANCOORD = 1 << 3,
+  SLOTTED = 1 << 5,
+  BO_OFFSET = 4,
+  TXG1TRIG = 1,
+  TXG1IF = 1 << 1,
+};
+
+/*
+ * 802.15.4 timing in the 2.4GHz band, 250kbit/s
+ */
+enum {
+  OCTET_DURATION_IN_MICROSECONDS = 32,
+  PHY_HEADER_SIZE = 6,
+  FCS_SIZE = 2,
+  ACKNOWLEDGEMENT_FRAME_SIZE = 5,
+  TURNAROUND_TIME_IN_MICROSECONDS = 192,
+  ACKNOWLEDGEMENT_WAIT_DURATION_IN_MICROSECONDS = 864,
+  MAXIMUM_FRAME_RETRIES = 3,
+  MAXIMUM_FRAME_SIZE = 127,
+  ENERGY_DETECTION_DURATION_IN_MICROSECONDS = 128,
+  UNIT_BACKOFF_PERIOD_IN_MICROSECONDS = 320,
+  FIRST_CHANNEL = 11,
+  NONBEACON_ENABLED_ORDER = 15,
+  FRAME_TYPE_BEACON = 0,
+};
+
+enum {
+  TRANSACTION_STEP_COMMAND,
+  TRANSACTION_STEP_SECOND_COMMAND_BYTE,
+  TRANSACTION_STEP_DATA,
+};
+
+static const uint8_t broadcast[2] = {0xFF, 0xFF};
+
+static void writeBlocking(PeripheralInterface *interface, const uint8_t *buffer, size_t length);
+static void readBlocking(PeripheralInterface *interface, uint8_t *buffer, size_t length);
+static void writeNonBlocking(PeripheralInterface *interface, const uint8_t *buffer, size_t length);
+static void readNonBlocking(PeripheralInterface *interface, uint8_t *buffer, size_t length);
+static void setWriteCallback(PeripheralInterface *interface, PeripheralInterface_Callback callback);
+static void setReadCallback(PeripheralInterface *interface, PeripheralInterface_Callback callback);
+static void selectPeripheral(PeripheralInterface *interface, Peripheral *device);
+static void deselectPeripheral(PeripheralInterface *interface, Peripheral *device);
+
+static void writeBlockingOnBus(PeripheralInterface *interface, const uint8_t *buffer, size_t length);
+static void readBlockingOnBus(PeripheralInterface *interface, uint8_t *buffer, size_t length);
+static void writeNonBlockingOnBus(PeripheralInterface *interface, const uint8_t *buffer, size_t length);
+static void readNonBlockingOnBus(PeripheralInterface *interface, uint8_t *buffer, size_t length);
+static void setWriteCallbackOnBus(PeripheralInterface *interface, PeripheralInterface_Callback callback);
+static void setReadCallbackOnBus(PeripheralInterface *interface, PeripheralInterface_Callback callback);
+static void selectPeripheralOnBus(PeripheralInterface *interface, Peripheral *device);
+static void deselectPeripheralOnBus(PeripheralInterface *interface, Peripheral *device);
+
+static void reset(MrfSimulator *self);
+static void startTransfer(MrfSimulatorTransfer *transfer, const uint8_t *write_buffer, uint8_t *read_buffer,
+                          size_t length);
+static void countSpiByte(MrfSimulator *self);
+static void processWrittenByte(MrfSimulator *self, uint8_t byte);
+static uint8_t readByte(MrfSimulator *self);
+static void writeMemory(MrfSimulator *self, uint8_t value);
+static void applyShortRegisterWrite(MrfSimulator *self, uint8_t address);
+static void transmitNormalFifo(MrfSimulator *self);
+static void transmitGuaranteedTimeSlotFifo(MrfSimulator *self);
+static bool transmitFifo(MrfSimulator *self, uint16_t fifo);
+static void measureEnergy(MrfSimulator *self);
+static bool channelIsClear(MrfSimulator *self);
+static void measureEnergy(MrfSimulator *self) {
+  uint8_t channel_index = self->long_memory[RFCON0] >> CHANNEL_OFFSET;
+  MrfSimulatorMedium_advanceTime(self->medium, ENERGY_DETECTION_DURATION_IN_MICROSECONDS);
+  self->long_memory[RSSI] = self->channel_energy[channel_index];
+  self->short_registers[BBREG6] = (uint8_t) ((self->short_registers[BBREG6] & ~RSSIMODE1) | RSSIRDY);
+}
+
+bool isOnSameChannel(const MrfSimulator *self, const MrfSimulator *other);
+static bool acceptsFrame(const MrfSimulator *self, const uint8_t *frame, uint8_t frame_length);
+static bool hasAcceptedFrameType(const MrfSimulator *self, const uint8_t *frame, uint8_t frame_length);
+static uint16_t calculateFrameCheckSequence(const uint8_t *frame, uint8_t frame_length);
+static uint32_t getAirTime(uint8_t frame_size_including_fcs);
+
+void MrfSimulatorMedium_init(MrfSimulatorMedium *medium) {
+  medium->number_of_nodes = 0;
+  medium->time_in_microseconds = 0;
+  medium->spi_byte_duration_in_microseconds = 1;
+}
+
+void MrfSimulatorMedium_advanceTime(MrfSimulatorMedium *medium, uint32_t microseconds) {
+  medium->time_in_microseconds += microseconds;
+}
+
+uint32_t MrfSimulatorMedium_getTimeInMicroseconds(const MrfSimulatorMedium *medium) {
+  return medium->time_in_microseconds;
+}
+
+void MrfSimulator_create(MrfSimulator *self, MrfSimulatorMedium *medium) {
+  memset(self, 0, sizeof(MrfSimulator));
+  self->interface.writeBlocking = writeBlocking;
+  self->interface.readBlocking = readBlocking;
+  self->interface.writeNonBlocking = writeNonBlocking;
+  self->interface.readNonBlocking = readNonBlocking;
+  self->interface.setWriteCallback = setWriteCallback;
+  self->interface.setReadCallback = setReadCallback;
+  self->interface.selectPeripheral = selectPeripheral;
+  self->interface.deselectPeripheral = deselectPeripheral;
+  self->medium = medium;
+  self->link_quality = 0xFF;
+  self->rssi = 0xFF;
+  reset(self);
+  if (medium->number_of_nodes < MRF_SIMULATOR_MAXIMUM_NUMBER_OF_NODES) {
+    medium->nodes[medium->number_of_nodes] = self;
+    medium->number_of_nodes++;
+  }
+}
+
+PeripheralInterface *MrfSimulator_getInterface(MrfSimulator *self) {
+  return &self->interface;
+}
+
+bool MrfSimulator_interruptIsPending(const MrfSimulator *self) {
+  // interrupts are enabled by clearing the corresponding bit in INTCON
+  return (self->short_registers[INTSTAT] & ~self->short_registers[INTCON]) != 0;
+}
+
+void MrfSimulator_setLinkQualityAndRssi(MrfSimulator *self, uint8_t link_quality, uint8_t rssi) {
+  self->link_quality = link_quality;
+  self->rssi = rssi;
+}
+
+void MrfSimulator_setChannelEnergy(MrfSimulator *self, uint8_t channel, uint8_t energy) {
+  self->channel_energy[(uint8_t) (channel - FIRST_CHANNEL) % MRF_SIMULATOR_NUMBER_OF_CHANNELS] = energy;
+}
+
+void MrfSimulatorBus_init(MrfSimulatorBus *bus) {
+  memset(bus, 0, sizeof(MrfSimulatorBus));
+  bus->interface.writeBlocking = writeBlockingOnBus;
+  bus->interface.readBlocking = readBlockingOnBus;
+  bus->interface.writeNonBlocking = writeNonBlockingOnBus;
+  bus->interface.readNonBlocking = readNonBlockingOnBus;
+  bus->interface.setWriteCallback = setWriteCallbackOnBus;
+  bus->interface.setReadCallback = setReadCallbackOnBus;
+  bus->interface.selectPeripheral = selectPeripheralOnBus;
+  bus->interface.deselectPeripheral = deselectPeripheralOnBus;
+}
+
+PeripheralInterface *MrfSimulatorBus_getInterface(MrfSimulatorBus *bus) {
+  return &bus->interface;
+}
+
+uint8_t MrfSimulator_getShortRegister(const MrfSimulator *self, uint8_t address) {
+  return self->short_registers[address % MRF_SIMULATOR_SHORT_ADDRESS_SPACE_SIZE];
+}
+
+uint8_t MrfSimulator_getLongRegister(const MrfSimulator *self, uint16_t address) {
+  return self->long_memory[address % MRF_SIMULATOR_LONG_ADDRESS_SPACE_SIZE];
+}
+
+const MrfSimulatorStatistics *MrfSimulator_getStatistics(const MrfSimulator *self) {
+  return &self->statistics;
+}
+
+bool MrfSimulator_isSleeping(const MrfSimulator *self) {
+  return self->sleeping;
+}
+
+bool MrfSimulator_step(MrfSimulator *self) {
+  if (!self->transfer.pending) {
+    return false;
+  }
+  MrfSimulatorTransfer transfer = self->transfer;
+  self->transfer.pending = false;
+  if (transfer.read_buffer != NULL) {
+    readBlocking(&self->interface, transfer.read_buffer, transfer.length);
+    if (self->read_callback.function != NULL) {
+      self->read_callback.function(self->read_callback.argument);
+    }
+  }
+  else {
+    writeBlocking(&self->interface, transfer.write_buffer, transfer.length);
+    if (self->write_callback.function != NULL) {
+      self->write_callback.function(self->write_callback.argument);
+    }
+  }
+  return true;
+}
+
+bool MrfSimulatorBus_step(MrfSimulatorBus *bus) {
+  if (!bus->transfer.pending) {
+    return false;
+  }
+  MrfSimulatorTransfer transfer = bus->transfer;
+  bus->transfer.pending = false;
+  if (transfer.read_buffer != NULL) {
+    readBlockingOnBus(&bus->interface, transfer.read_buffer, transfer.length);
+    if (bus->read_callback.function != NULL) {
+      bus->read_callback.function(bus->read_callback.argument);
+    }
+  }
+  else {
+    writeBlockingOnBus(&bus->interface, transfer.write_buffer, transfer.length);
+    if (bus->write_callback.function != NULL) {
+      bus->write_callback.function(bus->write_callback.argument);
+    }
+  }
+  return true;
+}
+
+void startTransfer(MrfSimulatorTransfer *transfer, const uint8_t *write_buffer, uint8_t *read_buffer,
+                   size_t length) {
+  transfer->write_buffer = write_buffer;
+  transfer->read_buffer = read_buffer;
+  transfer->length = length;
+  transfer->pending = true;
+}
+
+void reset(MrfSimulator *self) {
+  memset(self->short_registers, 0, sizeof(self->short_registers));
+  memset(self->long_memory, 0, sizeof(self->long_memory));
+  self->short_registers[INTCON] = 0xFF;
+  self->short_registers[ORDER] = 0xFF;
+  self->guaranteed_time_slot_pending = false;
+}
+
+void selectPeripheral(PeripheralInterface *interface, Peripheral *device) {
+  MrfSimulator *self = (MrfSimulator *) interface;
+  self->selected = true;
+  self->transaction_step = TRANSACTION_STEP_COMMAND;
+  self->statistics.spi_transactions++;
+}
+
+void deselectPeripheral(PeripheralInterface *interface, Peripheral *device) {
+  MrfSimulator *self = (MrfSimulator *) interface;
+  self->selected = false;
+}
+
+void setWriteCallback(PeripheralInterface *interface, PeripheralInterface_Callback callback) {
+  ((MrfSimulator *) interface)->write_callback = callback;
+}
+
+void setReadCallback(PeripheralInterface *interface, PeripheralInterface_Callback callback) {
+  ((MrfSimulator *) interface)->read_callback = callback;
+}
+
+void writeBlocking(PeripheralInterface *interface, const uint8_t *buffer, size_t length) {
+  MrfSimulator *self = (MrfSimulator *) interface;
+  for (size_t i = 0; i < length; i++) {
+    countSpiByte(self);
+    if (self->selected) {
+      processWrittenByte(self, buffer[i]);
+    }
+  }
+}
+
+void readBlocking(PeripheralInterface *interface, uint8_t *buffer, size_t length) {
+  MrfSimulator *self = (MrfSimulator *) interface;
+  for (size_t i = 0; i < length; i++) {
+    countSpiByte(self);
+    buffer[i] = readByte(self);
+  }
+}
+
+void writeNonBlocking(PeripheralInterface *interface, const uint8_t *buffer, size_t length) {
+  startTransfer(&((MrfSimulator *) interface)->transfer, buffer, NULL, length);
+}
+
+void readNonBlocking(PeripheralInterface *interface, uint8_t *buffer, size_t length) {
+  startTransfer(&((MrfSimulator *) interface)->transfer, NULL, buffer, length);
+}
+
+void selectPeripheralOnBus(PeripheralInterface *interface, Peripheral *device) {
+  MrfSimulatorBus *bus = (MrfSimulatorBus *) interface;
+  bus->selected = (MrfSimulator *) device;
+  selectPeripheral(&bus->selected->interface, device);
+}
+
+void deselectPeripheralOnBus(PeripheralInterface *interface, Peripheral *device) {
+  MrfSimulatorBus *bus = (MrfSimulatorBus *) interface;
+  deselectPeripheral(&((MrfSimulator *) device)->interface, device);
+  bus->selected = NULL;
+}
+
+void setWriteCallbackOnBus(PeripheralInterface *interface, PeripheralInterface_Callback callback) {
+  ((MrfSimulatorBus *) interface)->write_callback = callback;
+}
+
+void setReadCallbackOnBus(PeripheralInterface *interface, PeripheralInterface_Callback callback) {
+  ((MrfSimulatorBus *) interface)->read_callback = callback;
+}
+
+void writeBlockingOnBus(PeripheralInterface *interface, const uint8_t *buffer, size_t length) {
+  MrfSimulatorBus *bus = (MrfSimulatorBus *) interface;
+  if (bus->selected != NULL) {
+    writeBlocking(&bus->selected->interface, buffer, length);
+  }
+}
+
+void readBlockingOnBus(PeripheralInterface *interface, uint8_t *buffer, size_t length) {
+  MrfSimulatorBus *bus = (MrfSimulatorBus *) interface;
+  if (bus->selected != NULL) {
+    readBlocking(&bus->selected->interface, buffer, length);
+  }
+  else {
+    memset(buffer, 0, length);
+  }
+}
+
+void writeNonBlockingOnBus(PeripheralInterface *interface, const uint8_t *buffer, size_t length) {
+  startTransfer(&((MrfSimulatorBus *) interface)->transfer, buffer, NULL, length);
+}
+
+void readNonBlockingOnBus(PeripheralInterface *interface, uint8_t *buffer, size_t length) {
+  startTransfer(&((MrfSimulatorBus *) interface)->transfer, NULL, buffer, length);
+}
+
+void countSpiByte(MrfSimulator *self) {
+  self->statistics.spi_bytes++;
+  MrfSimulatorMedium_advanceTime(self->medium, self->medium->spi_byte_duration_in_microseconds);
+}
+
+/*
+ * short command: 0AAAAAAW
+ * long command:  1AAAAAAA AAAW0000
+ * A: address bits, W: 1 for write, 0 for read
+ */
+void processWrittenByte(MrfSimulator *self, uint8_t byte) {
+  switch (self->transaction_step) {
+    case TRANSACTION_STEP_COMMAND:
+      if (byte & 0x80) {
+        self->long_address = true;
+        self->address = (uint16_t) ((byte & 0x7F) << 3);
+        self->transaction_step = TRANSACTION_STEP_SECOND_COMMAND_BYTE;
+      }
+      else {
+        self->long_address = false;
+        self->address = (uint16_t) ((byte >> 1) & 0x3F);
+        self->writing = byte & 1;
+        self->transaction_step = TRANSACTION_STEP_DATA;
+      }
+      break;
+    case TRANSACTION_STEP_SECOND_COMMAND_BYTE:
+      self->address |= byte >> 5;
+      self->writing = (byte >> 4) & 1;
+      self->transaction_step = TRANSACTION_STEP_DATA;
+      break;
+    default:
+      if (self->writing) {
+        writeMemory(self, byte);
+      }
+      break;
+  }
+}
+
+/*
+ * Only the long address space supports sequential
+ * access, in the short address space every byte
+ * refers to the register given by the command.
+ */
+void writeMemory(MrfSimulator *self, uint8_t value) {
+  if (self->long_address) {
+    self->long_memory[self->address % MRF_SIMULATOR_LONG_ADDRESS_SPACE_SIZE] = value;
+    self->address++;
+  }
+  else {
+    self->short_registers[self->address] = value;
+    applyShortRegisterWrite(self, (uint8_t) self->address);
+  }
+}
+
+uint8_t readByte(MrfSimulator *self) {
+  if (!self->selected || self->transaction_step != TRANSACTION_STEP_DATA || self->writing) {
+    return 0;
+  }
+  if (self->long_address) {
+    uint8_t value = self->long_memory[self->address % MRF_SIMULATOR_LONG_ADDRESS_SPACE_SIZE];
+    self->address++;
+    return value;
+  }
+  uint8_t value = self->short_registers[self->address];
+  if (self->address == INTSTAT) {
+    self->short_registers[INTSTAT] = 0;
+  }
+  return value;
+}
+
+void applyShortRegisterWrite(MrfSimulator *self, uint8_t address) {
+  uint8_t value = self->short_registers[address];
+  switch (address) {
+    case TXNCON:
+      if (value & TXNTRIG) {
+        transmitNormalFifo(self);
+        self->short_registers[TXNCON] &= ~TXNTRIG;
+      }
+      break;
+    case TXG1CON:
+      if (value & TXG1TRIG) {
+        self->guaranteed_time_slot_pending = (self->short_registers[TXMCR] & SLOTTED) != 0;
+        self->short_registers[TXG1CON] &= ~TXG1TRIG;
+      }
+      break;
+    case SOFTRST:
+      // a power management reset (RSTPWR) keeps the registers
+      if (value & (RSTBB | RSTMAC)) {
+        reset(self);
+      }
+      break;
+    case RXFLUSH:
+      if (value & RXFLUSH_BIT) {
+        memset(self->long_memory + RX_FIFO, 0, MAXIMUM_FRAME_SIZE + 3);
+        self->short_registers[RXFLUSH] &= ~RXFLUSH_BIT;
+      }
+      break;
+    case BBREG6:
+      if (value & RSSIMODE1) {
+        measureEnergy(self);
+      }
+      break;
+    case SLPACK:
+      if (value & SLPACK_BIT) {
+        self->sleeping = true;
+        self->short_registers[SLPACK] &= ~SLPACK_BIT;
+      }
+      break;
+    case WAKECON:
+      if ((value & IMMWAKE) && (value & REGWAKE)) {
+        self->sleeping = false;
+      }
+      break;
+    case INTSTAT:
+      // read only
+      self->short_registers[INTSTAT] = 0;
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * tx normal fifo layout: [header length][frame length][frame]
+ * The fcs is appended by the chip.
+ */
+void transmitNormalFifo(MrfSimulator *self) {
+  if (self->sleeping) {
+    return;
+  }
+  MrfSimulatorMedium *medium = self->medium;
+  if (!channelIsClear(self)) {
+    self->short_registers[TXSTAT] = CCAFAIL | TXNSTAT;
+    self->short_registers[INTSTAT] |= TXNIF;
+    return;
+  }
+  bool accepted = transmitFifo(self, TX_NORMAL_FIFO);
+  uint8_t frame_length = self->long_memory[TX_NORMAL_FIFO + 1];
+  if (frame_length > MAXIMUM_FRAME_SIZE - FCS_SIZE) {
+    frame_length = MAXIMUM_FRAME_SIZE - FCS_SIZE;
+  }
+  uint32_t air_time = getAirTime((uint8_t) (frame_length + FCS_SIZE));
+  uint8_t status = 0;
+  if (self->short_registers[TXNCON] & TXNACKREQ) {
+    if (accepted) {
+      MrfSimulatorMedium_advanceTime(medium, TURNAROUND_TIME_IN_MICROSECONDS
+                                             + getAirTime(ACKNOWLEDGEMENT_FRAME_SIZE));
+    }
+    else {
+      MrfSimulatorMedium_advanceTime(medium, ACKNOWLEDGEMENT_WAIT_DURATION_IN_MICROSECONDS
+                                             + MAXIMUM_FRAME_RETRIES
+                                               * (air_time + ACKNOWLEDGEMENT_WAIT_DURATION_IN_MICROSECONDS));
+      status = (MAXIMUM_FRAME_RETRIES << TXNRETRY_OFFSET) | TXNSTAT;
+    }
+  }
+  self->short_registers[TXSTAT] = status;
+  self->short_registers[INTSTAT] |= TXNIF;
+  self->statistics.frames_transmitted++;
+}
+
+/*
+ * Sent within the guaranteed time slot, i.e. without
+ * csma-ca. Retransmissions are not modelled.
+ */
+void transmitGuaranteedTimeSlotFifo(MrfSimulator *self) {
+  self->guaranteed_time_slot_pending = false;
+  transmitFifo(self, TX_GTS1_FIFO);
+  self->short_registers[INTSTAT] |= TXG1IF;
+  self->statistics.frames_transmitted++;
+}
+
+/*
+ * Sends the frame of a fifo with the tx normal fifo layout
+ * to all nodes on the same channel.
+ * @return true if a node accepted the frame
+ */
+bool transmitFifo(MrfSimulator *self, uint16_t fifo) {
+  uint8_t frame_length = self->long_memory[fifo + 1];
+  const uint8_t *frame = self->long_memory + fifo + 2;
+  if (frame_length > MAXIMUM_FRAME_SIZE - FCS_SIZE) {
+    frame_length = MAXIMUM_FRAME_SIZE - FCS_SIZE;
+  }
+  MrfSimulatorMedium *medium = self->medium;
+  MrfSimulatorMedium_advanceTime(medium, getAirTime((uint8_t) (frame_length + FCS_SIZE)));
+  bool accepted = false;
+  for (uint8_t i = 0; i < medium->number_of_nodes; i++) {
+    MrfSimulator *node = medium->nodes[i];
+    if (node != self && isOnSameChannel(self, node)) {
+      accepted |= MrfSimulator_receiveFrame(node, frame, frame_length);
+    }
+  }
+  return accepted;
+}
+
+bool MrfSimulator_transmitBeacon(MrfSimulator *self) {
+  if (self->sleeping
+      || !(self->short_registers[RXMCR] & PANCOORD)
+      || (self->short_registers[ORDER] >> BO_OFFSET) == NONBEACON_ENABLED_ORDER) {
+    return false;
+  }
+  transmitFifo(self, TX_BEACON_FIFO);
+  self->statistics.frames_transmitted++;
+  return true;
+}
+
+/*
+ * Only energy detection is modelled, carrier sense
+ * always reports a clear channel. A busy channel stays
+ * busy for all macMaxCSMABackoffs + 1 assessments, each
+ * preceded by one unit backoff period.
+ */
+bool channelIsClear(MrfSimulator *self) {
+  if (!(self->short_registers[BBREG2] & CCAMODE_ENERGY_DETECTION)) {
+    return true;
+  }
+  uint8_t channel_index = self->long_memory[RFCON0] >> CHANNEL_OFFSET;
+  if (self->channel_energy[channel_index] <= self->short_registers[CCAEDTH]) {
+    return true;
+  }
+  uint8_t assessments = (uint8_t) ((self->short_registers[TXMCR] & CSMABF_MASK) + 1);
+  MrfSimulatorMedium_advanceTime(self->medium,
+                                 assessments * (uint32_t) (UNIT_BACKOFF_PERIOD_IN_MICROSECONDS
+                                                           + ENERGY_DETECTION_DURATION_IN_MICROSECONDS));
+  return false;
+}
+
+bool isOnSameChannel(const MrfSimulator *self, const MrfSimulator *other) {
+  return (self->long_memory[RFCON0] & CHANNEL_MASK) == (other->long_memory[RFCON0] & CHANNEL_MASK);
+}
+
+/*
+ * rx fifo layout: [frame length incl. fcs][frame][fcs][lqi][rssi]
+ */
+bool MrfSimulator_receiveFrame(MrfSimulator *self, const uint8_t *frame, uint8_t frame_length) {
+  if (self->sleeping
+      || (self->short_registers[BBREG1] & RXDECINV)
+      || frame_length > MAXIMUM_FRAME_SIZE - FCS_SIZE
+      || !acceptsFrame(self, frame, frame_length)) {
+    self->statistics.frames_filtered++;
+    return false;
+  }
+  uint8_t *rx_fifo = self->long_memory + RX_FIFO;
+  uint16_t frame_check_sequence = calculateFrameCheckSequence(frame, frame_length);
+  rx_fifo[0] = (uint8_t) (frame_length + FCS_SIZE);
+  memcpy(rx_fifo + 1, frame, frame_length);
+  rx_fifo[1 + frame_length] = (uint8_t) frame_check_sequence;
+  rx_fifo[2 + frame_length] = (uint8_t) (frame_check_sequence >> 8);
+  rx_fifo[3 + frame_length] = self->link_quality;
+  rx_fifo[4 + frame_length] = self->rssi;
+  self->short_registers[INTSTAT] |= RXIF;
+  self->statistics.frames_received++;
+  if (self->guaranteed_time_slot_pending && (frame[0] & 0x7) == FRAME_TYPE_BEACON) {
+    transmitGuaranteedTimeSlotFifo(self);
+  }
+  return true;
+}
+
+/*
+ * The BCNONLY, DATAONLY and CMDONLY bits of RXFLUSH,
+ * they apply in promiscuous mode too.
+ */
+bool hasAcceptedFrameType(const MrfSimulator *self, const uint8_t *frame, uint8_t frame_length) {
+  uint8_t only = self->short_registers[RXFLUSH];
+  uint8_t frame_type = (uint8_t) (frame_length > 0 ? frame[0] & 0x7 : 0xFF);
+  return !((only & BCNONLY) && frame_type != 0)
+         && !((only & DATAONLY) && frame_type != 1)
+         && !((only & CMDONLY) && frame_type != 3);
+}
+
+/*
+ * Frame control field (little endian):
+ * bits 0-2 frame type, bit 8 sequence number suppression,
+ * bits 10-11 destination addressing mode, bits 12-13 frame version
+ */
+bool acceptsFrame(const MrfSimulator *self, const uint8_t *frame, uint8_t frame_length) {
+  const uint8_t *registers = self->short_registers;
+  if (!hasAcceptedFrameType(self, frame, frame_length)) {
+    return false;
+  }
+  if (registers[RXMCR] & PROMI) {
+    return true;
+  }
+  if (frame_length < 3) {
+    return false;
+  }
+  uint16_t frame_control = (uint16_t) (frame[0] | frame[1] << 8);
+  uint8_t destination_addressing_mode = (uint8_t) ((frame_control >> 10) & 0x3);
+  uint8_t frame_version = (uint8_t) ((frame_control >> 12) & 0x3);
+  bool sequence_number_suppressed = frame_version == 2 && (frame_control & (1 << 8));
+  uint8_t offset = (uint8_t) (sequence_number_suppressed ? 2 : 3);
+  uint8_t address_size = 0;
+  if (destination_addressing_mode == 2) {
+    address_size = 2;
+  }
+  else if (destination_addressing_mode == 3) {
+    address_size = 8;
+  }
+  else {
+    return true;
+  }
+  if (frame_length < offset + 2 + address_size) {
+    return false;
+  }
+  const uint8_t *pan_id = frame + offset;
+  const uint8_t *address = pan_id + 2;
+  bool pan_id_matches = memcmp(pan_id, broadcast, 2) == 0
+                        || memcmp(pan_id, registers + PANIDL, 2) == 0;
+  if (!pan_id_matches) {
+    return false;
+  }
+  if (address_size == 2) {
+    return memcmp(address, broadcast, 2) == 0 || memcmp(address, registers + SADRL, 2) == 0;
+  }
+  return memcmp(address, registers + EADR0, 8) == 0;
+}
+
+/*
+ * ITU-T CRC-16 as used for the 802.15.4 fcs
+ */
+uint16_t calculateFrameCheckSequence(const uint8_t *frame, uint8_t frame_length) {
+  uint16_t crc = 0;
+  for (uint8_t i = 0; i < frame_length; i++) {
+    crc ^= frame[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (uint16_t) ((crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1);
+    }
+  }
+  return crc;
+}
+
+uint32_t getAirTime(uint8_t frame_size_including_fcs) {
+  return (uint32_t) (PHY_HEADER_SIZE + frame_size_including_fcs) * OCTET_DURATION_IN_MICROSECONDS;
+}
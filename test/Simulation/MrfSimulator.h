@@ -0,0 +1,202 @@
+#ifndef COMMUNICATIONMODULE_MRFSIMULATOR_H
+#define COMMUNICATIONMODULE_MRFSIMULATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PeripheralInterface/PeripheralInterface.h"
+
+/**
+ * Host side model of the MRF24J40 on register level.
+ *
+ * Every MrfSimulator implements the PeripheralInterface, so
+ * the driver can be created with
+ *
+ *     hardware_config.interface = MrfSimulator_getInterface(&node);
+ *
+ * instead of the spi implementation. The simulator decodes the
+ * short and long read/write commands, stores the written values
+ * in its short and long address space and models
+ *  - the tx normal fifo, transmitted by setting TXNTRIG in TXNCON
+ *  - the rx fifo, including frame length, fcs, lqi and rssi
+ *  - the interrupt status register INTSTAT (cleared on read) and
+ *    the interrupt pin, taking the masks in INTCON into account
+ *  - the address filter (RXMCR, PANID, SADR, EADR), the
+ *    channel selection in RFCON0 and disabling the receiver via
+ *    RXDECINV in BBREG1
+ *  - TXSTAT, including a failure if an acknowledgement was
+ *    requested (TXNACKREQ) and no node accepted the frame
+ *  - energy detection, started via RSSIMODE1 in BBREG6, the
+ *    result in RSSI is the energy set for the current channel
+ *  - immediate sleep via SLPACK and register wake up via REGWAKE
+ *    and IMMWAKE in WAKECON. Registers and memory are retained,
+ *    a sleeping chip neither receives nor transmits frames
+ *  - the beacon fifo of a coordinator (PANCOORD in RXMCR and a
+ *    beacon order below 15 in ORDER), sent on
+ *    MrfSimulator_transmitBeacon(), as the superframe timing is
+ *    not modelled
+ *  - the gts1 fifo in slotted mode (SLOTTED in TXMCR), triggered
+ *    via TXG1TRIG in TXG1CON and sent right after the next received
+ *    beacon, without csma-ca and retransmissions
+ *
+ * All nodes share a MrfSimulatorMedium that delivers transmitted
+ * frames to the other nodes and keeps a simulated time. Spi
+ * transfers and transmissions advance the time, so throughput
+ * and latency of the driver can be compared on the host.
+ *
+ * Everything runs in a single thread, so there is neither a spi
+ * nor an external interrupt. A non blocking transfer stays pending
+ * after writeNonBlocking()/readNonBlocking() returned, until
+ * MrfSimulator_step() (MrfSimulatorBus_step() for a shared bus)
+ * transfers the bytes and executes the callback registered via
+ * setWriteCallback()/setReadCallback(), just like the spi interrupt
+ * would. The driver busy waits for pending transfers before any
+ * blocking access, so complete them before calling a blocking
+ * function. Poll MrfSimulator_interruptIsPending() instead of the
+ * INT pin and call Mac802154MRF_handleInterrupt() if it returns true.
+ */
+
+#ifndef MRF_SIMULATOR_MAXIMUM_NUMBER_OF_NODES
+#define MRF_SIMULATOR_MAXIMUM_NUMBER_OF_NODES 8
+#endif
+
+enum {
+  MRF_SIMULATOR_SHORT_ADDRESS_SPACE_SIZE = 0x40,
+  MRF_SIMULATOR_LONG_ADDRESS_SPACE_SIZE = 0x400,
+  MRF_SIMULATOR_NUMBER_OF_CHANNELS = 16,
+};
+
+typedef struct MrfSimulator MrfSimulator;
+typedef struct MrfSimulatorMedium MrfSimulatorMedium;
+typedef struct MrfSimulatorStatistics MrfSimulatorStatistics;
+typedef struct MrfSimulatorBus MrfSimulatorBus;
+typedef struct MrfSimulatorTransfer MrfSimulatorTransfer;
+
+struct MrfSimulatorStatistics {
+  uint32_t spi_transactions;
+  uint32_t spi_bytes;
+  uint32_t frames_transmitted;
+  uint32_t frames_received;
+  uint32_t frames_filtered;
+};
+
+/**
+ * A non blocking transfer waiting for the next step.
+ * read_buffer is NULL for writes.
+ */
+struct MrfSimulatorTransfer {
+  const uint8_t *write_buffer;
+  uint8_t *read_buffer;
+  size_t length;
+  bool pending;
+};
+
+struct MrfSimulator {
+  PeripheralInterface interface;
+  MrfSimulatorMedium *medium;
+  uint8_t short_registers[MRF_SIMULATOR_SHORT_ADDRESS_SPACE_SIZE];
+  uint8_t long_memory[MRF_SIMULATOR_LONG_ADDRESS_SPACE_SIZE];
+  PeripheralInterface_Callback write_callback;
+  PeripheralInterface_Callback read_callback;
+  MrfSimulatorTransfer transfer;
+  bool selected;
+  uint8_t transaction_step;
+  bool long_address;
+  bool writing;
+  uint16_t address;
+  uint8_t rssi;
+  uint8_t link_quality;
+  uint8_t channel_energy[MRF_SIMULATOR_NUMBER_OF_CHANNELS];
+  bool sleeping;
+  bool guaranteed_time_slot_pending;
+  MrfSimulatorStatistics statistics;
+};
+
+/**
+ * Several simulated chips connected to the same spi bus.
+ * The chip is selected via the Peripheral, i.e. a driver
+ * for the MrfSimulator node is created with
+ *
+ *     hardware_config.interface = MrfSimulatorBus_getInterface(&bus);
+ *     hardware_config.device = &node;
+ *
+ * Bytes transferred while no chip is selected are lost.
+ */
+struct MrfSimulatorBus {
+  PeripheralInterface interface;
+  MrfSimulator *selected;
+  PeripheralInterface_Callback write_callback;
+  PeripheralInterface_Callback read_callback;
+  MrfSimulatorTransfer transfer;
+};
+
+struct MrfSimulatorMedium {
+  MrfSimulator *nodes[MRF_SIMULATOR_MAXIMUM_NUMBER_OF_NODES];
+  uint8_t number_of_nodes;
+  uint32_t time_in_microseconds;
+  uint8_t spi_byte_duration_in_microseconds;
+};
+
+/**
+ * Initializes an empty medium. Spi transfers take one
+ * microsecond per byte by default, i.e. a spi clock of 8MHz.
+ */
+void MrfSimulatorMedium_init(MrfSimulatorMedium *medium);
+void MrfSimulatorMedium_advanceTime(MrfSimulatorMedium *medium, uint32_t microseconds);
+uint32_t MrfSimulatorMedium_getTimeInMicroseconds(const MrfSimulatorMedium *medium);
+
+/**
+ * Sets up the simulated chip in the state after a power on
+ * reset and attaches it to the medium.
+ */
+void MrfSimulator_create(MrfSimulator *self, MrfSimulatorMedium *medium);
+PeripheralInterface *MrfSimulator_getInterface(MrfSimulator *self);
+
+/**
+ * true if an interrupt flag is set in INTSTAT that
+ * is enabled in INTCON, i.e. the INT pin is active
+ */
+bool MrfSimulator_interruptIsPending(const MrfSimulator *self);
+
+bool MrfSimulator_isSleeping(const MrfSimulator *self);
+
+/**
+ * Completes the pending non blocking transfer and executes its
+ * callback, which usually starts the next transfer.
+ * @return false if no transfer was pending
+ */
+bool MrfSimulator_step(MrfSimulator *self);
+
+/**
+ * Places a frame in the rx fifo as if it was received over the air.
+ * The frame is passed without fcs, the address filter is applied.
+ * @return false if the frame was filtered
+ */
+bool MrfSimulator_receiveFrame(MrfSimulator *self, const uint8_t *frame, uint8_t frame_length);
+
+/**
+ * Sets the values appended to each frame received from now on.
+ */
+void MrfSimulator_setLinkQualityAndRssi(MrfSimulator *self, uint8_t link_quality, uint8_t rssi);
+
+/**
+ * Sets the value measured by energy detection on
+ * the channel (11-26), zero for all channels by default.
+ */
+void MrfSimulator_setChannelEnergy(MrfSimulator *self, uint8_t channel, uint8_t energy);
+
+/**
+ * Sends the beacon fifo, as a coordinator of a beacon-enabled
+ * pan does at the start of every superframe.
+ * @return false if the chip is not set up to send beacons
+ */
+bool MrfSimulator_transmitBeacon(MrfSimulator *self);
+
+void MrfSimulatorBus_init(MrfSimulatorBus *bus);
+PeripheralInterface *MrfSimulatorBus_getInterface(MrfSimulatorBus *bus);
+bool MrfSimulatorBus_step(MrfSimulatorBus *bus);
+
+uint8_t MrfSimulator_getShortRegister(const MrfSimulator *self, uint8_t address);
+uint8_t MrfSimulator_getLongRegister(const MrfSimulator *self, uint16_t address);
+const MrfSimulatorStatistics *MrfSimulator_getStatistics(const MrfSimulator *self);
+
+#endif //COMMUNICATIONMODULE_MRFSIMULATOR_H
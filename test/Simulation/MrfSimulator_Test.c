@@ -0,0 +1,1030 @@
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "CommunicationModule/CommunicationModule.h"
+#include "test/Simulation/MrfSimulator.h"
+
+/*
+ * These tests run the actual driver against two
+ * simulated MRF24J40s sharing one medium.
+ */
+
+void debug(const uint8_t *message) {}
+
+static MrfSimulatorMedium medium;
+static MrfSimulator sender_chip;
+static MrfSimulator receiver_chip;
+static Mac802154 *sender;
+static Mac802154 *receiver;
+
+static const uint8_t pan_id[2] = {0x34, 0x12};
+static const uint8_t sender_address[2] = {0x01, 0x00};
+static const uint8_t receiver_address[2] = {0x02, 0x00};
+static const uint8_t receiver_extended_address[8] = {0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02};
+
+static void
+advanceSimulatedTime(uint16_t microseconds)
+{
+  MrfSimulatorMedium_advanceTime(&medium, microseconds);
+}
+
+static Mac802154 *
+createNodeOnInterface(MrfSimulator *chip,
+                      const uint8_t *short_address,
+                      uint8_t channel,
+                      PeripheralInterface *interface,
+                      Peripheral *device)
+{
+  MrfSimulator_create(chip, &medium);
+  MRFConfig hardware_config = {
+    .transmitter_power = 0,
+    .reset_line = {
+      .data_direction_register = NULL,
+      .data_register = NULL,
+      .pin_number = 0,
+    },
+    .delay_microseconds = advanceSimulatedTime,
+    .interface = interface,
+    .device = device,
+  };
+  Mac802154Config config = {
+    .channel = channel,
+  };
+  memcpy(config.pan_id, pan_id, 2);
+  memcpy(config.short_source_address, short_address, 2);
+  memset(config.extended_source_address, short_address[0], 8);
+  Mac802154 *node = malloc(Mac802154MRF_getADTSize());
+  Mac802154MRF_create(node, &hardware_config);
+  Mac802154_configure(node, &config);
+  return node;
+}
+
+static Mac802154 *
+createNode(MrfSimulator *chip, const uint8_t *short_address)
+{
+  return createNodeOnInterface(chip, short_address, 12, MrfSimulator_getInterface(chip), NULL);
+}
+
+void
+setUp(void)
+{
+  MrfSimulatorMedium_init(&medium);
+  sender = createNode(&sender_chip, sender_address);
+  receiver = createNode(&receiver_chip, receiver_address);
+}
+
+void
+tearDown(void)
+{
+  free(sender);
+  free(receiver);
+}
+
+static void
+completeTransfers(MrfSimulator *chip)
+{
+  while (MrfSimulator_step(chip)) {}
+}
+
+static void
+sendBlockingTo(const uint8_t *destination, const uint8_t *payload, uint8_t payload_length)
+{
+  Mac802154_setShortDestinationAddress(sender, destination);
+  Mac802154_setPayload(sender, payload, payload_length);
+  Mac802154_sendBlocking(sender);
+}
+
+void
+test_blockingTransmissionIsReceivedByAddressedNode(void)
+{
+  const uint8_t payload[] = "hello";
+  sendBlockingTo(receiver_address, payload, 5);
+
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(5, Mac802154_getPacketPayloadSize(receiver, packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, Mac802154_getPacketPayload(receiver, packet), 5);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(sender_address, Mac802154_getPacketShortSourceAddress(receiver, packet), 2);
+}
+
+void
+test_payloadVectorIsReceivedAsOnePayload(void)
+{
+  const uint8_t protocol_header[] = {0xC1, 0x02};
+  uint8_t sensor_data[] = "21.5C";
+  Mac802154PayloadSegment segments[2] = {
+    {.data = protocol_header, .length = 2},
+    {.data = sensor_data, .length = 5},
+  };
+  uint8_t expected_payload[] = {0xC1, 0x02, '2', '1', '.', '5', 'C'};
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayloadVector(sender, segments, 2);
+  Mac802154_sendBlocking(sender);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(7, Mac802154_getPacketPayloadSize(receiver, packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_payload, Mac802154_getPacketPayload(receiver, packet), 7);
+
+  sensor_data[3] = '7';
+  expected_payload[5] = '7';
+  Mac802154_setPayloadVector(sender, segments, 2);
+  Mac802154_sendNonBlocking(sender);
+  completeTransfers(&sender_chip);
+  Mac802154MRF_handleInterrupt(sender);
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_payload, Mac802154_getPacketPayload(receiver, packet), 7);
+}
+
+void
+test_frameViewOfReceivedPacketMatchesPacketAccessors(void)
+{
+  const uint8_t payload[] = "hello";
+  Mac802154_setExtendedDestinationAddress(sender, receiver_extended_address);
+  Mac802154_useExtendedSourceAddress(sender);
+  Mac802154_setPayload(sender, payload, 5);
+  MrfSimulator_setLinkQualityAndRssi(&receiver_chip, 0xAB, 0x42);
+  Mac802154_sendBlocking(sender);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t size = Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  Mac802154FrameView view;
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(receiver, packet, size, &view));
+  TEST_ASSERT_EQUAL_PTR(Mac802154_getPacketPayload(receiver, packet), Mac802154FrameView_getPayload(&view));
+  TEST_ASSERT_EQUAL_UINT8(Mac802154_getPacketPayloadSize(receiver, packet), Mac802154FrameView_getPayloadSize(&view));
+  TEST_ASSERT_EQUAL_PTR(Mac802154_getPacketExtendedSourceAddress(receiver, packet),
+                        Mac802154FrameView_getSourceAddress(&view));
+  TEST_ASSERT_EQUAL_UINT8(8, Mac802154FrameView_getSourceAddressSize(&view));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(receiver_extended_address, Mac802154FrameView_getDestinationAddress(&view), 8);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(pan_id, Mac802154FrameView_getPanId(&view), 2);
+  TEST_ASSERT_EQUAL_HEX8(0xAB, *Mac802154FrameView_getLinkQuality(&view));
+  TEST_ASSERT_EQUAL_HEX8(0x42, *Mac802154FrameView_getRssi(&view));
+}
+
+void
+test_acknowledgedTransmissionSucceedsWithoutRetries(void)
+{
+  const uint8_t payload[] = "hello";
+  Mac802154_enableAcknowledgement(sender);
+  sendBlockingTo(receiver_address, payload, 5);
+
+  Mac802154TransmissionStatus status;
+  Mac802154_getTransmissionStatus(sender, &status);
+  TEST_ASSERT_TRUE(status.success);
+  TEST_ASSERT_EQUAL_UINT8(0, status.retries);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+}
+
+void
+test_missingAcknowledgementIsReportedAfterRetries(void)
+{
+  const uint8_t payload[] = "hello";
+  const uint8_t absent_address[2] = {0x03, 0x00};
+  Mac802154_enableAcknowledgement(sender);
+  sendBlockingTo(absent_address, payload, 5);
+
+  Mac802154TransmissionStatus status;
+  Mac802154_getTransmissionStatus(sender, &status);
+  TEST_ASSERT_FALSE(status.success);
+  TEST_ASSERT_FALSE(status.channel_busy);
+  TEST_ASSERT_EQUAL_UINT8(3, status.retries);
+  TEST_ASSERT_EQUAL_UINT32(1, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+}
+
+void
+test_busyChannelIsReportedAsChannelAccessFailure(void)
+{
+  const uint8_t payload[] = "hello";
+  MrfSimulator_setChannelEnergy(&sender_chip, 12, 0x80);
+  sendBlockingTo(receiver_address, payload, 5);
+
+  Mac802154TransmissionStatus status;
+  Mac802154_getTransmissionStatus(sender, &status);
+  TEST_ASSERT_FALSE(status.success);
+  TEST_ASSERT_TRUE(status.channel_busy);
+  TEST_ASSERT_FALSE(Mac802154_newPacketAvailable(receiver));
+}
+
+void
+test_higherEnergyDetectionThresholdAllowsSendingOnNoisyChannel(void)
+{
+  const uint8_t payload[] = "hello";
+  Mac802154Config config = {
+    .channel = 12,
+    .clear_channel_assessment_mode = MAC802154_CCA_MODE_ENERGY_DETECTION,
+    .energy_detection_threshold = 0xA0,
+    .minimum_backoff_exponent = 3,
+    .maximum_csma_backoffs = 2,
+    .custom_backoffs = true,
+  };
+  memcpy(config.pan_id, pan_id, 2);
+  memcpy(config.short_source_address, sender_address, 2);
+  memset(config.extended_source_address, sender_address[0], 8);
+  Mac802154_configure(sender, &config);
+  MrfSimulator_setChannelEnergy(&sender_chip, 12, 0x80);
+  sendBlockingTo(receiver_address, payload, 5);
+
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+  TEST_ASSERT_EQUAL_HEX8(0xA0, MrfSimulator_getShortRegister(&sender_chip, 0x3F));
+  TEST_ASSERT_EQUAL_HEX8((3 << 3) | 2, MrfSimulator_getShortRegister(&sender_chip, 0x11));
+}
+
+void
+test_zeroBackoffsCanBeConfigured(void)
+{
+  Mac802154Config config = {
+    .channel = 12,
+    .minimum_backoff_exponent = 0,
+    .maximum_csma_backoffs = 0,
+    .custom_backoffs = true,
+  };
+  memcpy(config.pan_id, pan_id, 2);
+  memcpy(config.short_source_address, sender_address, 2);
+  Mac802154_configure(sender, &config);
+  TEST_ASSERT_EQUAL_HEX8(0x00, MrfSimulator_getShortRegister(&sender_chip, 0x11));
+
+  config.custom_backoffs = false;
+  Mac802154_configure(sender, &config);
+  TEST_ASSERT_EQUAL_HEX8((3 << 3) | 4, MrfSimulator_getShortRegister(&sender_chip, 0x11));
+}
+
+void
+test_transmitterPowerIsKeptWhenReconfiguring(void)
+{
+  Mac802154Config config = {
+    .channel = 12,
+  };
+  memcpy(config.pan_id, pan_id, 2);
+  memcpy(config.short_source_address, sender_address, 2);
+  Mac802154MRF_setTransmitterPower(sender, MRF_TRANSMITTER_POWER_MINUS_20DB);
+  for (uint8_t i = 0; i < 3; i++) {
+    Mac802154MRF_adaptTransmitterPower(sender, 0xFF);
+  }
+  Mac802154_configure(sender, &config);
+  TEST_ASSERT_EQUAL_HEX8((MRF_TRANSMITTER_POWER_MINUS_20DB + 3) << 3,
+                         MrfSimulator_getLongRegister(&sender_chip, 0x203));
+
+  Mac802154MRF_adaptTransmitterPower(sender, 0);
+  TEST_ASSERT_EQUAL_UINT8(MRF_TRANSMITTER_POWER_MINUS_20DB, Mac802154MRF_getTransmitterPower(sender));
+  TEST_ASSERT_EQUAL_HEX8(MRF_TRANSMITTER_POWER_MINUS_20DB << 3, MrfSimulator_getLongRegister(&sender_chip, 0x203));
+}
+
+void
+test_channelAccessStatisticsCountOutcomes(void)
+{
+#if MRF_CHANNEL_ACCESS_STATISTICS
+  const uint8_t payload[] = "hello";
+  const uint8_t absent_address[2] = {0x03, 0x00};
+  Mac802154_enableAcknowledgement(sender);
+  sendBlockingTo(receiver_address, payload, 5);
+  sendBlockingTo(absent_address, payload, 5);
+  MrfSimulator_setChannelEnergy(&sender_chip, 12, 0x80);
+  sendBlockingTo(receiver_address, payload, 5);
+
+  Mac802154ChannelAccessStatistics statistics;
+  Mac802154_getChannelAccessStatistics(sender, &statistics);
+  TEST_ASSERT_EQUAL_UINT16(3, statistics.frames);
+  TEST_ASSERT_EQUAL_UINT16(1, statistics.channel_access_failures);
+  TEST_ASSERT_EQUAL_UINT16(1, statistics.acknowledgement_failures);
+  TEST_ASSERT_EQUAL_UINT16(3, statistics.retransmissions);
+#endif
+}
+
+void
+test_acknowledgementRequestIsSetInTransmittedFrame(void)
+{
+  const uint8_t payload[] = "hello";
+  Mac802154_enableAcknowledgement(sender);
+  sendBlockingTo(receiver_address, payload, 5);
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_BIT_HIGH(5, packet[1]);
+
+  Mac802154_disableAcknowledgement(sender);
+  sendBlockingTo(receiver_address, payload, 5);
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_BIT_LOW(5, packet[1]);
+}
+
+void
+test_sequenceNumberIsIncrementedForEveryFrame(void)
+{
+  const uint8_t payload[] = "hello";
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  sendBlockingTo(receiver_address, payload, 5);
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  uint8_t first_sequence_number = packet[3];
+  sendBlockingTo(receiver_address, payload, 5);
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(first_sequence_number + 1, packet[3]);
+}
+
+void
+test_retransmittedFrameIsQueuedOnlyOnce(void)
+{
+  const uint8_t frame[] = {0x41, 0x88, 0x07, 0x34, 0x12, 0x02, 0x00, 0x01, 0x00, 'a'};
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_TRUE(MrfSimulator_receiveFrame(&receiver_chip, frame, sizeof(frame)));
+    Mac802154MRF_handleInterrupt(receiver);
+  }
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(receiver));
+}
+
+void
+test_energyScanFindsQuietestChannel(void)
+{
+  uint8_t energy[MAC802154_NUMBER_OF_CHANNELS];
+  for (uint8_t channel = 11; channel <= 26; channel++) {
+    MrfSimulator_setChannelEnergy(&receiver_chip, channel, 0x80);
+  }
+  MrfSimulator_setChannelEnergy(&receiver_chip, 15, 0x20);
+  MrfSimulator_setChannelEnergy(&receiver_chip, 20, 0xF0);
+  Mac802154_scanEnergy(receiver, 2, energy);
+  TEST_ASSERT_EQUAL_UINT8(0x20, energy[15 - MAC802154_FIRST_CHANNEL]);
+  TEST_ASSERT_EQUAL_UINT8(0xF0, energy[20 - MAC802154_FIRST_CHANNEL]);
+  TEST_ASSERT_EQUAL_UINT8(15, Mac802154_getQuietestChannel(energy));
+}
+
+void
+test_energyScanRestoresChannel(void)
+{
+  uint8_t energy[MAC802154_NUMBER_OF_CHANNELS];
+  const uint8_t payload[] = "hello";
+  Mac802154_scanEnergy(receiver, 1, energy);
+  sendBlockingTo(receiver_address, payload, 5);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+}
+
+void
+test_frameForDifferentAddressIsFiltered(void)
+{
+  const uint8_t payload[] = "hello";
+  const uint8_t other_address[2] = {0x03, 0x00};
+  sendBlockingTo(other_address, payload, 5);
+
+  TEST_ASSERT_FALSE(Mac802154_newPacketAvailable(receiver));
+  TEST_ASSERT_EQUAL_UINT32(1, MrfSimulator_getStatistics(&receiver_chip)->frames_filtered);
+}
+
+void
+test_beaconIsDroppedByHardwareIfOnlyDataFramesAreReceived(void)
+{
+  const uint8_t beacon[] = {0x00, 0x80, 0x07, 0x34, 0x12, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00};
+  const uint8_t data[] = {0x41, 0x88, 0x08, 0x34, 0x12, 0x02, 0x00, 0x01, 0x00, 'a'};
+  Mac802154ReceiveFilter filter = {
+    .frame_types = MAC802154_RECEIVE_DATA_FRAMES,
+  };
+  Mac802154_setReceiveFilter(receiver, &filter);
+  TEST_ASSERT_FALSE(MrfSimulator_receiveFrame(&receiver_chip, beacon, sizeof(beacon)));
+  TEST_ASSERT_FALSE(MrfSimulator_interruptIsPending(&receiver_chip));
+  TEST_ASSERT_TRUE(MrfSimulator_receiveFrame(&receiver_chip, data, sizeof(data)));
+  Mac802154MRF_handleInterrupt(receiver);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(receiver));
+}
+
+void
+test_softwareFilterDropsFramesOfOtherPansInPromiscuousMode(void)
+{
+  const uint8_t other_pan[] = {0x41, 0x88, 0x07, 0x78, 0x56, 0x02, 0x00, 0x01, 0x00, 'a'};
+  const uint8_t own_pan[] = {0x41, 0x88, 0x08, 0x34, 0x12, 0x09, 0x00, 0x01, 0x00, 'b'};
+  const uint8_t command[] = {0x43, 0x88, 0x09, 0x34, 0x12, 0x02, 0x00, 0x01, 0x00, 0x04};
+  Mac802154ReceiveFilter filter = {
+    .frame_types = MAC802154_RECEIVE_DATA_FRAMES | MAC802154_RECEIVE_BEACON_FRAMES,
+    .own_pan_id_only = true,
+  };
+  Mac802154_setReceiveFilter(receiver, &filter);
+  Mac802154_enablePromiscuousMode(receiver);
+  const uint8_t *frames[] = {other_pan, own_pan, command};
+  for (uint8_t i = 0; i < 3; i++) {
+    TEST_ASSERT_TRUE(MrfSimulator_receiveFrame(&receiver_chip, frames[i], sizeof(own_pan)));
+    Mac802154MRF_handleInterrupt(receiver);
+  }
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(receiver));
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8('b', *Mac802154_getPacketPayload(receiver, packet));
+}
+
+void
+test_associationIsExchangedAsMacCommands(void)
+{
+  uint8_t command[MAC802154_MAXIMUM_COMMAND_SIZE];
+  uint8_t command_size = Mac802154Command_writeAssociationRequest(command, MAC802154_CAPABILITY_ALLOCATE_ADDRESS);
+  Mac802154_setFrameType(sender, FRAME_TYPE_MAC_COMMAND);
+  sendBlockingTo(receiver_address, command, command_size);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154FrameView view;
+  uint8_t size = Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(receiver, packet, size, &view));
+  TEST_ASSERT_EQUAL_UINT8(FRAME_TYPE_MAC_COMMAND, Mac802154FrameView_getFrameType(&view));
+  uint8_t capabilities = 0;
+  TEST_ASSERT_TRUE(Mac802154Command_parseAssociationRequest(Mac802154FrameView_getPayload(&view),
+                                                            Mac802154FrameView_getPayloadSize(&view),
+                                                            &capabilities));
+  TEST_ASSERT_EQUAL_HEX8(MAC802154_CAPABILITY_ALLOCATE_ADDRESS, capabilities);
+
+  Mac802154_setFrameType(sender, FRAME_TYPE_DATA);
+  sendBlockingTo(receiver_address, command, command_size);
+  size = Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(receiver, packet, size, &view));
+  TEST_ASSERT_EQUAL_UINT8(FRAME_TYPE_DATA, Mac802154FrameView_getFrameType(&view));
+}
+
+void
+test_beaconIsReceivedByNodeWaitingForBeacons(void)
+{
+  const uint8_t broadcast_address[2] = {0xFF, 0xFF};
+  const uint8_t network_name[] = "net";
+  Mac802154Beacon beacon = {
+    .beacon_order = 15,
+    .superframe_order = 15,
+    .final_cap_slot = 15,
+    .association_permit = true,
+    .payload = network_name,
+    .payload_size = 3,
+  };
+  uint8_t payload[4 + 3];
+  uint8_t size = Mac802154Beacon_write(payload, &beacon);
+  Mac802154ReceiveFilter filter = {
+    .frame_types = MAC802154_RECEIVE_BEACON_FRAMES,
+  };
+  Mac802154_setReceiveFilter(receiver, &filter);
+  Mac802154_setFrameType(sender, FRAME_TYPE_BEACON);
+  sendBlockingTo(broadcast_address, payload, size);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154FrameView view;
+  size = Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_TRUE(Mac802154_parsePacket(receiver, packet, size, &view));
+  Mac802154Beacon received;
+  TEST_ASSERT_TRUE(Mac802154Beacon_parse(Mac802154FrameView_getPayload(&view),
+                                         Mac802154FrameView_getPayloadSize(&view),
+                                         &received));
+  TEST_ASSERT_TRUE(received.association_permit);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(network_name, received.payload, 3);
+}
+
+static bool
+receiveBeacon(Mac802154 *node, Mac802154Beacon *beacon)
+{
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154FrameView view;
+  uint8_t size = Mac802154_fetchCompletePacketBlocking(node, packet, sizeof(packet));
+  return Mac802154_parsePacket(node, packet, size, &view)
+         && Mac802154FrameView_getFrameType(&view) == FRAME_TYPE_BEACON
+         && Mac802154Beacon_parse(Mac802154FrameView_getPayload(&view),
+                                  Mac802154FrameView_getPayloadSize(&view),
+                                  beacon);
+}
+
+void
+test_deviceSendsInGuaranteedTimeSlotAfterJoiningBeaconEnabledPan(void)
+{
+  const uint8_t network_name[] = "net";
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 4,
+    .final_cap_slot = 13,
+    .pan_coordinator = true,
+    .number_of_guaranteed_time_slots = 1,
+    .guaranteed_time_slots = {
+      {.short_address = {0x02, 0x00}, .starting_slot = 14, .length = 2},
+    },
+    .payload = network_name,
+    .payload_size = 3,
+  };
+  TEST_ASSERT_TRUE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  TEST_ASSERT_TRUE(MrfSimulator_transmitBeacon(&sender_chip));
+
+  Mac802154Beacon received;
+  TEST_ASSERT_TRUE(receiveBeacon(receiver, &received));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(network_name, received.payload, 3);
+  TEST_ASSERT_TRUE(Mac802154MRF_joinBeaconEnabledPan(receiver, &received));
+  TEST_ASSERT_EQUAL_HEX8(0x64, MrfSimulator_getShortRegister(&receiver_chip, 0x10));
+  // CAP ends in slot 13, the guaranteed time slot in slot 15
+  TEST_ASSERT_EQUAL_HEX8(0xFD, MrfSimulator_getShortRegister(&receiver_chip, 0x13));
+
+  const uint8_t payload[] = "gts";
+  Mac802154_setShortDestinationAddress(receiver, sender_address);
+  Mac802154_setPayload(receiver, payload, 3);
+  TEST_ASSERT_TRUE(Mac802154MRF_sendInGuaranteedTimeSlot(receiver));
+  TEST_ASSERT_FALSE(Mac802154_newPacketAvailable(sender));
+
+  MrfSimulator_transmitBeacon(&sender_chip);
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(sender));
+  Mac802154_fetchCompletePacketBlocking(sender, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, Mac802154_getPacketPayload(sender, packet), 3);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(receiver_address, Mac802154_getPacketShortSourceAddress(sender, packet), 2);
+}
+
+void
+test_coordinatorRejectsBeaconExceedingFrameSize(void)
+{
+  static const uint8_t payload[115] = {0};
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 6,
+    .final_cap_slot = 15,
+    .payload = payload,
+    .payload_size = sizeof(payload),
+  };
+  TEST_ASSERT_FALSE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  TEST_ASSERT_FALSE(MrfSimulator_transmitBeacon(&sender_chip));
+
+  // header, superframe specification, gts and pending address
+  // fields and the frame check sequence fill the frame exactly
+  beacon.payload_size--;
+  TEST_ASSERT_TRUE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  TEST_ASSERT_TRUE(MrfSimulator_transmitBeacon(&sender_chip));
+  Mac802154Beacon received;
+  TEST_ASSERT_TRUE(receiveBeacon(receiver, &received));
+  TEST_ASSERT_EQUAL_UINT8(sizeof(payload) - 1, received.payload_size);
+}
+
+void
+test_deviceWithoutGuaranteedTimeSlotCannotSendInIt(void)
+{
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 6,
+    .final_cap_slot = 15,
+  };
+  TEST_ASSERT_TRUE(Mac802154MRF_joinBeaconEnabledPan(receiver, &beacon));
+  TEST_ASSERT_FALSE(Mac802154MRF_sendInGuaranteedTimeSlot(receiver));
+}
+
+void
+test_coordinatorStopsSendingBeaconsAfterLeavingPan(void)
+{
+  Mac802154Beacon beacon = {
+    .beacon_order = 6,
+    .superframe_order = 6,
+    .final_cap_slot = 15,
+  };
+  TEST_ASSERT_TRUE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  Mac802154MRF_leaveBeaconEnabledPan(sender);
+  TEST_ASSERT_FALSE(MrfSimulator_transmitBeacon(&sender_chip));
+
+  const uint8_t payload[] = "hello";
+  sendBlockingTo(receiver_address, payload, 5);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+}
+
+void
+test_nonbeaconEnabledOrdersAreRejected(void)
+{
+  Mac802154Beacon beacon = {
+    .beacon_order = 15,
+    .superframe_order = 15,
+    .final_cap_slot = 15,
+  };
+  TEST_ASSERT_FALSE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  TEST_ASSERT_FALSE(Mac802154MRF_joinBeaconEnabledPan(receiver, &beacon));
+  beacon.beacon_order = 4;
+  beacon.superframe_order = 5;
+  TEST_ASSERT_FALSE(Mac802154MRF_startBeaconEnabledPan(sender, &beacon));
+  TEST_ASSERT_FALSE(MrfSimulator_transmitBeacon(&sender_chip));
+}
+
+static void
+countCalls(void *argument)
+{
+  uint8_t *counter = argument;
+  (*counter)++;
+}
+
+void
+test_nonBlockingTransmissionIsQueuedAtReceiver(void)
+{
+  const uint8_t payload[] = "abc";
+  uint8_t transmission_complete_calls = 0;
+  Mac802154Callback callback = {
+    .function = countCalls,
+    .argument = &transmission_complete_calls,
+  };
+  Mac802154_setTransmissionCompleteCallback(sender, callback);
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayload(sender, payload, 3);
+  MrfSimulator_setLinkQualityAndRssi(&receiver_chip, 0xAB, 0x42);
+
+  Mac802154_sendNonBlocking(sender);
+  TEST_ASSERT_FALSE(MrfSimulator_interruptIsPending(&sender_chip));
+  completeTransfers(&sender_chip);
+  TEST_ASSERT_TRUE(MrfSimulator_interruptIsPending(&sender_chip));
+  Mac802154MRF_handleInterrupt(sender);
+  TEST_ASSERT_EQUAL_UINT8(1, transmission_complete_calls);
+
+  TEST_ASSERT_TRUE(MrfSimulator_interruptIsPending(&receiver_chip));
+  Mac802154MRF_handleInterrupt(receiver);
+  TEST_ASSERT_FALSE(MrfSimulator_interruptIsPending(&receiver_chip));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(receiver));
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  uint8_t packet_size = Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, Mac802154_getPacketPayload(receiver, packet), 3);
+  TEST_ASSERT_EQUAL_HEX8(0xAB, packet[packet_size - 2]);
+  TEST_ASSERT_EQUAL_HEX8(0x42, packet[packet_size - 1]);
+}
+
+enum {
+  MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING = MRF_IO_TRANSFER_QUEUE_SIZE - 4,
+};
+
+static void
+setSegmentedPayload(Mac802154PayloadSegment *segments, uint8_t number_of_segments, const uint8_t *data)
+{
+  for (uint8_t i = 0; i < number_of_segments; i++) {
+    segments[i].data = data + i;
+    segments[i].length = 1;
+  }
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayloadVector(sender, segments, number_of_segments);
+}
+
+void
+test_sendNonBlockingFailsIfSegmentsDoNotFitIntoTransferQueue(void)
+{
+  const uint8_t data[] = "abcdefgh";
+  uint8_t number_of_segments = MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING + 1;
+  Mac802154PayloadSegment segments[MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING + 1];
+  setSegmentedPayload(segments, number_of_segments, data);
+  TEST_ASSERT_FALSE(Mac802154_sendNonBlocking(sender));
+  TEST_ASSERT_FALSE(MrfSimulator_step(&sender_chip));
+
+  Mac802154_sendBlocking(sender);
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8(number_of_segments, Mac802154_getPacketPayloadSize(receiver, packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, Mac802154_getPacketPayload(receiver, packet), number_of_segments);
+}
+
+void
+test_sendNonBlockingFailsWhileTransferQueueIsFull(void)
+{
+  const uint8_t data[] = "abcdefgh";
+  Mac802154PayloadSegment segments[MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING];
+  setSegmentedPayload(segments, MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING, data);
+  TEST_ASSERT_TRUE(Mac802154_sendNonBlocking(sender));
+  TEST_ASSERT_FALSE(Mac802154_sendNonBlocking(sender));
+
+  completeTransfers(&sender_chip);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(receiver));
+  TEST_ASSERT_EQUAL_UINT32(1, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, Mac802154_getPacketPayload(receiver, packet),
+                                MAXIMUM_NUMBER_OF_SEGMENTS_SENT_NON_BLOCKING);
+
+  TEST_ASSERT_TRUE(Mac802154_sendNonBlocking(sender));
+  completeTransfers(&sender_chip);
+  TEST_ASSERT_EQUAL_UINT32(2, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+}
+
+void
+test_queuedFramesAreTransmittedBackToBack(void)
+{
+  const uint8_t payloads[3][4] = {"abc", "defg", "hi"};
+  const uint8_t payload_lengths[3] = {3, 4, 2};
+  Mac802154Frame frame = {
+    .destination_address = {receiver_address[0], receiver_address[1]},
+    .destination_address_size = 2,
+  };
+  for (uint8_t i = 0; i < 3; i++) {
+    frame.payload = payloads[i];
+    frame.payload_length = payload_lengths[i];
+    TEST_ASSERT_TRUE(Mac802154_enqueueFrame(sender, &frame));
+  }
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  for (uint8_t i = 0; i < 3; i++) {
+    completeTransfers(&sender_chip);
+    TEST_ASSERT_TRUE(MrfSimulator_interruptIsPending(&receiver_chip));
+    Mac802154MRF_handleInterrupt(receiver);
+    Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+    TEST_ASSERT_EQUAL_UINT8(payload_lengths[i], Mac802154_getPacketPayloadSize(receiver, packet));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payloads[i], Mac802154_getPacketPayload(receiver, packet), payload_lengths[i]);
+    Mac802154MRF_handleInterrupt(sender);
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfFramesToSend(sender));
+  TEST_ASSERT_EQUAL_UINT32(3, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+}
+
+void
+test_frameQueuedWhileSendingNonBlockingIsSentAfterwards(void)
+{
+  const uint8_t direct_payload[] = "direct";
+  const uint8_t queued_payload[] = "queued";
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayload(sender, direct_payload, 6);
+  TEST_ASSERT_TRUE(Mac802154_sendNonBlocking(sender));
+  Mac802154Frame frame = {
+    .destination_address = {receiver_address[0], receiver_address[1]},
+    .destination_address_size = 2,
+    .payload = queued_payload,
+    .payload_length = 6,
+  };
+  TEST_ASSERT_TRUE(Mac802154_enqueueFrame(sender, &frame));
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  completeTransfers(&sender_chip);
+  Mac802154MRF_handleInterrupt(receiver);
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(direct_payload, Mac802154_getPacketPayload(receiver, packet), 6);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfFramesToSend(sender));
+
+  completeTransfers(&sender_chip);
+  Mac802154MRF_handleInterrupt(receiver);
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(queued_payload, Mac802154_getPacketPayload(receiver, packet), 6);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfFramesToSend(sender));
+  TEST_ASSERT_EQUAL_UINT32(2, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+}
+
+void
+test_packetStaysInMrfWhileReceiveQueueIsFull(void)
+{
+  const uint8_t payloads[3][2] = {"a", "b", "c"};
+  for (uint8_t i = 0; i < 3; i++) {
+    sendBlockingTo(receiver_address, payloads[i], 1);
+    Mac802154MRF_handleInterrupt(receiver);
+  }
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154_getNumberOfQueuedPackets(receiver));
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  Mac802154MRF_handleInterrupt(receiver);
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154_getNumberOfQueuedPackets(receiver));
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payloads[2], Mac802154_getPacketPayload(receiver, packet), 1);
+}
+
+static void
+sendBlockingFromReceiverToSender(const uint8_t *payload, uint8_t payload_length)
+{
+  Mac802154_setShortDestinationAddress(receiver, sender_address);
+  Mac802154_setPayload(receiver, payload, payload_length);
+  Mac802154_sendBlocking(receiver);
+}
+
+void
+test_interruptIsDeferredWhileNonBlockingTransfersAreRunning(void)
+{
+  const uint8_t payload[] = "abc";
+  const uint8_t reply[] = "reply";
+  uint8_t transmission_complete_calls = 0;
+  Mac802154Callback callback = {
+    .function = countCalls,
+    .argument = &transmission_complete_calls,
+  };
+  Mac802154_setTransmissionCompleteCallback(sender, callback);
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayload(sender, payload, 3);
+  Mac802154_sendNonBlocking(sender);
+  sendBlockingFromReceiverToSender(reply, 5);
+
+  TEST_ASSERT_TRUE(MrfSimulator_interruptIsPending(&sender_chip));
+  TEST_ASSERT_FALSE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfQueuedPackets(sender));
+
+  completeTransfers(&sender_chip);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(1, transmission_complete_calls);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(sender));
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(receiver));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(receiver));
+}
+
+void
+test_packetReceivedTogetherWithTransmissionCompleteIsReadBeforeNextQueuedFrame(void)
+{
+  const uint8_t payloads[2][4] = {"abc", "defg"};
+  const uint8_t reply[] = "reply";
+  Mac802154Frame frame = {
+    .destination_address = {receiver_address[0], receiver_address[1]},
+    .destination_address_size = 2,
+  };
+  for (uint8_t i = 0; i < 2; i++) {
+    frame.payload = payloads[i];
+    frame.payload_length = 3 + i;
+    TEST_ASSERT_TRUE(Mac802154_enqueueFrame(sender, &frame));
+  }
+  completeTransfers(&sender_chip);
+  Mac802154MRF_handleInterrupt(receiver);
+  sendBlockingFromReceiverToSender(reply, 5);
+
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(sender));
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfFramesToSend(sender));
+  completeTransfers(&sender_chip);
+  TEST_ASSERT_TRUE(Mac802154MRF_handleInterrupt(sender));
+  TEST_ASSERT_EQUAL_UINT8(0, Mac802154_getNumberOfFramesToSend(sender));
+  Mac802154MRF_handleInterrupt(receiver);
+  TEST_ASSERT_EQUAL_UINT8(2, Mac802154_getNumberOfQueuedPackets(receiver));
+}
+
+void
+test_linkQualityOfSenderIsTrackedByReceiver(void)
+{
+  const uint8_t payload[] = "abc";
+  Mac802154LinkQuality quality;
+  Mac802154_setShortDestinationAddress(sender, receiver_address);
+  Mac802154_setPayload(sender, payload, 3);
+  MrfSimulator_setLinkQualityAndRssi(&receiver_chip, 0xC0, 0x50);
+  Mac802154_sendBlocking(sender);
+  Mac802154MRF_handleInterrupt(receiver);
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  Mac802154_dequeuePacket(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_HEX8(0xC0, Mac802154_getPacketLinkQuality(receiver, packet));
+  TEST_ASSERT_EQUAL_HEX8(0x50, Mac802154_getPacketRssi(receiver, packet));
+  TEST_ASSERT_TRUE(Mac802154_getNeighborLinkQuality(receiver, sender_address, 2, &quality));
+  TEST_ASSERT_EQUAL_HEX8(0xC0, quality.link_quality);
+  TEST_ASSERT_EQUAL_HEX8(0x50, quality.rssi);
+}
+
+void
+test_transmissionTakesAtLeastTheAirTime(void)
+{
+  const uint8_t payload[10] = {0};
+  uint32_t start = MrfSimulatorMedium_getTimeInMicroseconds(&medium);
+  sendBlockingTo(receiver_address, payload, sizeof(payload));
+  uint32_t duration = MrfSimulatorMedium_getTimeInMicroseconds(&medium) - start;
+
+  // phy header, mac header with sequence number, short addresses and pan id, payload, fcs
+  uint32_t air_time = (6 + 9 + sizeof(payload) + 2) * 32;
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(air_time, duration);
+}
+
+void
+test_resendingUnchangedFrameTransfersLessData(void)
+{
+  const uint8_t payload[20] = {0};
+  sendBlockingTo(receiver_address, payload, sizeof(payload));
+  uint32_t first_transfer = MrfSimulator_getStatistics(&sender_chip)->spi_bytes;
+  Mac802154_sendBlocking(sender);
+  uint32_t second_transfer = MrfSimulator_getStatistics(&sender_chip)->spi_bytes - first_transfer;
+  TEST_ASSERT_EQUAL_UINT32(2, MrfSimulator_getStatistics(&sender_chip)->frames_transmitted);
+  TEST_ASSERT_LESS_THAN_UINT32(sizeof(payload), second_transfer);
+}
+
+void
+test_busStatisticsMatchTheSimulatedTransfers(void)
+{
+  const uint8_t payload[20] = {0};
+  sendBlockingTo(receiver_address, payload, sizeof(payload));
+  Mac802154BusStatistics statistics;
+  Mac802154_getBusStatistics(sender, &statistics);
+  uint32_t transactions = 0;
+  uint32_t bytes = 0;
+  for (uint8_t i = 0; i < MAC802154_NUMBER_OF_BUS_OPERATIONS; i++) {
+    Mac802154BusCounters *counters = &statistics.operation[i];
+    transactions += counters->transactions;
+    bytes += counters->command_bytes + counters->bytes_written + counters->bytes_read;
+  }
+#if MRF_IO_STATISTICS
+  TEST_ASSERT_EQUAL_UINT32(MrfSimulator_getStatistics(&sender_chip)->spi_transactions, transactions);
+  TEST_ASSERT_EQUAL_UINT32(MrfSimulator_getStatistics(&sender_chip)->spi_bytes, bytes);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(payload),
+                           statistics.operation[MAC802154_BUS_OPERATION_PAYLOAD_WRITE].bytes_written);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, statistics.operation[MAC802154_BUS_OPERATION_STATUS_POLL].transactions);
+  uint32_t header_bytes = statistics.operation[MAC802154_BUS_OPERATION_HEADER_WRITE].bytes_written;
+  Mac802154_sendBlocking(sender);
+  Mac802154_getBusStatistics(sender, &statistics);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(payload),
+                           statistics.operation[MAC802154_BUS_OPERATION_PAYLOAD_WRITE].bytes_written);
+  TEST_ASSERT_GREATER_THAN_UINT32(header_bytes,
+                                  statistics.operation[MAC802154_BUS_OPERATION_HEADER_WRITE].bytes_written);
+#else
+  TEST_ASSERT_EQUAL_UINT32(0, transactions);
+  TEST_ASSERT_EQUAL_UINT32(0, bytes);
+#endif
+}
+
+/*
+ * A gateway with two MRFs on the same spi bus, listening
+ * on different channels with the same address.
+ */
+void
+test_radiosSharingSpiBusReceiveIndependently(void)
+{
+  const uint8_t gateway_address[2] = {0x0A, 0x00};
+  const uint8_t second_sender_address[2] = {0x03, 0x00};
+  MrfSimulatorBus bus;
+  MrfSimulator gateway_chips[2];
+  MrfSimulator second_sender_chip;
+  Mac802154 *gateway[2];
+  MrfSimulatorBus_init(&bus);
+  gateway[0] = createNodeOnInterface(&gateway_chips[0], gateway_address, 12,
+                                     MrfSimulatorBus_getInterface(&bus), &gateway_chips[0]);
+  gateway[1] = createNodeOnInterface(&gateway_chips[1], gateway_address, 15,
+                                     MrfSimulatorBus_getInterface(&bus), &gateway_chips[1]);
+  Mac802154MRF_shareInterface(gateway[1], gateway[0]);
+  Mac802154 *second_sender = createNodeOnInterface(&second_sender_chip, second_sender_address, 15,
+                                                   MrfSimulator_getInterface(&second_sender_chip), NULL);
+
+  const uint8_t first_payload[] = "first";
+  const uint8_t second_payload[] = "second";
+  sendBlockingTo(gateway_address, first_payload, 5);
+  Mac802154_setShortDestinationAddress(second_sender, gateway_address);
+  Mac802154_setPayload(second_sender, second_payload, 6);
+  Mac802154_sendBlocking(second_sender);
+  for (uint8_t i = 0; i < 2; i++) {
+    if (MrfSimulator_interruptIsPending(&gateway_chips[i])) {
+      Mac802154MRF_handleInterrupt(gateway[i]);
+    }
+  }
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(gateway[0]));
+  TEST_ASSERT_TRUE(Mac802154_dequeuePacket(gateway[0], packet, sizeof(packet)));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(first_payload, Mac802154_getPacketPayload(gateway[0], packet), 5);
+  TEST_ASSERT_EQUAL_UINT8(1, Mac802154_getNumberOfQueuedPackets(gateway[1]));
+  TEST_ASSERT_TRUE(Mac802154_dequeuePacket(gateway[1], packet, sizeof(packet)));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(second_payload, Mac802154_getPacketPayload(gateway[1], packet), 6);
+  free(gateway[0]);
+  free(gateway[1]);
+  free(second_sender);
+}
+
+void
+test_nonBlockingTransfersOnSharedSpiBusAreSerialized(void)
+{
+  const uint8_t gateway_address[2] = {0x0A, 0x00};
+  MrfSimulatorBus bus;
+  MrfSimulator gateway_chips[2];
+  Mac802154 *gateway[2];
+  MrfSimulatorBus_init(&bus);
+  for (uint8_t i = 0; i < 2; i++) {
+    gateway[i] = createNodeOnInterface(&gateway_chips[i], gateway_address, 12,
+                                       MrfSimulatorBus_getInterface(&bus), &gateway_chips[i]);
+  }
+  Mac802154MRF_shareInterface(gateway[1], gateway[0]);
+
+  const uint8_t payloads[2][6] = {"first", "second"};
+  Mac802154 *destinations[2] = {receiver, sender};
+  Mac802154_setShortDestinationAddress(gateway[0], receiver_address);
+  Mac802154_setShortDestinationAddress(gateway[1], sender_address);
+  for (uint8_t i = 0; i < 2; i++) {
+    Mac802154_setPayload(gateway[i], payloads[i], 5 + i);
+    Mac802154_sendNonBlocking(gateway[i]);
+  }
+  TEST_ASSERT_FALSE(MrfSimulator_interruptIsPending(&receiver_chip));
+  TEST_ASSERT_FALSE(MrfSimulator_interruptIsPending(&sender_chip));
+  while (MrfSimulatorBus_step(&bus)) {}
+
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_TRUE(MrfSimulator_interruptIsPending(&gateway_chips[i]));
+    Mac802154MRF_handleInterrupt(gateway[i]);
+    Mac802154MRF_handleInterrupt(destinations[i]);
+    TEST_ASSERT_TRUE(Mac802154_dequeuePacket(destinations[i], packet, sizeof(packet)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(payloads[i], Mac802154_getPacketPayload(destinations[i], packet), 5 + i);
+  }
+  free(gateway[0]);
+  free(gateway[1]);
+}
+
+void
+test_sleepingNodeResumesWithoutReconfiguration(void)
+{
+  const uint8_t payload[] = "hello";
+  Mac802154_sleep(receiver);
+  TEST_ASSERT_TRUE(MrfSimulator_isSleeping(&receiver_chip));
+  sendBlockingTo(receiver_address, payload, 5);
+  TEST_ASSERT_FALSE(Mac802154_newPacketAvailable(receiver));
+
+  uint32_t spi_bytes_before_wake_up = MrfSimulator_getStatistics(&receiver_chip)->spi_bytes;
+  Mac802154_wakeUp(receiver);
+  uint32_t spi_bytes_for_wake_up = MrfSimulator_getStatistics(&receiver_chip)->spi_bytes
+                                   - spi_bytes_before_wake_up;
+  TEST_ASSERT_FALSE(MrfSimulator_isSleeping(&receiver_chip));
+  // toggling REGWAKE and resetting the rf state machine, two bytes each
+  TEST_ASSERT_EQUAL_UINT32(8, spi_bytes_for_wake_up);
+
+  sendBlockingTo(receiver_address, payload, 5);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+}
+
+void
+test_sleepingSenderKeepsPreparedFrame(void)
+{
+  const uint8_t payload[] = "hello";
+  uint8_t packet[MAC802154_MAXIMUM_PACKET_SIZE];
+  sendBlockingTo(receiver_address, payload, 5);
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  Mac802154_sleep(sender);
+  Mac802154_wakeUp(sender);
+  Mac802154_sendBlocking(sender);
+  TEST_ASSERT_TRUE(Mac802154_newPacketAvailable(receiver));
+  Mac802154_fetchCompletePacketBlocking(receiver, packet, sizeof(packet));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, Mac802154_getPacketPayload(receiver, packet), 5);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(sender_address, Mac802154_getPacketShortSourceAddress(receiver, packet), 2);
+}